@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "base/not_null.hpp"
+
+namespace principia {
+namespace base {
+
+// A pool of memory from which blocks of a few distinct sizes are allocated and
+// deallocated with a free list per size.  This is intended for node-based
+// containers which see a lot of churn: the nodes that are freed are reused by
+// subsequent allocations of the same size without going through the global
+// allocator.
+// The blocks are carved out of chunks whose size doubles from 1 KiB to 64 KiB,
+// so that a small arena doesn't reserve much memory.  An arena may get its
+// chunks from a parent arena rather than from the global allocator.  When it
+// is destroyed, it gives all its chunks back to the parent at once, which
+// keeps them for the next arenas that it parents, up to the size given back
+// by the last one; the rest is returned to the system.  This makes it possible
+// to release in bulk the memory of a container which is destroyed: its nodes
+// are still visited by its destructor, but they are not freed one by one.
+// An arena without a parent counts the allocated blocks of each chunk, and
+// returns to the system the chunks whose blocks have all been deallocated, so
+// that its memory follows the size of its containers rather than their peak
+// size.  The arenas that share a parent must be used by a single thread.
+class Arena {
+ public:
+  // An arena which gets its chunks from the global allocator.
+  Arena();
+  // An arena which gets its chunks from the root of the parents of |parent|,
+  // which must outlive it.
+  explicit Arena(not_null<Arena*> const parent);
+  // Gives the chunks back to the parent, if any.
+  ~Arena();
+
+  Arena(Arena const&) = delete;
+  Arena(Arena&&) = delete;
+  Arena& operator=(Arena const&) = delete;
+  Arena& operator=(Arena&&) = delete;
+
+  // Returns a block of |size| bytes suitably aligned for any type.
+  void* Allocate(std::size_t const size);
+
+  // |pointer| must have been returned by |Allocate| with the same |size|.
+  void Deallocate(void* const pointer, std::size_t const size);
+
+  // The number of bytes in the chunks held by this arena, including the ones
+  // given back by its children.
+  std::int64_t reserved_bytes() const;
+
+  // The number of chunks that this arena has obtained from the global
+  // allocator since its construction, i.e., the number of heap allocations
+  // made for it.  The chunks given back by its children are not counted.
+  std::int64_t system_allocations() const;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  struct FreeList {
+    std::size_t size;
+    FreeBlock* first;
+  };
+
+  struct Chunk {
+    std::unique_ptr<std::uint8_t[]> memory;
+    std::size_t size;
+    // The number of blocks of this chunk returned by |Allocate| and not yet
+    // deallocated.  Only maintained for an arena without a parent.
+    std::int64_t allocated_blocks;
+  };
+
+  // The chunks are indexed by their address so that we can find the one that
+  // contains a block.
+  using Chunks = std::map<std::uint8_t const*, Chunk>;
+
+  not_null<FreeList*> FreeListFor(std::size_t const rounded_size);
+
+  // Returns the chunk of |chunks_| which contains |pointer|.
+  Chunk& ChunkContaining(void const* const pointer);
+
+  // True if the blocks of |chunk| may all be returned to the system, i.e., if
+  // none of them is allocated and we are not carving blocks out of it.
+  bool IsEmpty(Chunk const& chunk) const;
+
+  // Removes from the free lists the blocks of the empty chunks, and returns
+  // these chunks to the system.  Only called for an arena without a parent.
+  void ReleaseEmptyChunks();
+
+  // Returns a chunk of at least |minimum_size| bytes, either one given back by
+  // a child or a new one of at least |preferred_size| bytes.
+  Chunk TakeChunk(std::size_t const preferred_size,
+                  std::size_t const minimum_size);
+
+  // Keeps the |chunks| given back by a child, and returns to the system the
+  // oldest ones that exceed the size of |chunks|.
+  void GiveBackChunks(std::vector<Chunk>&& chunks);
+
+  Arena* const parent_ = nullptr;
+  // There are only a handful of sizes, so a linear search is fastest.
+  std::vector<FreeList> free_lists_;
+  Chunks chunks_;
+  // The chunks given back by the children, oldest first.
+  std::vector<Chunk> spare_chunks_;
+  std::size_t next_chunk_size_;
+  std::uint8_t* chunk_position_ = nullptr;
+  std::uint8_t* chunk_end_ = nullptr;
+  // The chunk out of which |Allocate| carves new blocks.
+  std::uint8_t const* current_chunk_ = nullptr;
+  std::int64_t reserved_bytes_ = 0;
+  std::int64_t system_allocations_ = 0;
+  // These are only maintained for an arena without a parent.  The empty
+  // chunks are released when their blocks make up at least half of the free
+  // lists, so that the cost of walking the free lists is amortized over the
+  // deallocations that emptied the chunks.
+  std::int64_t free_list_bytes_ = 0;
+  std::int64_t empty_chunk_bytes_ = 0;
+};
+
+// A standard allocator which gets its memory from an |Arena|.  Containers
+// using allocators that share the same arena may exchange nodes.
+template<typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind {
+    using other = ArenaAllocator<U>;
+  };
+
+  // No transfer of ownership.  |arena| must outlive the allocator and all the
+  // blocks allocated from it.
+  explicit ArenaAllocator(not_null<Arena*> const arena);
+  template<typename U>
+  ArenaAllocator(ArenaAllocator<U> const& other);  // NOLINT(runtime/explicit)
+
+  T* allocate(std::size_t const n);
+  void deallocate(T* const pointer, std::size_t const n);
+
+  not_null<Arena*> arena() const;
+
+ private:
+  not_null<Arena*> arena_;
+};
+
+template<typename T, typename U>
+bool operator==(ArenaAllocator<T> const& left, ArenaAllocator<U> const& right);
+template<typename T, typename U>
+bool operator!=(ArenaAllocator<T> const& left, ArenaAllocator<U> const& right);
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/arena_body.hpp"
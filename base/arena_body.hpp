@@ -0,0 +1,239 @@
+#pragma once
+
+#include "base/arena.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace principia {
+namespace base {
+
+namespace internal {
+
+std::size_t const kArenaAlignment = alignof(std::max_align_t);
+std::size_t const kArenaMinimumChunkSize = 1 << 10;
+std::size_t const kArenaMaximumChunkSize = 1 << 16;
+
+inline std::size_t RoundUpToAlignment(std::size_t const size) {
+  return (std::max(size, sizeof(void*)) + kArenaAlignment - 1) &
+         ~(kArenaAlignment - 1);
+}
+
+}  // namespace internal
+
+inline Arena::Arena() : next_chunk_size_(internal::kArenaMinimumChunkSize) {}
+
+inline Arena::Arena(not_null<Arena*> const parent)
+    : parent_(parent->parent_ == nullptr ? static_cast<Arena*>(parent)
+                                         : parent->parent_),
+      next_chunk_size_(internal::kArenaMinimumChunkSize) {}
+
+inline Arena::~Arena() {
+  if (parent_ != nullptr && !chunks_.empty()) {
+    std::vector<Chunk> chunks;
+    chunks.reserve(chunks_.size());
+    for (auto& pair : chunks_) {
+      chunks.push_back(std::move(pair.second));
+    }
+    parent_->GiveBackChunks(std::move(chunks));
+  }
+}
+
+inline void* Arena::Allocate(std::size_t const size) {
+  std::size_t const rounded_size = internal::RoundUpToAlignment(size);
+  not_null<FreeList*> const free_list = FreeListFor(rounded_size);
+  if (free_list->first != nullptr) {
+    FreeBlock* const block = free_list->first;
+    free_list->first = block->next;
+    if (parent_ == nullptr) {
+      free_list_bytes_ -= rounded_size;
+      Chunk& chunk = ChunkContaining(block);
+      if (IsEmpty(chunk)) {
+        empty_chunk_bytes_ -= chunk.size;
+      }
+      ++chunk.allocated_blocks;
+    }
+    return block;
+  }
+  if (chunk_end_ - chunk_position_ <
+          static_cast<std::ptrdiff_t>(rounded_size)) {
+    // The remainder of the current chunk is lost.  It is at most the size of
+    // a block.
+    Chunk chunk = TakeChunk(next_chunk_size_, rounded_size);
+    next_chunk_size_ =
+        std::min(2 * next_chunk_size_, internal::kArenaMaximumChunkSize);
+    chunk_position_ = chunk.memory.get();
+    chunk_end_ = chunk_position_ + chunk.size;
+    reserved_bytes_ += chunk.size;
+    std::uint8_t const* const previous_chunk = current_chunk_;
+    current_chunk_ = chunk_position_;
+    chunks_.emplace(current_chunk_, std::move(chunk));
+    // The previous chunk may have become empty while we were carving blocks
+    // out of it.
+    if (parent_ == nullptr && previous_chunk != nullptr) {
+      Chunk const& previous = chunks_.at(previous_chunk);
+      if (IsEmpty(previous)) {
+        empty_chunk_bytes_ += previous.size;
+      }
+    }
+  }
+  void* const block = chunk_position_;
+  chunk_position_ += rounded_size;
+  if (parent_ == nullptr) {
+    ++chunks_.at(current_chunk_).allocated_blocks;
+  }
+  return block;
+}
+
+inline void Arena::Deallocate(void* const pointer, std::size_t const size) {
+  std::size_t const rounded_size = internal::RoundUpToAlignment(size);
+  not_null<FreeList*> const free_list = FreeListFor(rounded_size);
+  FreeBlock* const block = static_cast<FreeBlock*>(pointer);
+  block->next = free_list->first;
+  free_list->first = block;
+  if (parent_ == nullptr) {
+    free_list_bytes_ += rounded_size;
+    Chunk& chunk = ChunkContaining(pointer);
+    --chunk.allocated_blocks;
+    if (IsEmpty(chunk)) {
+      empty_chunk_bytes_ += chunk.size;
+      if (2 * empty_chunk_bytes_ >= free_list_bytes_) {
+        ReleaseEmptyChunks();
+      }
+    }
+  }
+}
+
+inline std::int64_t Arena::reserved_bytes() const {
+  return reserved_bytes_;
+}
+
+inline std::int64_t Arena::system_allocations() const {
+  return system_allocations_;
+}
+
+inline not_null<Arena::FreeList*> Arena::FreeListFor(
+    std::size_t const rounded_size) {
+  for (FreeList& free_list : free_lists_) {
+    if (free_list.size == rounded_size) {
+      return &free_list;
+    }
+  }
+  free_lists_.push_back({rounded_size, nullptr});
+  return &free_lists_.back();
+}
+
+inline Arena::Chunk& Arena::ChunkContaining(void const* const pointer) {
+  // The chunk is the last one that starts at or before |pointer|.
+  auto it = chunks_.upper_bound(static_cast<std::uint8_t const*>(pointer));
+  return (--it)->second;
+}
+
+inline bool Arena::IsEmpty(Chunk const& chunk) const {
+  return chunk.allocated_blocks == 0 && chunk.memory.get() != current_chunk_;
+}
+
+inline void Arena::ReleaseEmptyChunks() {
+  for (FreeList& free_list : free_lists_) {
+    FreeBlock** link = &free_list.first;
+    while (*link != nullptr) {
+      if (IsEmpty(ChunkContaining(*link))) {
+        *link = (*link)->next;
+        free_list_bytes_ -= free_list.size;
+      } else {
+        link = &(*link)->next;
+      }
+    }
+  }
+  for (auto it = chunks_.begin(); it != chunks_.end();) {
+    if (IsEmpty(it->second)) {
+      reserved_bytes_ -= it->second.size;
+      it = chunks_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  empty_chunk_bytes_ = 0;
+}
+
+inline Arena::Chunk Arena::TakeChunk(std::size_t const preferred_size,
+                                     std::size_t const minimum_size) {
+  Arena& source = parent_ == nullptr ? *this : *parent_;
+  if (!source.spare_chunks_.empty() &&
+      source.spare_chunks_.back().size >= minimum_size) {
+    Chunk chunk = std::move(source.spare_chunks_.back());
+    source.spare_chunks_.pop_back();
+    source.reserved_bytes_ -= chunk.size;
+    chunk.allocated_blocks = 0;
+    return chunk;
+  }
+  std::size_t const size = std::max(preferred_size, minimum_size);
+  ++system_allocations_;
+  return {std::unique_ptr<std::uint8_t[]>(new std::uint8_t[size]),
+          size,
+          /*allocated_blocks=*/0};
+}
+
+inline void Arena::GiveBackChunks(std::vector<Chunk>&& chunks) {
+  std::int64_t given_back_bytes = 0;
+  for (Chunk& chunk : chunks) {
+    given_back_bytes += chunk.size;
+    spare_chunks_.push_back(std::move(chunk));
+  }
+  reserved_bytes_ += given_back_bytes;
+  // Drop the oldest spare chunks so that we don't keep more than the
+  // footprint of the child that was just destroyed.
+  std::int64_t spare_bytes = 0;
+  auto first_kept = spare_chunks_.end();
+  while (first_kept != spare_chunks_.begin() &&
+         spare_bytes + static_cast<std::int64_t>((first_kept - 1)->size) <=
+             given_back_bytes) {
+    --first_kept;
+    spare_bytes += first_kept->size;
+  }
+  for (auto it = spare_chunks_.begin(); it != first_kept; ++it) {
+    reserved_bytes_ -= it->size;
+  }
+  spare_chunks_.erase(spare_chunks_.begin(), first_kept);
+}
+
+template<typename T>
+ArenaAllocator<T>::ArenaAllocator(not_null<Arena*> const arena)
+    : arena_(arena) {}
+
+template<typename T>
+template<typename U>
+ArenaAllocator<T>::ArenaAllocator(ArenaAllocator<U> const& other)
+    : arena_(other.arena()) {}
+
+template<typename T>
+T* ArenaAllocator<T>::allocate(std::size_t const n) {
+  static_assert(alignof(T) <= internal::kArenaAlignment,
+                "Overaligned type");
+  return static_cast<T*>(arena_->Allocate(n * sizeof(T)));
+}
+
+template<typename T>
+void ArenaAllocator<T>::deallocate(T* const pointer, std::size_t const n) {
+  arena_->Deallocate(pointer, n * sizeof(T));
+}
+
+template<typename T>
+not_null<Arena*> ArenaAllocator<T>::arena() const {
+  return arena_;
+}
+
+template<typename T, typename U>
+bool operator==(ArenaAllocator<T> const& left,
+                ArenaAllocator<U> const& right) {
+  return left.arena() == right.arena();
+}
+
+template<typename T, typename U>
+bool operator!=(ArenaAllocator<T> const& left,
+                ArenaAllocator<U> const& right) {
+  return left.arena() != right.arena();
+}
+
+}  // namespace base
+}  // namespace principia
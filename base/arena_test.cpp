@@ -0,0 +1,134 @@
+
+#include "base/arena.hpp"
+
+#include <list>
+#include <map>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+
+class ArenaTest : public testing::Test {
+ protected:
+  Arena arena_;
+};
+
+TEST_F(ArenaTest, Reuse) {
+  void* const p1 = arena_.Allocate(24);
+  void* const p2 = arena_.Allocate(24);
+  void* const p3 = arena_.Allocate(100);
+  EXPECT_NE(p1, p2);
+  EXPECT_NE(p1, p3);
+  EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(p1) % alignof(double));
+  arena_.Deallocate(p1, 24);
+  arena_.Deallocate(p3, 100);
+  // The freed blocks are reused for the same size.
+  EXPECT_EQ(p1, arena_.Allocate(24));
+  EXPECT_EQ(p3, arena_.Allocate(100));
+}
+
+TEST_F(ArenaTest, LargeBlock) {
+  void* const p = arena_.Allocate(1 << 20);
+  EXPECT_NE(nullptr, p);
+  EXPECT_LE(1 << 20, arena_.reserved_bytes());
+}
+
+TEST_F(ArenaTest, Containers) {
+  using Allocator = ArenaAllocator<std::pair<int const, double>>;
+  std::map<int, double, std::less<int>, Allocator> map((Allocator(&arena_)));
+  for (int i = 0; i < 1000; ++i) {
+    map.emplace(i, i);
+  }
+  std::int64_t const reserved_bytes = arena_.reserved_bytes();
+  EXPECT_LT(0, reserved_bytes);
+  // Churn doesn't make the memory grow.  The chunks emptied by |clear| are
+  // released and replaced by chunks of the maximum size, so the footprint may
+  // differ by one such chunk.
+  for (int j = 0; j < 10; ++j) {
+    map.clear();
+    for (int i = 0; i < 1000; ++i) {
+      map.emplace(i, i);
+    }
+  }
+  EXPECT_GE(reserved_bytes + (1 << 16), arena_.reserved_bytes());
+  EXPECT_EQ(1000, map.size());
+  EXPECT_EQ(999.0, map.rbegin()->second);
+
+  std::list<double, ArenaAllocator<double>> list(
+      (ArenaAllocator<double>(&arena_)));
+  list.push_back(1.0);
+  EXPECT_EQ(Allocator(&arena_), list.get_allocator());
+}
+
+TEST_F(ArenaTest, ReleaseEmptyChunks) {
+  using Allocator = ArenaAllocator<std::pair<int const, double>>;
+  std::map<int, double, std::less<int>, Allocator> map((Allocator(&arena_)));
+  for (int i = 0; i < 100000; ++i) {
+    map.emplace(i, i);
+  }
+  std::int64_t const peak_reserved_bytes = arena_.reserved_bytes();
+  EXPECT_LT(100000 * sizeof(std::pair<int const, double>),
+            peak_reserved_bytes);
+  // Removing the oldest nodes, as |Trajectory::ForgetBefore| does, returns
+  // their chunks to the system.
+  map.erase(map.begin(), map.lower_bound(99000));
+  EXPECT_EQ(1000, map.size());
+  EXPECT_GT(peak_reserved_bytes / 20, arena_.reserved_bytes());
+  // The remaining nodes are intact, and the free blocks of the released chunks
+  // are not reused.
+  for (int i = 100000; i < 200000; ++i) {
+    map.emplace(i, i);
+  }
+  EXPECT_EQ(101000, map.size());
+  EXPECT_EQ(99000.0, map.begin()->second);
+  EXPECT_GE(peak_reserved_bytes + (1 << 16), arena_.reserved_bytes());
+  map.clear();
+  EXPECT_GE(1 << 16, arena_.reserved_bytes());
+}
+
+TEST_F(ArenaTest, Children) {
+  using Allocator = ArenaAllocator<std::pair<int const, double>>;
+  using Map = std::map<int, double, std::less<int>, Allocator>;
+  Arena child(&arena_);
+  // A small arena doesn't reserve a full chunk.
+  child.Allocate(24);
+  EXPECT_GT(1 << 16, child.reserved_bytes());
+  std::int64_t child_reserved_bytes;
+  {
+    auto grandchild = std::make_unique<Arena>(&child);
+    Map map((Allocator(grandchild.get())));
+    for (int i = 0; i < 10000; ++i) {
+      map.emplace(i, i);
+    }
+    child_reserved_bytes = grandchild->reserved_bytes();
+    EXPECT_LT(0, grandchild->system_allocations());
+    EXPECT_EQ(0, arena_.reserved_bytes());
+    // The chunks are given back to the root, not to the parent.
+    map.clear();
+    grandchild.reset();
+  }
+  EXPECT_EQ(child_reserved_bytes, arena_.reserved_bytes());
+  // The chunks are reused by the next children, no new memory is reserved.
+  for (int j = 0; j < 10; ++j) {
+    Arena other_child(&arena_);
+    Map map((Allocator(&other_child)));
+    for (int i = 0; i < 10000; ++i) {
+      map.emplace(i, i);
+    }
+    EXPECT_LE(arena_.reserved_bytes() + other_child.reserved_bytes(),
+              child_reserved_bytes);
+    EXPECT_EQ(0, other_child.system_allocations());
+  }
+  EXPECT_GE(child_reserved_bytes, arena_.reserved_bytes());
+  // The chunks that are not needed by the last child are freed.
+  {
+    Arena small_child(&arena_);
+    small_child.Allocate(24);
+  }
+  EXPECT_GE(1 << 16, arena_.reserved_bytes());
+}
+
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "base/macros.hpp"
+
+namespace principia {
+namespace base {
+
+// A file which is created for scratch storage and accessed through a memory
+// mapping.  The file is deleted when the object is destroyed.  The mapping may
+// be extended, in which case it may move in memory, so pointers into |data()|
+// must not be retained across calls to |Reserve|.
+class MappedFile {
+ public:
+  // Creates a file named |path|, truncating it if it exists.
+  explicit MappedFile(std::string const& path);
+  ~MappedFile();
+
+  MappedFile(MappedFile const&) = delete;
+  MappedFile(MappedFile&&) = delete;
+  MappedFile& operator=(MappedFile const&) = delete;
+  MappedFile& operator=(MappedFile&&) = delete;
+
+  // Ensures that at least |size| bytes are mapped.  The mapping grows
+  // geometrically, so a sequence of calls with increasing |size| has amortized
+  // constant cost per byte.  Invalidates |data()| if the mapping grows.
+  void Reserve(std::int64_t const size);
+
+  // The beginning of the mapping, or null if nothing was reserved yet.
+  std::uint8_t* data();
+  std::uint8_t const* data() const;
+
+  // The number of bytes currently mapped.
+  std::int64_t capacity() const;
+
+ private:
+  void Map(std::int64_t const capacity);
+  void Unmap();
+
+  std::string const path_;
+#if OS_WIN
+  void* file_;
+  void* mapping_ = nullptr;
+#else
+  int file_;
+#endif
+  std::uint8_t* data_ = nullptr;
+  std::int64_t capacity_ = 0;
+};
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/mapped_file_body.hpp"
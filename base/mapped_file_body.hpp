@@ -0,0 +1,130 @@
+#pragma once
+
+#include "base/mapped_file.hpp"
+
+#include <algorithm>
+
+#if OS_WIN
+#define NOGDI
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+
+namespace internal {
+
+// The granularity of the mapping.  Must be a multiple of the allocation
+// granularity on all platforms (64 KiB on Windows).
+std::int64_t const kMappingGranularity = 1 << 16;
+
+}  // namespace internal
+
+inline MappedFile::MappedFile(std::string const& path) : path_(path) {
+#if OS_WIN
+  file_ = CreateFileA(path.c_str(),
+                      GENERIC_READ | GENERIC_WRITE,
+                      /*dwShareMode=*/0,
+                      /*lpSecurityAttributes=*/nullptr,
+                      CREATE_ALWAYS,
+                      FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE,
+                      /*hTemplateFile=*/nullptr);
+  CHECK(file_ != INVALID_HANDLE_VALUE)
+      << "Cannot create " << path << ": " << GetLastError();
+#else
+  file_ = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+  PCHECK(file_ >= 0) << "Cannot create " << path;
+  // The file remains accessible through |file_| and the mapping.
+  PCHECK(unlink(path.c_str()) == 0) << "Cannot unlink " << path;
+#endif
+}
+
+inline MappedFile::~MappedFile() {
+  Unmap();
+#if OS_WIN
+  CloseHandle(file_);
+#else
+  close(file_);
+#endif
+}
+
+inline void MappedFile::Reserve(std::int64_t const size) {
+  if (size <= capacity_) {
+    return;
+  }
+  std::int64_t capacity = std::max(capacity_, internal::kMappingGranularity);
+  while (capacity < size) {
+    capacity *= 2;
+  }
+  Unmap();
+  Map(capacity);
+}
+
+inline std::uint8_t* MappedFile::data() {
+  return data_;
+}
+
+inline std::uint8_t const* MappedFile::data() const {
+  return data_;
+}
+
+inline std::int64_t MappedFile::capacity() const {
+  return capacity_;
+}
+
+inline void MappedFile::Map(std::int64_t const capacity) {
+#if OS_WIN
+  // Mapping beyond the end of the file extends it.
+  mapping_ = CreateFileMappingA(file_,
+                                /*lpFileMappingAttributes=*/nullptr,
+                                PAGE_READWRITE,
+                                static_cast<DWORD>(capacity >> 32),
+                                static_cast<DWORD>(capacity & 0xFFFFFFFF),
+                                /*lpName=*/nullptr);
+  CHECK(mapping_ != nullptr)
+      << "Cannot map " << path_ << ": " << GetLastError();
+  data_ = static_cast<std::uint8_t*>(MapViewOfFile(mapping_,
+                                                   FILE_MAP_ALL_ACCESS,
+                                                   /*dwFileOffsetHigh=*/0,
+                                                   /*dwFileOffsetLow=*/0,
+                                                   capacity));
+  CHECK(data_ != nullptr)
+      << "Cannot map " << path_ << ": " << GetLastError();
+#else
+  PCHECK(ftruncate(file_, capacity) == 0) << "Cannot extend " << path_;
+  void* const data = mmap(/*addr=*/nullptr,
+                          capacity,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          file_,
+                          /*offset=*/0);
+  PCHECK(data != MAP_FAILED) << "Cannot map " << path_;
+  data_ = static_cast<std::uint8_t*>(data);
+#endif
+  capacity_ = capacity;
+}
+
+inline void MappedFile::Unmap() {
+  if (data_ == nullptr) {
+    return;
+  }
+#if OS_WIN
+  UnmapViewOfFile(data_);
+  CloseHandle(mapping_);
+  mapping_ = nullptr;
+#else
+  munmap(data_, capacity_);
+#endif
+  data_ = nullptr;
+}
+
+}  // namespace base
+}  // namespace principia
@@ -0,0 +1,44 @@
+
+#include "base/mapped_file.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+
+class MappedFileTest : public testing::Test {
+ protected:
+  MappedFileTest() : file_("mapped_file_test.bin") {}
+
+  MappedFile file_;
+};
+
+TEST_F(MappedFileTest, Empty) {
+  EXPECT_EQ(nullptr, file_.data());
+  EXPECT_EQ(0, file_.capacity());
+}
+
+TEST_F(MappedFileTest, Reserve) {
+  file_.Reserve(10);
+  EXPECT_NE(nullptr, file_.data());
+  EXPECT_LE(10, file_.capacity());
+  std::int64_t const capacity = file_.capacity();
+  file_.Reserve(capacity);
+  EXPECT_EQ(capacity, file_.capacity());
+}
+
+TEST_F(MappedFileTest, ContentSurvivesGrowth) {
+  file_.Reserve(4);
+  std::memcpy(file_.data(), "abcd", 4);
+  file_.Reserve(10 * file_.capacity());
+  EXPECT_EQ(0, std::memcmp(file_.data(), "abcd", 4));
+  std::uint8_t* const far_end = file_.data() + file_.capacity() - 1;
+  *far_end = 42;
+  EXPECT_EQ(42, *far_end);
+}
+
+}  // namespace base
+}  // namespace principia
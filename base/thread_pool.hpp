@@ -0,0 +1,55 @@
+#pragma once
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <future>  // NOLINT(build/c++11)
+#include <list>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "base/macros.hpp"
+
+namespace principia {
+namespace base {
+
+// A pool of threads that execute the functions added to it, in the order in
+// which they were added.  The threads are created when the first function is
+// added, so that a pool which is never used doesn't cost any thread, and they
+// are joined at destruction, after all the functions that were added have been
+// executed.
+class ThreadPool {
+ public:
+  // Creates a pool of |pool_size| threads, which must be positive.
+  explicit ThreadPool(int const pool_size);
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  // Schedules the execution of |function| on one of the threads of the pool.
+  // The returned future becomes ready when |function| has been executed.
+  std::future<void> Add(std::function<void()> function);
+
+  int size() const;
+
+ private:
+  // The loop executed by each of the |threads_|.
+  void DequeueAndExecute();
+
+  std::mutex lock_;
+  std::condition_variable has_functions_or_shutdown_;
+  bool shutdown_ GUARDED_BY(lock_) = false;
+  std::list<std::packaged_task<void()>> functions_ GUARDED_BY(lock_);
+
+  int const pool_size_;
+  // Empty until the first call to |Add|, which fills it under |lock_|.
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace base
+}  // namespace principia
+
+#include "base/thread_pool_body.hpp"
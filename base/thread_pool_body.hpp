@@ -0,0 +1,67 @@
+#pragma once
+
+#include "base/thread_pool.hpp"
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace base {
+
+inline ThreadPool::ThreadPool(int const pool_size) : pool_size_(pool_size) {
+  CHECK_LT(0, pool_size_);
+}
+
+inline ThreadPool::~ThreadPool() {
+  {
+    std::unique_lock<std::mutex> l(lock_);
+    shutdown_ = true;
+  }
+  has_functions_or_shutdown_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+inline std::future<void> ThreadPool::Add(std::function<void()> function) {
+  std::future<void> result;
+  {
+    std::unique_lock<std::mutex> l(lock_);
+    CHECK(!shutdown_);
+    if (threads_.empty()) {
+      // The threads block on |lock_| until we are done.
+      threads_.reserve(pool_size_);
+      for (int i = 0; i < pool_size_; ++i) {
+        threads_.emplace_back(&ThreadPool::DequeueAndExecute, this);
+      }
+    }
+    functions_.emplace_back(std::move(function));
+    result = functions_.back().get_future();
+  }
+  has_functions_or_shutdown_.notify_one();
+  return result;
+}
+
+inline int ThreadPool::size() const {
+  return pool_size_;
+}
+
+inline void ThreadPool::DequeueAndExecute() {
+  for (;;) {
+    std::packaged_task<void()> function;
+    {
+      std::unique_lock<std::mutex> l(lock_);
+      has_functions_or_shutdown_.wait(
+          l, [this]() { return shutdown_ || !functions_.empty(); });
+      // Drain the queue before shutting down.
+      if (functions_.empty()) {
+        return;
+      }
+      function = std::move(functions_.front());
+      functions_.pop_front();
+    }
+    function();
+  }
+}
+
+}  // namespace base
+}  // namespace principia
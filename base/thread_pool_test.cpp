@@ -0,0 +1,51 @@
+#include "base/thread_pool.hpp"
+
+#include <atomic>
+#include <future>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace principia {
+namespace base {
+
+class ThreadPoolTest : public ::testing::Test {
+ protected:
+  ThreadPoolTest() : pool_(7) {}
+
+  ThreadPool pool_;
+};
+
+// Check that all the functions are executed and that the futures become ready
+// when they are.
+TEST_F(ThreadPoolTest, ParallelExecution) {
+  EXPECT_EQ(7, pool_.size());
+  std::vector<int> results(1000, 0);
+  std::vector<std::future<void>> futures;
+  for (int i = 0; i < results.size(); ++i) {
+    futures.push_back(pool_.Add([i, &results]() { results[i] = i * i; }));
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+  for (int i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(i * i, results[i]);
+  }
+}
+
+// Check that the functions that are still queued are executed when the pool
+// is destroyed.
+TEST_F(ThreadPoolTest, DrainOnDestruction) {
+  std::atomic<int> count(0);
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 100; ++i) {
+      pool.Add([&count]() { ++count; });
+    }
+  }
+  EXPECT_EQ(100, count);
+}
+
+}  // namespace base
+}  // namespace principia
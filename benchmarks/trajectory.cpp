@@ -0,0 +1,106 @@
+
+// ./benchmarks --benchmark_filter=ForkAppendDelete
+
+// Before, with the nodes allocated by the global allocator:
+// Benchmark                     Time(ns)    CPU(ns) Iterations
+// ------------------------------------------------------------
+// BM_ForkAppendDelete/100           4106       3990     176418
+// BM_ForkAppendDelete/1000         45182      45124      11506
+// BM_ForkAppendDelete/10000       517563     513318       1328
+
+// After, with the chunks of the arena of a fork released in bulk:
+// Benchmark                     Time(ns)    CPU(ns) Iterations
+// ------------------------------------------------------------
+// BM_ForkAppendDelete/100           3047       2993     220139
+// BM_ForkAppendDelete/1000         35966      35580      18559
+// BM_ForkAppendDelete/10000       409138     405571       1729
+
+#include <memory>
+
+#include "base/not_null.hpp"
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+#include "physics/massless_body.hpp"
+#include "physics/trajectory.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+#include "serialization/geometry.pb.h"
+
+// This must come last because apparently it redefines CDECL.
+#include "benchmark/benchmark.h"
+
+namespace principia {
+
+using base::not_null;
+using geometry::Displacement;
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Position;
+using geometry::Velocity;
+using physics::DegreesOfFreedom;
+using physics::MasslessBody;
+using physics::Trajectory;
+using quantities::Time;
+using si::Metre;
+using si::Second;
+
+namespace benchmarks {
+
+namespace {
+
+using World = Frame<serialization::Frame::TestTag,
+                    serialization::Frame::TEST1, true>;
+
+void AppendPoints(Time const& Δt,
+                  int const steps,
+                  not_null<Trajectory<World>*> const trajectory) {
+  Instant const t0 = trajectory->last().time();
+  DegreesOfFreedom<World> const d0 = trajectory->last().degrees_of_freedom();
+  for (int i = 1; i <= steps; ++i) {
+    Time const t_i = i * Δt;
+    trajectory->Append(t0 + t_i,
+                       DegreesOfFreedom<World>(
+                           d0.position() + d0.velocity() * t_i,
+                           d0.velocity()));
+  }
+}
+
+}  // namespace
+
+// Simulates the churn of the predictions: a fork is created at the end of a
+// prolongation, extended, and deleted.
+void BM_ForkAppendDelete(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  state.PauseTiming();
+  Time const Δt = 10 * Second;
+  int const steps = state.range_x();
+
+  MasslessBody body;
+  Trajectory<World> history(&body);
+  history.Append(Instant(),
+                 DegreesOfFreedom<World>(
+                     World::origin +
+                         Displacement<World>({1 * Metre, 2 * Metre, 3 * Metre}),
+                     Velocity<World>({4 * Metre / Second,
+                                      5 * Metre / Second,
+                                      6 * Metre / Second})));
+  AppendPoints(Δt, 10000, &history);
+  not_null<Trajectory<World>*> const prolongation =
+      history.NewFork(history.last().time());
+  AppendPoints(Δt, 10, prolongation);
+
+  state.ResumeTiming();
+  while (state.KeepRunning()) {
+    Trajectory<World>* prediction =
+        prolongation->NewFork(prolongation->last().time());
+    AppendPoints(Δt, steps, prediction);
+    prolongation->DeleteFork(&prediction);
+  }
+}
+
+BENCHMARK(BM_ForkAppendDelete)->Arg(100)->Arg(1000)->Arg(10000);
+
+}  // namespace benchmarks
+}  // namespace principia
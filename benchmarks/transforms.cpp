@@ -33,11 +33,45 @@
 // BM_BarycentricRotating<true>/1000k_mean       1829286409 1825211700          1  // NOLINT(whitespace/line_length)
 // BM_BarycentricRotating<true>/1000k_stddev      606781916  592803800          0  // NOLINT(whitespace/line_length)
 
+// ./benchmarks --benchmark_filter=TransformRange --benchmark_repetitions=3  // NOLINT(whitespace/line_length)
+// Benchmarking on 1 X Xeon CPU, so the parallel computation cannot be faster
+// than the serial one here: this only measures its overhead.  The CPU time is
+// that of the calling thread.  With the cache locked for each point:
+// Benchmark                                                   Time(ns)    CPU(ns) Iterations  // NOLINT(whitespace/line_length)
+// ------------------------------------------------------------------------------------------  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingTransformRange<false>/1024000_mean    619969097  613425008          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingTransformRange<true>/1024000_mean     608051220   73915494          3  // NOLINT(whitespace/line_length)
+// With the updates to the cache deferred until the tasks have completed:
+// Benchmark                                                   Time(ns)    CPU(ns) Iterations  // NOLINT(whitespace/line_length)
+// ------------------------------------------------------------------------------------------  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingTransformRange<false>/1024000_mean    627126636  621087168          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingTransformRange<true>/1024000_mean     597109968  287247948          3  // NOLINT(whitespace/line_length)
+
+// ./benchmarks --benchmark_filter=Mobiles --benchmark_repetitions=3  // NOLINT(whitespace/line_length)
+// Benchmarking on 1 X Xeon CPU.  With the frames recomputed for each probe:
+// Benchmark                                             Time(ns)    CPU(ns) Iterations  // NOLINT(whitespace/line_length)
+// ------------------------------------------------------------------------------------  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<false>/1_mean            1715473    1702785          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<false>/8_mean           13877254   13656344          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<true>/1_mean             1658880    1644440          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<true>/8_mean            13553187   13451472          3  // NOLINT(whitespace/line_length)
+// With the frames appended to the table by the first probe and found by the
+// others:
+// Benchmark                                             Time(ns)    CPU(ns) Iterations  // NOLINT(whitespace/line_length)
+// ------------------------------------------------------------------------------------  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<false>/1_mean            2704267    2680020          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<false>/8_mean            7830757    7729943          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<true>/1_mean              675379     669316          3  // NOLINT(whitespace/line_length)
+// BM_BarycentricRotatingMobiles<true>/8_mean             5553148    5489249          3  // NOLINT(whitespace/line_length)
+
+#include <algorithm>
 #include <memory>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/frame.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
@@ -62,6 +96,7 @@ namespace principia {
 using astronomy::EarthMass;
 using astronomy::JulianYear;
 using base::not_null;
+using base::ThreadPool;
 using geometry::AngularVelocity;
 using geometry::Displacement;
 using geometry::Exp;
@@ -317,12 +352,203 @@ void BM_BarycentricRotating(
   }
 }
 
+// Transforms the trajectory of a probe with |TransformRange|, either serially
+// or on a pool with one thread per core.  A new |Transforms| is created for
+// each iteration, so that the frames are not found in its cache.
+template<bool parallel>
+void BM_BarycentricRotatingTransformRange(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  state.PauseTiming();
+
+  Time const Δt = 1 * Hour;
+  int const steps = state.range_x();
+
+  MassiveBody earth(astronomy::EarthMass);
+  Position<World1> earth_center = World1::origin;
+  Position<World1> earth_initial_position =
+      World1::origin + Displacement<World1>({1 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit});
+  AngularVelocity<World1> earth_angular_velocity =
+      AngularVelocity<World1>({0 * SIUnit<AngularFrequency>(),
+                               0 * SIUnit<AngularFrequency>(),
+                               2 * π * Radian / JulianYear});
+  TrajectoryHolder earth_holder(NewCircularTrajectory(&earth,
+                                                      earth_center,
+                                                      earth_initial_position,
+                                                      earth_angular_velocity,
+                                                      Δt,
+                                                      steps));
+
+  MassiveBody thera(astronomy::EarthMass);
+  Position<World1> thera_center =
+      World1::origin + Displacement<World1>({2 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit});
+  Position<World1> thera_initial_position =
+      World1::origin + Displacement<World1>({-0.5 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit});
+  AngularVelocity<World1> thera_angular_velocity =
+      AngularVelocity<World1>({0 * SIUnit<AngularFrequency>(),
+                               0 * SIUnit<AngularFrequency>(),
+                               6 * Radian / JulianYear});
+  TrajectoryHolder thera_holder(NewCircularTrajectory(&thera,
+                                                      thera_center,
+                                                      thera_initial_position,
+                                                      thera_angular_velocity,
+                                                      Δt,
+                                                      steps));
+
+  MasslessBody probe;
+  Position<World1> probe_initial_position =
+      World1::origin + Displacement<World1>({0.5 * si::AstronomicalUnit,
+                                             -1 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit});
+  Velocity<World1> probe_velocity =
+      Velocity<World1>({0 * SIUnit<Speed>(),
+                        100 * Kilo(Metre) / Second,
+                        0 * SIUnit<Speed>()});
+  TrajectoryHolder probe_holder(NewLinearTrajectory(&probe,
+                                                    probe_initial_position,
+                                                    probe_velocity,
+                                                    Δt,
+                                                    steps));
+
+  std::unique_ptr<ThreadPool> pool;
+  if (parallel) {
+    pool = std::make_unique<ThreadPool>(
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  }
+
+  state.ResumeTiming();
+  while (state.KeepRunning()) {
+    auto transforms = Transforms<TrajectoryHolder, World1, World2, World1>::
+        BarycentricRotating(earth_holder,
+                            thera_holder,
+                            &TrajectoryHolder::trajectory);
+    std::vector<Instant> times;
+    std::vector<Position<World1>> positions;
+    std::vector<Velocity<World1>> velocities;
+    transforms->TransformRange(probe_holder,
+                               &TrajectoryHolder::trajectory,
+                               probe_holder.trajectory().first().time(),
+                               probe_holder.trajectory().last().time(),
+                               &times,
+                               &positions,
+                               &velocities,
+                               pool.get());
+  }
+}
+
+// Transforms the trajectories of |state.range_x()| probes, which have points
+// at the same times, with the same |Transforms|, as when the vessels are
+// rendered in the same frame.  If |persistent| the |Transforms| is kept across
+// iterations, as it is across frames by the plugin, otherwise a new one is
+// created for each iteration, so that the frames are computed for the first
+// probe and found in the table for the others.
+template<bool persistent>
+void BM_BarycentricRotatingMobiles(
+    benchmark::State& state) {  // NOLINT(runtime/references)
+  state.PauseTiming();
+
+  Time const Δt = 1 * Hour;
+  int const steps = 10 << 10;
+  int const probes = state.range_x();
+
+  MassiveBody earth(astronomy::EarthMass);
+  Position<World1> earth_center = World1::origin;
+  Position<World1> earth_initial_position =
+      World1::origin + Displacement<World1>({1 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit});
+  AngularVelocity<World1> earth_angular_velocity =
+      AngularVelocity<World1>({0 * SIUnit<AngularFrequency>(),
+                               0 * SIUnit<AngularFrequency>(),
+                               2 * π * Radian / JulianYear});
+  TrajectoryHolder earth_holder(NewCircularTrajectory(&earth,
+                                                      earth_center,
+                                                      earth_initial_position,
+                                                      earth_angular_velocity,
+                                                      Δt,
+                                                      steps));
+
+  MassiveBody thera(astronomy::EarthMass);
+  Position<World1> thera_center =
+      World1::origin + Displacement<World1>({2 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit});
+  Position<World1> thera_initial_position =
+      World1::origin + Displacement<World1>({-0.5 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit,
+                                             0 * si::AstronomicalUnit});
+  AngularVelocity<World1> thera_angular_velocity =
+      AngularVelocity<World1>({0 * SIUnit<AngularFrequency>(),
+                               0 * SIUnit<AngularFrequency>(),
+                               6 * Radian / JulianYear});
+  TrajectoryHolder thera_holder(NewCircularTrajectory(&thera,
+                                                      thera_center,
+                                                      thera_initial_position,
+                                                      thera_angular_velocity,
+                                                      Δt,
+                                                      steps));
+
+  MasslessBody probe;
+  std::vector<std::unique_ptr<TrajectoryHolder>> probe_holders;
+  for (int i = 0; i < probes; ++i) {
+    Position<World1> probe_initial_position =
+        World1::origin + Displacement<World1>({0.5 * si::AstronomicalUnit,
+                                               -1 * si::AstronomicalUnit,
+                                               i * si::AstronomicalUnit});
+    Velocity<World1> probe_velocity =
+        Velocity<World1>({i * Kilo(Metre) / Second,
+                          100 * Kilo(Metre) / Second,
+                          0 * SIUnit<Speed>()});
+    probe_holders.push_back(std::make_unique<TrajectoryHolder>(
+        NewLinearTrajectory(&probe,
+                            probe_initial_position,
+                            probe_velocity,
+                            Δt,
+                            steps)));
+  }
+
+  auto transforms = Transforms<TrajectoryHolder, World1, World2, World1>::
+      BarycentricRotating(earth_holder,
+                          thera_holder,
+                          &TrajectoryHolder::trajectory);
+  state.ResumeTiming();
+  while (state.KeepRunning()) {
+    if (!persistent) {
+      transforms = Transforms<TrajectoryHolder, World1, World2, World1>::
+          BarycentricRotating(earth_holder,
+                              thera_holder,
+                              &TrajectoryHolder::trajectory);
+    }
+    for (auto const& probe_holder : probe_holders) {
+      std::vector<Instant> times;
+      std::vector<Position<World1>> positions;
+      std::vector<Velocity<World1>> velocities;
+      transforms->TransformRange(*probe_holder,
+                                 &TrajectoryHolder::trajectory,
+                                 probe_holder->trajectory().first().time(),
+                                 probe_holder->trajectory().last().time(),
+                                 &times,
+                                 &positions,
+                                 &velocities);
+    }
+  }
+}
+
 int const kIter = 1000 << 10;
 
 BENCHMARK_TEMPLATE(BM_BodyCentredNonRotating, false)->Arg(kIter);
 BENCHMARK_TEMPLATE(BM_BodyCentredNonRotating, true)->Arg(kIter);
 BENCHMARK_TEMPLATE(BM_BarycentricRotating, false)->Arg(kIter);
 BENCHMARK_TEMPLATE(BM_BarycentricRotating, true)->Arg(kIter);
+BENCHMARK_TEMPLATE(BM_BarycentricRotatingTransformRange, false)->Arg(kIter);
+BENCHMARK_TEMPLATE(BM_BarycentricRotatingTransformRange, true)->Arg(kIter);
+BENCHMARK_TEMPLATE(BM_BarycentricRotatingMobiles, false)->Arg(1)->Arg(8);
+BENCHMARK_TEMPLATE(BM_BarycentricRotatingMobiles, true)->Arg(1)->Arg(8);
 
 }  // namespace benchmarks
 }  // namespace principia
@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "ksp_plugin/journal.hpp"
+#include "ksp_plugin/journal_player.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+
+using principia::ksp_plugin::Journal;
+using principia::ksp_plugin::JournalPlayer;
+using principia::quantities::Time;
+using principia::si::Milli;
+using principia::si::Second;
+
+namespace {
+
+// The |index|th smallest of the sorted |latencies|, in milliseconds.
+double Milliseconds(std::vector<Time> const& latencies, std::size_t index) {
+  return latencies[std::min(index, latencies.size() - 1)] / Milli(Second);
+}
+
+}  // namespace
+
+// Replays the journal given as the first argument and prints the latencies of
+// the calls, per method.  The optional second argument is the directory where
+// the histories are spilled during the replay.
+int main(int argc, char const* argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  google::LogToStderr();
+  CHECK(argc == 2 || argc == 3)
+      << "Usage: " << argv[0] << " journal [spill_directory]";
+  JournalPlayer player(argv[1]);
+  if (argc == 3) {
+    player.set_spill_directory(argv[2]);
+  }
+  while (player.Play()) {}
+
+  std::cout << player.calls() << " calls replayed\n"
+            << std::left << std::setw(40) << "method" << std::right
+            << std::setw(8) << "calls" << std::setw(12) << "total ms"
+            << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms"
+            << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+            << "\n";
+  for (int method = 0; method < Journal::kNumberOfMethods; ++method) {
+    std::vector<Time> latencies =
+        player.latencies(static_cast<Journal::Method>(method));
+    if (latencies.empty()) {
+      continue;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    Time total;
+    for (Time const& latency : latencies) {
+      total += latency;
+    }
+    std::size_t const size = latencies.size();
+    std::cout << std::left << std::setw(40)
+              << Journal::Name(static_cast<Journal::Method>(method))
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(8) << size
+              << std::setw(12) << total / Milli(Second)
+              << std::setw(10) << total / Milli(Second) / size
+              << std::setw(10) << Milliseconds(latencies, size / 2)
+              << std::setw(10) << Milliseconds(latencies, size * 99 / 100)
+              << std::setw(10) << Milliseconds(latencies, size - 1) << "\n";
+  }
+  return 0;
+}
@@ -0,0 +1,143 @@
+#include "ksp_plugin/advance_time_profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "base/not_null.hpp"
+#include "glog/logging.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+
+using base::not_null;
+using si::Second;
+
+namespace ksp_plugin {
+
+namespace {
+
+// Returns the |rank|-th smallest element of |values|, which is reordered.
+template<typename T>
+T NthSmallest(int const rank, not_null<std::vector<T>*> const values) {
+  std::nth_element(values->begin(), values->begin() + rank, values->end());
+  return (*values)[rank];
+}
+
+}  // namespace
+
+AdvanceTimeProfiler::AdvanceTimeProfiler(int const capacity)
+    : frames_(capacity) {
+  CHECK_LT(0, capacity);
+}
+
+void AdvanceTimeProfiler::StartFrame() {
+  CHECK(!frame_in_progress_);
+  frame_in_progress_ = true;
+  frames_[next_].fill(Measurement());
+}
+
+void AdvanceTimeProfiler::StartPhase(Phase const phase) {
+  CHECK(frame_in_progress_);
+  CHECK_LE(0, phase);
+  CHECK_LT(phase, kNumberOfPhases);
+  EndPhase();
+  phase_ = phase;
+  phase_start_ = Clock::now();
+}
+
+void AdvanceTimeProfiler::EndFrame() {
+  CHECK(frame_in_progress_);
+  EndPhase();
+  frame_in_progress_ = false;
+  next_ = (next_ + 1) % frames_.size();
+  size_ = std::min(size_ + 1, static_cast<int>(frames_.size()));
+}
+
+void AdvanceTimeProfiler::RecordIntegration(
+    std::int64_t const steps,
+    std::int64_t const force_evaluations,
+    std::int64_t const points_appended,
+    std::int64_t const allocations) {
+  if (phase_ == kNumberOfPhases) {
+    return;
+  }
+  Measurement& measurement = frames_[next_][phase_];
+  measurement.steps += steps;
+  measurement.force_evaluations += force_evaluations;
+  measurement.points_appended += points_appended;
+  measurement.allocations += allocations;
+}
+
+int AdvanceTimeProfiler::frames() const {
+  return size_;
+}
+
+AdvanceTimeProfiler::Measurement const& AdvanceTimeProfiler::measurement(
+    int const frame,
+    Phase const phase) const {
+  CHECK_LE(0, phase);
+  CHECK_LT(phase, kNumberOfPhases);
+  return frames_[Index(frame)][phase];
+}
+
+AdvanceTimeProfiler::Measurement AdvanceTimeProfiler::Percentile(
+    Phase const phase,
+    double const percentile) const {
+  CHECK_LE(0, phase);
+  CHECK_LT(phase, kNumberOfPhases);
+  CHECK_LE(0, percentile);
+  CHECK_LE(percentile, 100);
+  Measurement result;
+  if (size_ == 0) {
+    return result;
+  }
+  // The nearest rank, in [0, size_[.
+  int const rank = std::max(
+      0,
+      static_cast<int>(std::ceil(percentile / 100 * size_)) - 1);
+  std::vector<Time> durations;
+  std::vector<std::int64_t> steps;
+  std::vector<std::int64_t> force_evaluations;
+  std::vector<std::int64_t> points_appended;
+  std::vector<std::int64_t> allocations;
+  durations.reserve(size_);
+  steps.reserve(size_);
+  force_evaluations.reserve(size_);
+  points_appended.reserve(size_);
+  allocations.reserve(size_);
+  for (int frame = 0; frame < size_; ++frame) {
+    Measurement const& measurement = frames_[Index(frame)][phase];
+    durations.push_back(measurement.duration);
+    steps.push_back(measurement.steps);
+    force_evaluations.push_back(measurement.force_evaluations);
+    points_appended.push_back(measurement.points_appended);
+    allocations.push_back(measurement.allocations);
+  }
+  result.duration = NthSmallest<Time>(rank, &durations);
+  result.steps = NthSmallest<std::int64_t>(rank, &steps);
+  result.force_evaluations =
+      NthSmallest<std::int64_t>(rank, &force_evaluations);
+  result.points_appended = NthSmallest<std::int64_t>(rank, &points_appended);
+  result.allocations = NthSmallest<std::int64_t>(rank, &allocations);
+  return result;
+}
+
+void AdvanceTimeProfiler::EndPhase() {
+  if (phase_ == kNumberOfPhases) {
+    return;
+  }
+  std::chrono::duration<double> const elapsed = Clock::now() - phase_start_;
+  frames_[next_][phase_].duration += elapsed.count() * Second;
+  phase_ = kNumberOfPhases;
+}
+
+int AdvanceTimeProfiler::Index(int const frame) const {
+  CHECK_LE(0, frame);
+  CHECK_LT(frame, size_);
+  int const capacity = frames_.size();
+  return (next_ - 1 - frame + capacity) % capacity;
+}
+
+}  // namespace ksp_plugin
+}  // namespace principia
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <vector>
+
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using quantities::Time;
+
+namespace ksp_plugin {
+
+// Measures the work done by each phase of |Plugin::AdvanceTime()|, and keeps
+// the measurements of the last |capacity| frames in a ring buffer.  The
+// overhead is a read of a steady clock per phase, an increment per force
+// evaluation and a few additions per integration.  Not thread-safe: it must
+// only be used on the thread that calls |Plugin::AdvanceTime()|.
+class AdvanceTimeProfiler {
+ public:
+  // The phases of |Plugin::AdvanceTime()|.
+  enum Phase {
+    kCleanUpVessels,
+    kPrepareBubble,
+    kEvolveHistories,
+    kSynchronizeNewVesselsAndCleanDirtyVessels,
+    kResetProlongations,
+    kEvolveProlongationsAndBubble,
+    kUpdatePredictions,
+    kSpeculateHistories,
+    kReclaimForgottenHistoryPoints,
+    kSpillOldHistoryPoints,
+    kNumberOfPhases,
+  };
+
+  // The measurements of a phase in a frame.  A phase that doesn't run in a
+  // frame has a null measurement.
+  struct Measurement {
+    Time duration;
+    // The number of steps taken by the integrators.
+    std::int64_t steps = 0;
+    // The number of evaluations of the accelerations of all the integrated
+    // bodies, as counted by the |NBodySystem|.
+    std::int64_t force_evaluations = 0;
+    // The number of points appended to the trajectories by the integrators.
+    std::int64_t points_appended = 0;
+    // The number of heap allocations made by the arenas of the trajectories
+    // while appending these points.
+    std::int64_t allocations = 0;
+  };
+
+  // |capacity| must be positive.
+  explicit AdvanceTimeProfiler(int const capacity);
+
+  // Starts measuring a new frame, which replaces the oldest one if the buffer
+  // is full.  No frame must be in progress.
+  void StartFrame();
+  // Ends the current phase, if any, and starts measuring |phase|.  A frame
+  // must be in progress.  If |phase| was already measured in this frame, the
+  // new measurements are added to the old ones.
+  void StartPhase(Phase const phase);
+  // Ends the current phase, if any, and the current frame.
+  void EndFrame();
+
+  // Adds the given counts to the measurement of the current phase.  Does
+  // nothing if no phase is in progress.
+  void RecordIntegration(std::int64_t const steps,
+                         std::int64_t const force_evaluations,
+                         std::int64_t const points_appended,
+                         std::int64_t const allocations);
+
+  // The number of frames that have ended and are still in the buffer.
+  int frames() const;
+
+  // Returns the measurement of |phase| in the |frame|-th most recent frame
+  // that has ended, 0 being the most recent.  |frame| must be less than
+  // |frames()|.
+  Measurement const& measurement(int const frame, Phase const phase) const;
+
+  // Returns, for each field of the measurements of |phase|, the
+  // |percentile|-th percentile of its values over the frames in the buffer,
+  // computed by the nearest-rank method.  |percentile| must be in [0, 100].
+  // Returns a null measurement if there are no frames.
+  Measurement Percentile(Phase const phase, double const percentile) const;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+  using Frame = std::array<Measurement, kNumberOfPhases>;
+
+  // Ends the current phase, if any.
+  void EndPhase();
+
+  // Returns the index in |frames_| of the |frame|-th most recent frame that
+  // has ended.
+  int Index(int const frame) const;
+
+  std::vector<Frame> frames_;
+  // The index in |frames_| of the next frame to be measured.
+  int next_ = 0;
+  int size_ = 0;
+  bool frame_in_progress_ = false;
+  // |kNumberOfPhases| if no phase is in progress.
+  Phase phase_ = kNumberOfPhases;
+  Clock::time_point phase_start_;
+};
+
+}  // namespace ksp_plugin
+}  // namespace principia
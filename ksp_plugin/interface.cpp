@@ -16,6 +16,7 @@
 #include "base/pull_serializer.hpp"
 #include "base/push_deserializer.hpp"
 #include "base/version.hpp"
+#include "ksp_plugin/journal.hpp"
 #include "ksp_plugin/part.hpp"
 #include "serialization/ksp_plugin.pb.h"
 
@@ -70,6 +71,26 @@ XYZ ToXYZ(R3Element<double> const& r3_element) {
   return {r3_element.x, r3_element.y, r3_element.z};
 }
 
+RelativeDegreesOfFreedom<AliceSun> ToRelativeDegreesOfFreedom(QP const& qp) {
+  return RelativeDegreesOfFreedom<AliceSun>(
+      Displacement<AliceSun>(ToR3Element(qp.q) * Metre),
+      Velocity<AliceSun>(ToR3Element(qp.p) * (Metre / Second)));
+}
+
+QP ToQP(RelativeDegreesOfFreedom<AliceSun> const& relative) {
+  return {ToXYZ(relative.displacement().coordinates() / Metre),
+          ToXYZ(relative.velocity().coordinates() / (Metre / Second))};
+}
+
+PhaseMeasurement ToPhaseMeasurement(
+    AdvanceTimeProfiler::Measurement const& measurement) {
+  return {measurement.duration / Second,
+          measurement.steps,
+          measurement.force_evaluations,
+          measurement.points_appended,
+          measurement.allocations};
+}
+
 WXYZ ToWXYZ(Quaternion const& quaternion) {
   return {quaternion.real_part(),
           quaternion.imaginary_part().x,
@@ -80,6 +101,7 @@ WXYZ ToWXYZ(Quaternion const& quaternion) {
 }  // namespace
 
 void principia__InitGoogleLogging() {
+  Journal::Entry entry(Journal::kInitGoogleLogging);
   if (google::IsGoogleLoggingInitialized()) {
     LOG(INFO) << "Google logging was already initialized, no action taken";
   } else {
@@ -114,67 +136,103 @@ void principia__InitGoogleLogging() {
 }
 
 void principia__SetBufferedLogging(int const max_severity) {
+  Journal::Entry entry(Journal::kSetBufferedLogging);
+  entry.Write(max_severity);
   FLAGS_logbuflevel = max_severity;
 }
 
 int principia__GetBufferedLogging() {
+  Journal::Entry entry(Journal::kGetBufferedLogging);
   return FLAGS_logbuflevel;
 }
 
 void principia__SetBufferDuration(int const seconds) {
+  Journal::Entry entry(Journal::kSetBufferDuration);
+  entry.Write(seconds);
   FLAGS_logbufsecs = seconds;
 }
 
 int principia__GetBufferDuration() {
+  Journal::Entry entry(Journal::kGetBufferDuration);
   return FLAGS_logbufsecs;
 }
 
 void principia__SetSuppressedLogging(int const min_severity) {
+  Journal::Entry entry(Journal::kSetSuppressedLogging);
+  entry.Write(min_severity);
   FLAGS_minloglevel = min_severity;
 }
 
 int principia__GetSuppressedLogging() {
+  Journal::Entry entry(Journal::kGetSuppressedLogging);
   return FLAGS_minloglevel;
 }
 
 void principia__SetVerboseLogging(int const level) {
+  Journal::Entry entry(Journal::kSetVerboseLogging);
+  entry.Write(level);
   FLAGS_v = level;
 }
 
 int principia__GetVerboseLogging() {
+  Journal::Entry entry(Journal::kGetVerboseLogging);
   return FLAGS_v;
 }
 
 void principia__SetStderrLogging(int const min_severity) {
+  Journal::Entry entry(Journal::kSetStderrLogging);
+  entry.Write(min_severity);
   // NOTE(egg): We could use |FLAGS_stderrthreshold| instead, the difference
   // seems to be a mutex.
   google::SetStderrLogging(min_severity);
 }
 
 int principia__GetStderrLogging() {
+  Journal::Entry entry(Journal::kGetStderrLogging);
   return FLAGS_stderrthreshold;
 }
 
 void principia__LogInfo(char const* message) {
+  Journal::Entry entry(Journal::kLogInfo);
+  entry.WriteString(message);
   LOG(INFO) << message;
 }
 
 void principia__LogWarning(char const* message) {
+  Journal::Entry entry(Journal::kLogWarning);
+  entry.WriteString(message);
   LOG(WARNING) << message;
 }
 
 void principia__LogError(char const* message) {
+  Journal::Entry entry(Journal::kLogError);
+  entry.WriteString(message);
   LOG(ERROR) << message;
 }
 
 void principia__LogFatal(char const* message) {
+  Journal::Entry entry(Journal::kLogFatal);
+  entry.WriteString(message);
   LOG(FATAL) << message;
 }
 
+void principia__ActivateJournal(char const* path) {
+  Journal::Activate(CHECK_NOTNULL(path));
+}
+
+void principia__DeactivateJournal() {
+  Journal::Deactivate();
+}
+
 Plugin* principia__NewPlugin(double const initial_time,
                              int const sun_index,
                              double const sun_gravitational_parameter,
                              double const planetarium_rotation_in_degrees) {
+  Journal::Entry entry(Journal::kNewPlugin);
+  entry.Write(initial_time);
+  entry.Write(sun_index);
+  entry.Write(sun_gravitational_parameter);
+  entry.Write(planetarium_rotation_in_degrees);
   LOG(INFO) << "Constructing Principia plugin";
   not_null<std::unique_ptr<Plugin>> result = make_not_null_unique<Plugin>(
       Instant(initial_time * Second),
@@ -182,10 +240,13 @@ Plugin* principia__NewPlugin(double const initial_time,
       sun_gravitational_parameter * SIUnit<GravitationalParameter>(),
       planetarium_rotation_in_degrees * Degree);
   LOG(INFO) << "Plugin constructed";
+  entry.WritePointer(result.get());
   return result.release();
 }
 
 void principia__DeletePlugin(Plugin const** const plugin) {
+  Journal::Entry entry(Journal::kDeletePlugin);
+  entry.WritePointer(plugin == nullptr ? nullptr : *plugin);
   LOG(INFO) << "Destroying Principia plugin";
   // We want to log before and after destroying the plugin since it is a pretty
   // significant event, so we take ownership inside a block.
@@ -203,6 +264,12 @@ void principia__InsertCelestial(Plugin* const plugin,
                                 double const gravitational_parameter,
                                 int const parent_index,
                                 QP const from_parent) {
+  Journal::Entry entry(Journal::kInsertCelestial);
+  entry.WritePointer(plugin);
+  entry.Write(celestial_index);
+  entry.Write(gravitational_parameter);
+  entry.Write(parent_index);
+  entry.Write(from_parent);
   CHECK_NOTNULL(plugin)->InsertCelestial(
       celestial_index,
       gravitational_parameter * SIUnit<GravitationalParameter>(),
@@ -215,52 +282,253 @@ void principia__InsertCelestial(Plugin* const plugin,
 void principia__UpdateCelestialHierarchy(Plugin const* const plugin,
                                          int const celestial_index,
                                          int const parent_index) {
+  Journal::Entry entry(Journal::kUpdateCelestialHierarchy);
+  entry.WritePointer(plugin);
+  entry.Write(celestial_index);
+  entry.Write(parent_index);
   CHECK_NOTNULL(plugin)->UpdateCelestialHierarchy(celestial_index,
                                                   parent_index);
 }
 
 void principia__EndInitialization(Plugin* const plugin) {
+  Journal::Entry entry(Journal::kEndInitialization);
+  entry.WritePointer(plugin);
   CHECK_NOTNULL(plugin)->EndInitialization();
 }
 
 bool principia__InsertOrKeepVessel(Plugin* const plugin,
                                    char const* vessel_guid,
                                    int const parent_index) {
+  Journal::Entry entry(Journal::kInsertOrKeepVessel);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  entry.Write(parent_index);
   return CHECK_NOTNULL(plugin)->InsertOrKeepVessel(vessel_guid, parent_index);
 }
 
+int principia__InternVesselGUID(Plugin* const plugin,
+                                char const* vessel_guid) {
+  Journal::Entry entry(Journal::kInternVesselGUID);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  return CHECK_NOTNULL(plugin)->InternVesselGUID(vessel_guid);
+}
+
+bool principia__InsertOrKeepVesselByHandle(Plugin* const plugin,
+                                           int const vessel_handle,
+                                           int const parent_index) {
+  Journal::Entry entry(Journal::kInsertOrKeepVesselByHandle);
+  entry.WritePointer(plugin);
+  entry.Write(vessel_handle);
+  entry.Write(parent_index);
+  return CHECK_NOTNULL(plugin)->InsertOrKeepVesselByHandle(vessel_handle,
+                                                           parent_index);
+}
+
+void principia__InsertOrKeepVessels(Plugin* const plugin,
+                                    int const* const vessel_handles,
+                                    int const* const parent_indices,
+                                    int const count,
+                                    bool* const inserted) {
+  CHECK_NOTNULL(plugin);
+  CHECK_NOTNULL(vessel_handles);
+  CHECK_NOTNULL(parent_indices);
+  CHECK_NOTNULL(inserted);
+  Journal::Entry entry(Journal::kInsertOrKeepVessels);
+  entry.WritePointer(plugin);
+  entry.WriteArray(vessel_handles, count);
+  entry.WriteArray(parent_indices, count);
+  for (int i = 0; i < count; ++i) {
+    inserted[i] = plugin->InsertOrKeepVesselByHandle(vessel_handles[i],
+                                                     parent_indices[i]);
+  }
+}
+
 void principia__SetVesselStateOffset(Plugin* const plugin,
                                      char const* vessel_guid,
                                      QP const from_parent) {
+  Journal::Entry entry(Journal::kSetVesselStateOffset);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  entry.Write(from_parent);
   CHECK_NOTNULL(plugin)->SetVesselStateOffset(
       vessel_guid,
-      RelativeDegreesOfFreedom<AliceSun>(
-          Displacement<AliceSun>(ToR3Element(from_parent.q) * Metre),
-          Velocity<AliceSun>(ToR3Element(from_parent.p) * (Metre / Second))));
+      ToRelativeDegreesOfFreedom(from_parent));
+}
+
+void principia__SetVesselStateOffsetByHandle(Plugin* const plugin,
+                                             int const vessel_handle,
+                                             QP const from_parent) {
+  Journal::Entry entry(Journal::kSetVesselStateOffsetByHandle);
+  entry.WritePointer(plugin);
+  entry.Write(vessel_handle);
+  entry.Write(from_parent);
+  CHECK_NOTNULL(plugin)->SetVesselStateOffsetByHandle(
+      vessel_handle,
+      ToRelativeDegreesOfFreedom(from_parent));
+}
+
+void principia__SetVesselStateOffsets(Plugin* const plugin,
+                                      int const* const vessel_handles,
+                                      QP const* const from_parents,
+                                      int const count) {
+  CHECK_NOTNULL(plugin);
+  CHECK_NOTNULL(vessel_handles);
+  CHECK_NOTNULL(from_parents);
+  Journal::Entry entry(Journal::kSetVesselStateOffsets);
+  entry.WritePointer(plugin);
+  entry.WriteArray(vessel_handles, count);
+  entry.WriteArray(from_parents, count);
+  for (int i = 0; i < count; ++i) {
+    plugin->SetVesselStateOffsetByHandle(
+        vessel_handles[i],
+        ToRelativeDegreesOfFreedom(from_parents[i]));
+  }
 }
 
 void principia__AdvanceTime(Plugin* const plugin,
                             double const t,
                             double const planetarium_rotation) {
+  Journal::Entry entry(Journal::kAdvanceTime);
+  entry.WritePointer(plugin);
+  entry.Write(t);
+  entry.Write(planetarium_rotation);
   CHECK_NOTNULL(plugin)->AdvanceTime(Instant(t * Second),
                                      planetarium_rotation * Degree);
 }
 
 void principia__ForgetAllHistoriesBefore(Plugin* const plugin,
                                          double const t) {
+  Journal::Entry entry(Journal::kForgetAllHistoriesBefore);
+  entry.WritePointer(plugin);
+  entry.Write(t);
   CHECK_NOTNULL(plugin)->ForgetAllHistoriesBefore(Instant(t * Second));
 }
 
+void principia__SpillAllHistoriesBefore(Plugin const* const plugin,
+                                        double const t,
+                                        char const* directory) {
+  Journal::Entry entry(Journal::kSpillAllHistoriesBefore);
+  entry.WritePointer(plugin);
+  entry.Write(t);
+  entry.WriteString(directory);
+  CHECK_NOTNULL(plugin)->SpillAllHistoriesBefore(Instant(t * Second),
+                                                 directory);
+}
+
+void principia__EnableHistorySpilling(Plugin* const plugin,
+                                      char const* directory,
+                                      double const resident_history_length) {
+  Journal::Entry entry(Journal::kEnableHistorySpilling);
+  entry.WritePointer(plugin);
+  entry.WriteString(directory);
+  entry.Write(resident_history_length);
+  CHECK_NOTNULL(plugin)->EnableHistorySpilling(
+      CHECK_NOTNULL(directory),
+      resident_history_length * Second);
+}
+
+void principia__set_speculative_histories(Plugin* const plugin,
+                                          bool const speculative) {
+  Journal::Entry entry(Journal::kSetSpeculativeHistories);
+  entry.WritePointer(plugin);
+  entry.Write(speculative);
+  CHECK_NOTNULL(plugin)->set_speculative_histories(speculative);
+}
+
+void principia__set_dense_prolongations(Plugin* const plugin,
+                                        bool const dense) {
+  Journal::Entry entry(Journal::kSetDenseProlongations);
+  entry.WritePointer(plugin);
+  entry.Write(dense);
+  CHECK_NOTNULL(plugin)->set_dense_prolongations(dense);
+}
+
+void principia__set_fast_time_warp(Plugin* const plugin, bool const fast) {
+  Journal::Entry entry(Journal::kSetFastTimeWarp);
+  entry.WritePointer(plugin);
+  entry.Write(fast);
+  CHECK_NOTNULL(plugin)->set_fast_time_warp(fast);
+}
+
+void principia__set_incremental_forgetting(Plugin* const plugin,
+                                           bool const incremental) {
+  Journal::Entry entry(Journal::kSetIncrementalForgetting);
+  entry.WritePointer(plugin);
+  entry.Write(incremental);
+  CHECK_NOTNULL(plugin)->set_incremental_forgetting(incremental);
+}
+
+int principia__AdvanceTimeProfiledFrames(Plugin const* const plugin) {
+  Journal::Entry entry(Journal::kAdvanceTimeProfiledFrames);
+  entry.WritePointer(plugin);
+  return CHECK_NOTNULL(plugin)->advance_time_profiler().frames();
+}
+
+PhaseMeasurement principia__AdvanceTimePhaseMeasurement(
+    Plugin const* const plugin,
+    int const frame,
+    int const phase) {
+  Journal::Entry entry(Journal::kAdvanceTimePhaseMeasurement);
+  entry.WritePointer(plugin);
+  entry.Write(frame);
+  entry.Write(phase);
+  return ToPhaseMeasurement(
+      CHECK_NOTNULL(plugin)->advance_time_profiler().measurement(
+          frame,
+          static_cast<AdvanceTimeProfiler::Phase>(phase)));
+}
+
+PhaseMeasurement principia__AdvanceTimePhasePercentile(
+    Plugin const* const plugin,
+    int const phase,
+    double const percentile) {
+  Journal::Entry entry(Journal::kAdvanceTimePhasePercentile);
+  entry.WritePointer(plugin);
+  entry.Write(phase);
+  entry.Write(percentile);
+  return ToPhaseMeasurement(
+      CHECK_NOTNULL(plugin)->advance_time_profiler().Percentile(
+          static_cast<AdvanceTimeProfiler::Phase>(phase),
+          percentile));
+}
+
 QP principia__VesselFromParent(Plugin const* const plugin,
                                char const* vessel_guid) {
-  RelativeDegreesOfFreedom<AliceSun> const result =
-      CHECK_NOTNULL(plugin)->VesselFromParent(vessel_guid);
-  return {ToXYZ(result.displacement().coordinates() / Metre),
-          ToXYZ(result.velocity().coordinates() / (Metre / Second))};
+  Journal::Entry entry(Journal::kVesselFromParent);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  return ToQP(CHECK_NOTNULL(plugin)->VesselFromParent(vessel_guid));
+}
+
+QP principia__VesselFromParentByHandle(Plugin const* const plugin,
+                                       int const vessel_handle) {
+  Journal::Entry entry(Journal::kVesselFromParentByHandle);
+  entry.WritePointer(plugin);
+  entry.Write(vessel_handle);
+  return ToQP(CHECK_NOTNULL(plugin)->VesselFromParentByHandle(vessel_handle));
+}
+
+void principia__VesselsFromParents(Plugin const* const plugin,
+                                   int const* const vessel_handles,
+                                   int const count,
+                                   QP* const from_parents) {
+  CHECK_NOTNULL(plugin);
+  CHECK_NOTNULL(vessel_handles);
+  CHECK_NOTNULL(from_parents);
+  Journal::Entry entry(Journal::kVesselsFromParents);
+  entry.WritePointer(plugin);
+  entry.WriteArray(vessel_handles, count);
+  for (int i = 0; i < count; ++i) {
+    from_parents[i] = ToQP(plugin->VesselFromParentByHandle(vessel_handles[i]));
+  }
 }
 
 QP principia__CelestialFromParent(Plugin const* const plugin,
                                    int const celestial_index) {
+  Journal::Entry entry(Journal::kCelestialFromParent);
+  entry.WritePointer(plugin);
+  entry.Write(celestial_index);
   RelativeDegreesOfFreedom<AliceSun> const result =
       CHECK_NOTNULL(plugin)->CelestialFromParent(celestial_index);
   return {ToXYZ(result.displacement().coordinates() / Metre),
@@ -270,85 +538,197 @@ QP principia__CelestialFromParent(Plugin const* const plugin,
 RenderingTransforms* principia__NewBodyCentredNonRotatingTransforms(
     Plugin const* const plugin,
     int const reference_body_index) {
-  return CHECK_NOTNULL(plugin)->
+  Journal::Entry entry(Journal::kNewBodyCentredNonRotatingTransforms);
+  entry.WritePointer(plugin);
+  entry.Write(reference_body_index);
+  RenderingTransforms* const result = CHECK_NOTNULL(plugin)->
       NewBodyCentredNonRotatingTransforms(reference_body_index).release();
+  entry.WritePointer(result);
+  return result;
 }
 
 RenderingTransforms* principia__NewBarycentricRotatingTransforms(
     Plugin const* const plugin,
     int const primary_index,
     int const secondary_index) {
-  return CHECK_NOTNULL(plugin)->
+  Journal::Entry entry(Journal::kNewBarycentricRotatingTransforms);
+  entry.WritePointer(plugin);
+  entry.Write(primary_index);
+  entry.Write(secondary_index);
+  RenderingTransforms* const result = CHECK_NOTNULL(plugin)->
       NewBarycentricRotatingTransforms(
           primary_index, secondary_index).release();
+  entry.WritePointer(result);
+  return result;
 }
 
 void principia__DeleteTransforms(RenderingTransforms** const transforms) {
+  Journal::Entry entry(Journal::kDeleteTransforms);
+  entry.WritePointer(transforms == nullptr ? nullptr : *transforms);
   TakeOwnership(transforms);
 }
 
+CacheStatistics principia__TransformsCacheStatistics(
+    RenderingTransforms const* const transforms) {
+  Journal::Entry entry(Journal::kTransformsCacheStatistics);
+  entry.WritePointer(transforms);
+  RenderingTransforms::CacheStatistics const& statistics =
+      CHECK_NOTNULL(transforms)->first_cache_statistics();
+  return {statistics.hits, statistics.misses, statistics.evictions};
+}
+
 LineAndIterator* principia__RenderedVesselTrajectory(
     Plugin const* const plugin,
     char const* vessel_guid,
     RenderingTransforms* const transforms,
-    XYZ const sun_world_position) {
+    XYZ const sun_world_position,
+    double const tolerance,
+    double const level_of_detail) {
+  Journal::Entry entry(Journal::kRenderedVesselTrajectory);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  entry.WritePointer(transforms);
+  entry.Write(sun_world_position);
+  entry.Write(tolerance);
+  entry.Write(level_of_detail);
   RenderedTrajectory<World> rendered_trajectory = CHECK_NOTNULL(plugin)->
       RenderedVesselTrajectory(
           vessel_guid,
           transforms,
           World::origin + Displacement<World>(
-                              ToR3Element(sun_world_position) * Metre));
+                              ToR3Element(sun_world_position) * Metre),
+          tolerance * Metre,
+          level_of_detail);
   not_null<std::unique_ptr<LineAndIterator>> result =
       make_not_null_unique<LineAndIterator>(std::move(rendered_trajectory));
   result->it = result->rendered_trajectory.begin();
+  entry.WritePointer(result.get());
   return result.release();
 }
 
 LineAndIterator* principia__RenderedPrediction(
     Plugin* const plugin,
+    char const* vessel_guid,
     RenderingTransforms* const transforms,
-    XYZ const sun_world_position) {
+    XYZ const sun_world_position,
+    double const tolerance,
+    double const level_of_detail) {
+  Journal::Entry entry(Journal::kRenderedPrediction);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  entry.WritePointer(transforms);
+  entry.Write(sun_world_position);
+  entry.Write(tolerance);
+  entry.Write(level_of_detail);
   RenderedTrajectory<World> rendered_trajectory =
       CHECK_NOTNULL(plugin)->RenderedPrediction(
+          vessel_guid,
           transforms,
           World::origin + Displacement<World>(
-                              ToR3Element(sun_world_position) * Metre));
+                              ToR3Element(sun_world_position) * Metre),
+          tolerance * Metre,
+          level_of_detail);
   not_null<std::unique_ptr<LineAndIterator>> result =
       make_not_null_unique<LineAndIterator>(std::move(rendered_trajectory));
   result->it = result->rendered_trajectory.begin();
+  entry.WritePointer(result.get());
   return result.release();
 }
 
 void principia__set_predicted_vessel(Plugin* const plugin,
                                      char const* vessel_guid) {
+  Journal::Entry entry(Journal::kSetPredictedVessel);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
   CHECK_NOTNULL(plugin)->set_predicted_vessel(vessel_guid);
 }
 
+void principia__add_predicted_vessel(Plugin* const plugin,
+                                     char const* vessel_guid) {
+  Journal::Entry entry(Journal::kAddPredictedVessel);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  CHECK_NOTNULL(plugin)->add_predicted_vessel(vessel_guid);
+}
+
+void principia__remove_predicted_vessel(Plugin* const plugin,
+                                        char const* vessel_guid) {
+  Journal::Entry entry(Journal::kRemovePredictedVessel);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  CHECK_NOTNULL(plugin)->remove_predicted_vessel(vessel_guid);
+}
+
 void principia__clear_predicted_vessel(Plugin* const plugin) {
+  Journal::Entry entry(Journal::kClearPredictedVessel);
+  entry.WritePointer(plugin);
   CHECK_NOTNULL(plugin)->clear_predicted_vessel();
 }
 
+bool principia__has_prediction(Plugin const* const plugin,
+                               char const* vessel_guid) {
+  Journal::Entry entry(Journal::kHasPrediction);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  return CHECK_NOTNULL(plugin)->has_prediction(vessel_guid);
+}
+
 void principia__set_prediction_length(Plugin* const plugin,
                                       double const t) {
+  Journal::Entry entry(Journal::kSetPredictionLength);
+  entry.WritePointer(plugin);
+  entry.Write(t);
   CHECK_NOTNULL(plugin)->set_prediction_length(t * Second);
 }
 
 void principia__set_prediction_step(Plugin* const plugin,
                                     double const t) {
+  Journal::Entry entry(Journal::kSetPredictionStep);
+  entry.WritePointer(plugin);
+  entry.Write(t);
   CHECK_NOTNULL(plugin)->set_prediction_step(t * Second);
 }
 
+void principia__set_asynchronous_predictions(Plugin* const plugin,
+                                             bool const asynchronous) {
+  Journal::Entry entry(Journal::kSetAsynchronousPredictions);
+  entry.WritePointer(plugin);
+  entry.Write(asynchronous);
+  CHECK_NOTNULL(plugin)->set_asynchronous_predictions(asynchronous);
+}
+
+double principia__prediction_staleness(Plugin const* const plugin) {
+  Journal::Entry entry(Journal::kPredictionStaleness);
+  entry.WritePointer(plugin);
+  return CHECK_NOTNULL(plugin)->prediction_staleness() / Second;
+}
+
 bool principia__has_vessel(Plugin* const plugin,
                            char const* vessel_guid) {
+  Journal::Entry entry(Journal::kHasVessel);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
   return CHECK_NOTNULL(plugin)->has_vessel(vessel_guid);
 }
 
+bool principia__has_vessel_by_handle(Plugin const* const plugin,
+                                     int const vessel_handle) {
+  Journal::Entry entry(Journal::kHasVesselByHandle);
+  entry.WritePointer(plugin);
+  entry.Write(vessel_handle);
+  return CHECK_NOTNULL(plugin)->has_vessel_by_handle(vessel_handle);
+}
+
 int principia__NumberOfSegments(LineAndIterator const* line_and_iterator) {
+  Journal::Entry entry(Journal::kNumberOfSegments);
+  entry.WritePointer(line_and_iterator);
   return CHECK_NOTNULL(line_and_iterator)->rendered_trajectory.size();
 }
 
 XYZSegment principia__FetchAndIncrement(
     LineAndIterator* const line_and_iterator) {
+  Journal::Entry entry(Journal::kFetchAndIncrement);
+  entry.WritePointer(line_and_iterator);
   CHECK_NOTNULL(line_and_iterator);
   CHECK(line_and_iterator->it != line_and_iterator->rendered_trajectory.end());
   LineSegment<World> const result = *line_and_iterator->it;
@@ -357,13 +737,38 @@ XYZSegment principia__FetchAndIncrement(
           ToXYZ((result.end - World::origin).coordinates() / Metre)};
 }
 
+int principia__FetchAndIncrementSegments(
+    LineAndIterator* const line_and_iterator,
+    XYZSegment* const segments,
+    int const count) {
+  Journal::Entry entry(Journal::kFetchAndIncrementSegments);
+  entry.WritePointer(line_and_iterator);
+  entry.Write(count);
+  CHECK_NOTNULL(line_and_iterator);
+  CHECK_NOTNULL(segments);
+  int fetched = 0;
+  for (auto& it = line_and_iterator->it;
+       fetched < count && it != line_and_iterator->rendered_trajectory.end();
+       ++fetched, ++it) {
+    segments[fetched] =
+        {ToXYZ((it->begin - World::origin).coordinates() / Metre),
+         ToXYZ((it->end - World::origin).coordinates() / Metre)};
+  }
+  return fetched;
+}
+
 bool principia__AtEnd(LineAndIterator* const line_and_iterator) {
+  Journal::Entry entry(Journal::kAtEnd);
+  entry.WritePointer(line_and_iterator);
   CHECK_NOTNULL(line_and_iterator);
   return line_and_iterator->it == line_and_iterator->rendered_trajectory.end();
 }
 
 void principia__DeleteLineAndIterator(
     LineAndIterator** const line_and_iterator) {
+  Journal::Entry entry(Journal::kDeleteLineAndIterator);
+  entry.WritePointer(line_and_iterator == nullptr ? nullptr
+                                                 : *line_and_iterator);
   TakeOwnership(line_and_iterator);
 }
 
@@ -371,6 +776,10 @@ void principia__AddVesselToNextPhysicsBubble(Plugin* const plugin,
                                              char const* vessel_guid,
                                              KSPPart const* const parts,
                                              int count) {
+  Journal::Entry entry(Journal::kAddVesselToNextPhysicsBubble);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  entry.WriteArray(parts, count);
   VLOG(1) << __FUNCTION__ << '\n' << NAMED(count);
   std::vector<principia::ksp_plugin::IdAndOwnedPart> vessel_parts;
   vessel_parts.reserve(count);
@@ -396,11 +805,16 @@ void principia__AddVesselToNextPhysicsBubble(Plugin* const plugin,
 }
 
 bool principia__PhysicsBubbleIsEmpty(Plugin const* const plugin) {
+  Journal::Entry entry(Journal::kPhysicsBubbleIsEmpty);
+  entry.WritePointer(plugin);
   return CHECK_NOTNULL(plugin)->PhysicsBubbleIsEmpty();
 }
 
 XYZ principia__BubbleDisplacementCorrection(Plugin const* const plugin,
                                             XYZ const sun_position) {
+  Journal::Entry entry(Journal::kBubbleDisplacementCorrection);
+  entry.WritePointer(plugin);
+  entry.Write(sun_position);
   Displacement<World> const result =
       CHECK_NOTNULL(plugin)->BubbleDisplacementCorrection(
           World::origin + Displacement<World>(
@@ -410,6 +824,9 @@ XYZ principia__BubbleDisplacementCorrection(Plugin const* const plugin,
 
 XYZ principia__BubbleVelocityCorrection(Plugin const* const plugin,
                                         int const reference_body_index) {
+  Journal::Entry entry(Journal::kBubbleVelocityCorrection);
+  entry.WritePointer(plugin);
+  entry.Write(reference_body_index);
   Velocity<World> const result =
       CHECK_NOTNULL(plugin)->BubbleVelocityCorrection(reference_body_index);
   return ToXYZ(result.coordinates() / (Metre / Second));
@@ -420,6 +837,11 @@ WXYZ principia__NavballOrientation(
     RenderingTransforms* const transforms,
     XYZ const sun_world_position,
     XYZ const ship_world_position) {
+  Journal::Entry entry(Journal::kNavballOrientation);
+  entry.WritePointer(plugin);
+  entry.WritePointer(transforms);
+  entry.Write(sun_world_position);
+  entry.Write(ship_world_position);
   FrameField<World> const frame_field = CHECK_NOTNULL(plugin)->Navball(
       transforms,
       World::origin +
@@ -434,11 +856,17 @@ WXYZ principia__NavballOrientation(
 XYZ principia__VesselTangent(Plugin const* const plugin,
                              char const* vessel_guid,
                              RenderingTransforms* const transforms) {
+  Journal::Entry entry(Journal::kVesselTangent);
+  entry.WritePointer(plugin);
+  entry.WriteString(vessel_guid);
+  entry.WritePointer(transforms);
   return ToXYZ(CHECK_NOTNULL(plugin)->
                    VesselTangent(vessel_guid, transforms).coordinates());
 }
 
 double principia__current_time(Plugin const* const plugin) {
+  Journal::Entry entry(Journal::kCurrentTime);
+  entry.WritePointer(plugin);
   return (CHECK_NOTNULL(plugin)->current_time() - Instant()) / Second;
 }
 
@@ -447,6 +875,9 @@ char const* principia__SerializePlugin(Plugin const* const plugin,
   LOG(INFO) << __FUNCTION__;
   CHECK_NOTNULL(plugin);
   CHECK_NOTNULL(serializer);
+  Journal::Entry entry(Journal::kSerializePlugin);
+  entry.WritePointer(plugin);
+  entry.WritePointer(*serializer);
 
   // Create and start a serializer if the caller didn't provide one.
   if (*serializer == nullptr) {
@@ -464,6 +895,8 @@ char const* principia__SerializePlugin(Plugin const* const plugin,
   // nullptr.
   if (bytes.size == 0) {
     TakeOwnership(serializer);
+    entry.WritePointer(*serializer);
+    entry.WritePointer(nullptr);
     return nullptr;
   }
 
@@ -472,11 +905,17 @@ char const* principia__SerializePlugin(Plugin const* const plugin,
   UniqueBytes hexadecimal(hexadecimal_size);
   HexadecimalEncode(bytes, hexadecimal.get());
   hexadecimal.data.get()[hexadecimal_size - 1] = '\0';
-  return reinterpret_cast<char const*>(hexadecimal.data.release());
+  char const* const result =
+      reinterpret_cast<char const*>(hexadecimal.data.release());
+  entry.WritePointer(*serializer);
+  entry.WritePointer(result);
+  return result;
 }
 
 void principia__DeletePluginSerialization(char const** const serialization) {
   LOG(INFO) << __FUNCTION__;
+  Journal::Entry entry(Journal::kDeletePluginSerialization);
+  entry.WritePointer(serialization == nullptr ? nullptr : *serialization);
   TakeOwnershipArray(reinterpret_cast<uint8_t const**>(serialization));
 }
 
@@ -488,6 +927,10 @@ void principia__DeserializePlugin(char const* const serialization,
   CHECK_NOTNULL(serialization);
   CHECK_NOTNULL(deserializer);
   CHECK_NOTNULL(plugin);
+  Journal::Entry entry(Journal::kDeserializePlugin);
+  entry.WriteArray(serialization, serialization_size);
+  entry.WritePointer(*deserializer);
+  entry.WritePointer(*plugin);
 
   // Create and start a deserializer if the caller didn't provide one.
   if (*deserializer == nullptr) {
@@ -520,9 +963,12 @@ void principia__DeserializePlugin(char const* const serialization,
   if (byte_size == 0) {
     delete *deserializer;
   }
+  entry.WritePointer(*deserializer);
+  entry.WritePointer(*plugin);
 }
 
 char const* principia__SayHello() {
+  Journal::Entry entry(Journal::kSayHello);
   return "Hello from native C++!";
 }
 
@@ -15,8 +15,8 @@ using physics::Transforms;
 namespace ksp_plugin {
 
 struct LineAndIterator {
-  explicit LineAndIterator(RenderedTrajectory<World> const& rendered_trajectory)
-      : rendered_trajectory(rendered_trajectory) {}
+  explicit LineAndIterator(RenderedTrajectory<World> rendered_trajectory)
+      : rendered_trajectory(std::move(rendered_trajectory)) {}
   RenderedTrajectory<World> const rendered_trajectory;
   RenderedTrajectory<World>::const_iterator it;
 };
@@ -65,6 +65,29 @@ struct KSPPart {
 static_assert(std::is_standard_layout<KSPPart>::value,
               "KSPPart is used for interfacing");
 
+extern "C"
+struct CacheStatistics {
+  int64_t hits;
+  int64_t misses;
+  int64_t evictions;
+};
+
+static_assert(std::is_standard_layout<CacheStatistics>::value,
+              "CacheStatistics is used for interfacing");
+
+// An |AdvanceTimeProfiler::Measurement|, with the duration in seconds.
+extern "C"
+struct PhaseMeasurement {
+  double duration;
+  int64_t steps;
+  int64_t force_evaluations;
+  int64_t points_appended;
+  int64_t allocations;
+};
+
+static_assert(std::is_standard_layout<PhaseMeasurement>::value,
+              "PhaseMeasurement is used for interfacing");
+
 // Sets stderr to log INFO, and redirects stderr, which Unity does not log, to
 // "<KSP directory>/stderr.log".  This provides an easily accessible file
 // containing a sufficiently verbose log of the latest session, instead of
@@ -117,6 +140,17 @@ void CDECL principia__LogError(char const* message);
 extern "C" DLLEXPORT
 void CDECL principia__LogFatal(char const* message);
 
+// Starts recording all the calls to the other functions of this interface in
+// a journal at |path|, which is overwritten if it exists.  The journal can be
+// replayed by the journal player.  It must be activated before the plugin is
+// constructed or deserialized, since the player can only replay calls on
+// objects that were created while recording.  |path| must not be null.
+extern "C" DLLEXPORT
+void CDECL principia__ActivateJournal(char const* path);
+// Stops recording the journal, if any.
+extern "C" DLLEXPORT
+void CDECL principia__DeactivateJournal();
+
 // Returns a pointer to a plugin constructed with the arguments given.
 // The caller takes ownership of the result.
 extern "C" DLLEXPORT
@@ -160,6 +194,31 @@ bool CDECL principia__InsertOrKeepVessel(Plugin* const plugin,
                                          char const* vessel_guid,
                                          int const parent_index);
 
+// Calls |plugin->InternVesselGUID| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+int CDECL principia__InternVesselGUID(Plugin* const plugin,
+                                      char const* vessel_guid);
+
+// Calls |plugin->InsertOrKeepVesselByHandle| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+bool CDECL principia__InsertOrKeepVesselByHandle(Plugin* const plugin,
+                                                 int const vessel_handle,
+                                                 int const parent_index);
+
+// Calls |plugin->InsertOrKeepVesselByHandle| for each of the |count| vessels
+// given by |vessel_handles| and |parent_indices|, and stores the results in
+// |inserted|.  |plugin|, |vessel_handles|, |parent_indices| and |inserted|
+// must not be null, and the arrays must have |count| elements.  No transfer of
+// ownership.
+extern "C" DLLEXPORT
+void CDECL principia__InsertOrKeepVessels(Plugin* const plugin,
+                                          int const* const vessel_handles,
+                                          int const* const parent_indices,
+                                          int const count,
+                                          bool* const inserted);
+
 // Calls |plugin->SetVesselStateOffset| with the arguments given.
 // |plugin| must not be null.  No transfer of ownership.
 extern "C" DLLEXPORT
@@ -167,6 +226,23 @@ void CDECL principia__SetVesselStateOffset(Plugin* const plugin,
                                            char const* vessel_guid,
                                            QP const from_parent);
 
+// Calls |plugin->SetVesselStateOffsetByHandle| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__SetVesselStateOffsetByHandle(Plugin* const plugin,
+                                                   int const vessel_handle,
+                                                   QP const from_parent);
+
+// Calls |plugin->SetVesselStateOffsetByHandle| for each of the |count| vessels
+// given by |vessel_handles| and |from_parents|.  |plugin|, |vessel_handles|
+// and |from_parents| must not be null, and the arrays must have |count|
+// elements.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__SetVesselStateOffsets(Plugin* const plugin,
+                                            int const* const vessel_handles,
+                                            QP const* const from_parents,
+                                            int const count);
+
 extern "C" DLLEXPORT
 void CDECL principia__AdvanceTime(Plugin* const plugin,
                                   double const t,
@@ -176,12 +252,91 @@ extern "C" DLLEXPORT
 void CDECL principia__ForgetAllHistoriesBefore(Plugin* const plugin,
                                                double const t);
 
+// Calls |plugin->SpillAllHistoriesBefore| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__SpillAllHistoriesBefore(Plugin const* const plugin,
+                                              double const t,
+                                              char const* directory);
+
+// Calls |plugin->EnableHistorySpilling| with the arguments given, the length
+// being in seconds.  |plugin| and |directory| must not be null.  No transfer
+// of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__EnableHistorySpilling(
+    Plugin* const plugin,
+    char const* directory,
+    double const resident_history_length);
+
+// Calls |plugin->set_speculative_histories| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__set_speculative_histories(Plugin* const plugin,
+                                                bool const speculative);
+
+// Calls |plugin->set_dense_prolongations| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__set_dense_prolongations(Plugin* const plugin,
+                                              bool const dense);
+
+// Calls |plugin->set_fast_time_warp| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__set_fast_time_warp(Plugin* const plugin,
+                                         bool const fast);
+
+// Calls |plugin->set_incremental_forgetting| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__set_incremental_forgetting(Plugin* const plugin,
+                                                 bool const incremental);
+
+// Returns |plugin->advance_time_profiler().frames()|.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+int CDECL principia__AdvanceTimeProfiledFrames(Plugin const* const plugin);
+
+// Returns |plugin->advance_time_profiler().measurement(frame, phase)|, where
+// |phase| is an |AdvanceTimeProfiler::Phase|.  |plugin| must not be null.  No
+// transfer of ownership.
+extern "C" DLLEXPORT
+PhaseMeasurement CDECL principia__AdvanceTimePhaseMeasurement(
+    Plugin const* const plugin,
+    int const frame,
+    int const phase);
+
+// Returns |plugin->advance_time_profiler().Percentile(phase, percentile)|,
+// where |phase| is an |AdvanceTimeProfiler::Phase|.  |plugin| must not be
+// null.  No transfer of ownership.
+extern "C" DLLEXPORT
+PhaseMeasurement CDECL principia__AdvanceTimePhasePercentile(
+    Plugin const* const plugin,
+    int const phase,
+    double const percentile);
+
 // Calls |plugin->VesselFromParent| with the arguments given.
 // |plugin| must not be null.  No transfer of ownership.
 extern "C" DLLEXPORT
 QP CDECL principia__VesselFromParent(Plugin const* const plugin,
                                      char const* vessel_guid);
 
+// Calls |plugin->VesselFromParentByHandle| with the arguments given.
+// |plugin| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+QP CDECL principia__VesselFromParentByHandle(Plugin const* const plugin,
+                                             int const vessel_handle);
+
+// Calls |plugin->VesselFromParentByHandle| for each of the |count| vessels
+// given by |vessel_handles|, and stores the results in |from_parents|.
+// |plugin|, |vessel_handles| and |from_parents| must not be null, and the
+// arrays must have |count| elements.  No transfer of ownership.
+extern "C" DLLEXPORT
+void CDECL principia__VesselsFromParents(Plugin const* const plugin,
+                                         int const* const vessel_handles,
+                                         int const count,
+                                         QP* const from_parents);
+
 // Calls |plugin->CelestialFromParent| with the arguments given.
 // |plugin| must not be null.  No transfer of ownership.
 extern "C" DLLEXPORT
@@ -209,8 +364,15 @@ RenderingTransforms* CDECL principia__NewBarycentricRotatingTransforms(
 extern "C" DLLEXPORT
 void CDECL principia__DeleteTransforms(RenderingTransforms** const transforms);
 
+// Returns the hit, miss and eviction counts of the cache of |transforms|.
+// |transforms| must not be null.  No transfer of ownership.
+extern "C" DLLEXPORT
+CacheStatistics CDECL principia__TransformsCacheStatistics(
+    RenderingTransforms const* const transforms);
+
 // Returns the result of |plugin->RenderedVesselTrajectory| called with the
-// arguments given, together with an iterator to its beginning.
+// arguments given, together with an iterator to its beginning.  |tolerance| is
+// in metres.  |level_of_detail| is dimensionless, 0 to render all the points.
 // |plugin| must not be null.  No transfer of ownership of |plugin|.  The caller
 // gets ownership of the result.  |frame| must not be null.  No transfer of
 // ownership of |frame|.
@@ -219,13 +381,18 @@ LineAndIterator* CDECL principia__RenderedVesselTrajectory(
     Plugin const* const plugin,
     char const* vessel_guid,
     RenderingTransforms* const transforms,
-    XYZ const sun_world_position);
+    XYZ const sun_world_position,
+    double const tolerance,
+    double const level_of_detail);
 
 extern "C" DLLEXPORT
 LineAndIterator* CDECL principia__RenderedPrediction(
     Plugin* const plugin,
+    char const* vessel_guid,
     RenderingTransforms* const transforms,
-    XYZ const sun_world_position);
+    XYZ const sun_world_position,
+    double const tolerance,
+    double const level_of_detail);
 
 // Returns |line_and_iterator->rendered_trajectory.size()|.
 // |line_and_iterator| must not be null.  No transfer of ownership.
@@ -241,6 +408,20 @@ extern "C" DLLEXPORT
 XYZSegment CDECL principia__FetchAndIncrement(
     LineAndIterator* const line_and_iterator);
 
+// Copies to |segments| the |XYZSegment|s corresponding to at most |count|
+// |LineSegment|s starting at |*line_and_iterator->it|, and increments
+// |line_and_iterator->it| past them.  Returns the number of segments copied,
+// which is less than |count| only if the end of
+// |line_and_iterator->rendered_trajectory| was reached.  This amortizes the
+// cost of the calls over many segments.
+// |line_and_iterator| must not be null.  |segments| must point to an array of
+// at least |count| elements.  No transfer of ownership.
+extern "C" DLLEXPORT
+int CDECL principia__FetchAndIncrementSegments(
+    LineAndIterator* const line_and_iterator,
+    XYZSegment* const segments,
+    int const count);
+
 // Returns |true| if and only if |line_and_iterator->it| is the end of
 // |line_and_iterator->rendered_trajectory|.
 // |line_and_iterator| must not be null.  No transfer of ownership.
@@ -258,9 +439,21 @@ extern "C" DLLEXPORT
 void CDECL principia__set_predicted_vessel(Plugin* const plugin,
                                            char const* vessel_guid);
 
+extern "C" DLLEXPORT
+void CDECL principia__add_predicted_vessel(Plugin* const plugin,
+                                           char const* vessel_guid);
+
+extern "C" DLLEXPORT
+void CDECL principia__remove_predicted_vessel(Plugin* const plugin,
+                                              char const* vessel_guid);
+
 extern "C" DLLEXPORT
 void CDECL principia__clear_predicted_vessel(Plugin* const plugin);
 
+extern "C" DLLEXPORT
+bool CDECL principia__has_prediction(Plugin const* const plugin,
+                                     char const* vessel_guid);
+
 extern "C" DLLEXPORT
 void CDECL principia__set_prediction_length(Plugin* const plugin,
                                             double const t);
@@ -269,10 +462,22 @@ extern "C" DLLEXPORT
 void CDECL principia__set_prediction_step(Plugin* const plugin,
                                           double const t);
 
+extern "C" DLLEXPORT
+void CDECL principia__set_asynchronous_predictions(Plugin* const plugin,
+                                                   bool const asynchronous);
+
+// The staleness of the current prediction, in seconds.
+extern "C" DLLEXPORT
+double CDECL principia__prediction_staleness(Plugin const* const plugin);
+
 extern "C" DLLEXPORT
 bool CDECL principia__has_vessel(Plugin* const plugin,
                                  char const* vessel_guid);
 
+extern "C" DLLEXPORT
+bool CDECL principia__has_vessel_by_handle(Plugin const* const plugin,
+                                           int const vessel_handle);
+
 extern "C" DLLEXPORT
 void CDECL principia__AddVesselToNextPhysicsBubble(Plugin* const plugin,
                                                    char const* vessel_guid,
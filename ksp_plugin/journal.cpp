@@ -0,0 +1,226 @@
+#include "ksp_plugin/journal.hpp"
+
+#include <cstring>
+#include <string>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace ksp_plugin {
+
+namespace {
+
+char const kMagic[] = {'P', 'r', 'J', 'o', 'u', 'r', 'n', 'l'};
+std::uint32_t const kVersion = 1;
+
+char const* const kMethodNames[] = {
+    "InitGoogleLogging",
+    "SetBufferedLogging",
+    "GetBufferedLogging",
+    "SetBufferDuration",
+    "GetBufferDuration",
+    "SetSuppressedLogging",
+    "GetSuppressedLogging",
+    "SetVerboseLogging",
+    "GetVerboseLogging",
+    "SetStderrLogging",
+    "GetStderrLogging",
+    "LogInfo",
+    "LogWarning",
+    "LogError",
+    "LogFatal",
+    "NewPlugin",
+    "DeletePlugin",
+    "InsertCelestial",
+    "UpdateCelestialHierarchy",
+    "EndInitialization",
+    "InsertOrKeepVessel",
+    "InternVesselGUID",
+    "InsertOrKeepVesselByHandle",
+    "InsertOrKeepVessels",
+    "SetVesselStateOffset",
+    "SetVesselStateOffsetByHandle",
+    "SetVesselStateOffsets",
+    "AdvanceTime",
+    "ForgetAllHistoriesBefore",
+    "SpillAllHistoriesBefore",
+    "set_speculative_histories",
+    "set_dense_prolongations",
+    "set_fast_time_warp",
+    "AdvanceTimeProfiledFrames",
+    "AdvanceTimePhaseMeasurement",
+    "AdvanceTimePhasePercentile",
+    "VesselFromParent",
+    "VesselFromParentByHandle",
+    "VesselsFromParents",
+    "CelestialFromParent",
+    "NewBodyCentredNonRotatingTransforms",
+    "NewBarycentricRotatingTransforms",
+    "DeleteTransforms",
+    "TransformsCacheStatistics",
+    "RenderedVesselTrajectory",
+    "RenderedPrediction",
+    "NumberOfSegments",
+    "FetchAndIncrement",
+    "FetchAndIncrementSegments",
+    "AtEnd",
+    "DeleteLineAndIterator",
+    "set_predicted_vessel",
+    "add_predicted_vessel",
+    "remove_predicted_vessel",
+    "clear_predicted_vessel",
+    "has_prediction",
+    "set_prediction_length",
+    "set_prediction_step",
+    "set_asynchronous_predictions",
+    "prediction_staleness",
+    "has_vessel",
+    "has_vessel_by_handle",
+    "AddVesselToNextPhysicsBubble",
+    "PhysicsBubbleIsEmpty",
+    "BubbleDisplacementCorrection",
+    "BubbleVelocityCorrection",
+    "NavballOrientation",
+    "VesselTangent",
+    "current_time",
+    "SerializePlugin",
+    "DeletePluginSerialization",
+    "DeserializePlugin",
+    "SayHello",
+    "EnableHistorySpilling",
+    "set_incremental_forgetting",
+};
+
+static_assert(sizeof(kMethodNames) / sizeof(kMethodNames[0]) ==
+                  Journal::kNumberOfMethods,
+              "There must be one name per method");
+
+}  // namespace
+
+std::unique_ptr<Journal> Journal::active_;
+
+Journal::Entry::Entry(Method const method)
+    : journal_(active_.get()),
+      method_(method) {}
+
+Journal::Entry::~Entry() {
+  if (journal_ != nullptr) {
+    journal_->Append(method_, payload_);
+  }
+}
+
+void Journal::Entry::WritePointer(void const* const pointer) {
+  Write(static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(pointer)));
+}
+
+void Journal::Entry::WriteString(char const* const string) {
+  if (journal_ == nullptr) {
+    return;
+  }
+  CHECK_NOTNULL(string);
+  WriteArray(string, static_cast<int>(std::strlen(string)));
+}
+
+void Journal::Entry::WriteBytes(void const* const data, int const size) {
+  if (journal_ == nullptr) {
+    return;
+  }
+  payload_.append(static_cast<char const*>(data), size);
+}
+
+Journal::Reader::Reader(std::string const& path)
+    : stream_(path, std::ios::in | std::ios::binary) {
+  CHECK(stream_.good()) << "Cannot open journal " << path;
+  char magic[sizeof(kMagic)];
+  std::uint32_t version;
+  stream_.read(magic, sizeof(magic));
+  stream_.read(reinterpret_cast<char*>(&version), sizeof(version));
+  CHECK(stream_.good()) << "Truncated journal " << path;
+  CHECK_EQ(0, std::memcmp(magic, kMagic, sizeof(kMagic)))
+      << path << " is not a journal";
+  CHECK_EQ(kVersion, version) << "Unsupported journal version";
+}
+
+bool Journal::Reader::ReadEntry() {
+  std::uint16_t method;
+  std::uint32_t size;
+  stream_.read(reinterpret_cast<char*>(&method), sizeof(method));
+  if (stream_.eof() && stream_.gcount() == 0) {
+    return false;
+  }
+  stream_.read(reinterpret_cast<char*>(&size), sizeof(size));
+  CHECK(stream_.good()) << "Truncated entry header";
+  CHECK_LT(method, kNumberOfMethods);
+  method_ = static_cast<Method>(method);
+  payload_.resize(size);
+  if (size > 0) {
+    stream_.read(&payload_[0], size);
+    CHECK(stream_.good()) << "Truncated entry for " << Name(method_);
+  }
+  position_ = 0;
+  return true;
+}
+
+Journal::Method Journal::Reader::method() const {
+  return method_;
+}
+
+bool Journal::Reader::AtEndOfEntry() const {
+  return position_ == static_cast<int>(payload_.size());
+}
+
+std::uint64_t Journal::Reader::ReadPointer() {
+  return Read<std::uint64_t>();
+}
+
+std::string Journal::Reader::ReadString() {
+  std::vector<char> const characters = ReadArray<char>();
+  return std::string(characters.begin(), characters.end());
+}
+
+void Journal::Reader::ReadBytes(void* const data, int const size) {
+  CHECK_LE(position_ + size, static_cast<int>(payload_.size()))
+      << "Payload exhausted for " << Name(method_);
+  std::memcpy(data, &payload_[position_], size);
+  position_ += size;
+}
+
+void Journal::Activate(std::string const& path) {
+  active_.reset(new Journal(path));
+  LOG(INFO) << "Recording journal " << path;
+}
+
+void Journal::Deactivate() {
+  active_.reset();
+}
+
+bool Journal::IsActive() {
+  return active_ != nullptr;
+}
+
+char const* Journal::Name(Method const method) {
+  CHECK_LT(method, kNumberOfMethods);
+  return kMethodNames[method];
+}
+
+Journal::Journal(std::string const& path)
+    : stream_(path, std::ios::out | std::ios::binary | std::ios::trunc) {
+  CHECK(stream_.good()) << "Cannot open journal " << path;
+  stream_.write(kMagic, sizeof(kMagic));
+  stream_.write(reinterpret_cast<char const*>(&kVersion), sizeof(kVersion));
+}
+
+void Journal::Append(Method const method, std::string const& payload) {
+  std::uint16_t const method_number = method;
+  std::uint32_t const size = static_cast<std::uint32_t>(payload.size());
+  stream_.write(reinterpret_cast<char const*>(&method_number),
+                sizeof(method_number));
+  stream_.write(reinterpret_cast<char const*>(&size), sizeof(size));
+  stream_.write(payload.data(), payload.size());
+  if (method == kAdvanceTime) {
+    stream_.flush();
+  }
+}
+
+}  // namespace ksp_plugin
+}  // namespace principia
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace principia {
+namespace ksp_plugin {
+
+// A compact binary record of the calls made through the C interface, which
+// makes it possible to replay a game session without the game.  The file
+// starts with a magic number and a version, followed by one entry per call.
+// An entry is made of the |Method| as a 16-bit integer, the size of its
+// payload as a 32-bit integer, and the payload.  The payload contains the
+// arguments of the call, in order, followed by the pointers that the call
+// returned or wrote through its out-parameters, which are needed to track the
+// objects owned by the caller.  Numbers and structs are stored in their native
+// representation, pointers as 64-bit integers, strings and arrays as a 32-bit
+// size followed by their elements.
+// The journal is not thread-safe: the C interface must only be called from one
+// thread while it is active.
+class Journal {
+ public:
+  // One per function of the C interface, except those that control the
+  // journal.  The values are recorded in the journals, so new methods must be
+  // added at the end, before |kNumberOfMethods|, and existing ones must not be
+  // reordered or removed.  Any other change to this enum must increment
+  // |kVersion| in journal.cpp.
+  enum Method : std::uint16_t {
+    kInitGoogleLogging,
+    kSetBufferedLogging,
+    kGetBufferedLogging,
+    kSetBufferDuration,
+    kGetBufferDuration,
+    kSetSuppressedLogging,
+    kGetSuppressedLogging,
+    kSetVerboseLogging,
+    kGetVerboseLogging,
+    kSetStderrLogging,
+    kGetStderrLogging,
+    kLogInfo,
+    kLogWarning,
+    kLogError,
+    kLogFatal,
+    kNewPlugin,
+    kDeletePlugin,
+    kInsertCelestial,
+    kUpdateCelestialHierarchy,
+    kEndInitialization,
+    kInsertOrKeepVessel,
+    kInternVesselGUID,
+    kInsertOrKeepVesselByHandle,
+    kInsertOrKeepVessels,
+    kSetVesselStateOffset,
+    kSetVesselStateOffsetByHandle,
+    kSetVesselStateOffsets,
+    kAdvanceTime,
+    kForgetAllHistoriesBefore,
+    kSpillAllHistoriesBefore,
+    kSetSpeculativeHistories,
+    kSetDenseProlongations,
+    kSetFastTimeWarp,
+    kAdvanceTimeProfiledFrames,
+    kAdvanceTimePhaseMeasurement,
+    kAdvanceTimePhasePercentile,
+    kVesselFromParent,
+    kVesselFromParentByHandle,
+    kVesselsFromParents,
+    kCelestialFromParent,
+    kNewBodyCentredNonRotatingTransforms,
+    kNewBarycentricRotatingTransforms,
+    kDeleteTransforms,
+    kTransformsCacheStatistics,
+    kRenderedVesselTrajectory,
+    kRenderedPrediction,
+    kNumberOfSegments,
+    kFetchAndIncrement,
+    kFetchAndIncrementSegments,
+    kAtEnd,
+    kDeleteLineAndIterator,
+    kSetPredictedVessel,
+    kAddPredictedVessel,
+    kRemovePredictedVessel,
+    kClearPredictedVessel,
+    kHasPrediction,
+    kSetPredictionLength,
+    kSetPredictionStep,
+    kSetAsynchronousPredictions,
+    kPredictionStaleness,
+    kHasVessel,
+    kHasVesselByHandle,
+    kAddVesselToNextPhysicsBubble,
+    kPhysicsBubbleIsEmpty,
+    kBubbleDisplacementCorrection,
+    kBubbleVelocityCorrection,
+    kNavballOrientation,
+    kVesselTangent,
+    kCurrentTime,
+    kSerializePlugin,
+    kDeletePluginSerialization,
+    kDeserializePlugin,
+    kSayHello,
+    kEnableHistorySpilling,
+    kSetIncrementalForgetting,
+    kNumberOfMethods,
+  };
+
+  // Records a call to a function of the C interface.  The arguments and
+  // results are written to the entry by the |Write| functions, and the entry is
+  // added to the active journal when it is destroyed, i.e., when the call
+  // returns.  If there is no active journal when the entry is constructed, the
+  // |Write| functions do nothing.
+  class Entry {
+   public:
+    explicit Entry(Method const method);
+    ~Entry();
+
+    // |T| must be a number or a standard-layout struct.
+    template<typename T>
+    void Write(T const& value);
+    // Writes the |count| elements of |values|.  |values| may only be null if
+    // |count| is 0.
+    template<typename T>
+    void WriteArray(T const* const values, int const count);
+    void WritePointer(void const* const pointer);
+    // |string| must not be null.
+    void WriteString(char const* const string);
+
+   private:
+    void WriteBytes(void const* const data, int const size);
+
+    Journal* const journal_;
+    Method const method_;
+    std::string payload_;
+  };
+
+  // Reads the entries of a journal, in the order in which they were written.
+  class Reader {
+   public:
+    // Checks that |path| is a journal of the current version.
+    explicit Reader(std::string const& path);
+
+    // Reads the next entry and returns true, or returns false if all the
+    // entries have been read.
+    bool ReadEntry();
+    // The method of the entry last read.
+    Method method() const;
+    // Returns true if the entire payload of the entry last read has been read.
+    bool AtEndOfEntry() const;
+
+    // The following functions read the payload of the entry last read, in the
+    // order in which it was written.  They check that the payload is not
+    // exhausted.
+    template<typename T>
+    T Read();
+    // The |data()| of the result is never null.
+    template<typename T>
+    std::vector<T> ReadArray();
+    std::uint64_t ReadPointer();
+    std::string ReadString();
+
+   private:
+    void ReadBytes(void* const data, int const size);
+
+    std::ifstream stream_;
+    Method method_ = kNumberOfMethods;
+    std::string payload_;
+    int position_ = 0;
+  };
+
+  // Starts writing the entries to a new journal at |path|, which is
+  // overwritten if it exists.  Closes the active journal, if any.
+  static void Activate(std::string const& path);
+  // Closes the active journal, if any.
+  static void Deactivate();
+  static bool IsActive();
+
+  // The name of the function of the C interface corresponding to |method|,
+  // without the |principia__| prefix.
+  static char const* Name(Method const method);
+
+ private:
+  explicit Journal(std::string const& path);
+
+  // Writes an entry.  The stream is flushed after each |kAdvanceTime| so that
+  // at most a frame is lost if the game crashes.
+  void Append(Method const method, std::string const& payload);
+
+  std::ofstream stream_;
+
+  static std::unique_ptr<Journal> active_;
+};
+
+}  // namespace ksp_plugin
+}  // namespace principia
+
+#include "journal_body.hpp"
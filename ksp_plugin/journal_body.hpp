@@ -0,0 +1,61 @@
+#pragma once
+
+#include "journal.hpp"
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace ksp_plugin {
+
+template<typename T>
+void Journal::Entry::Write(T const& value) {
+  static_assert(std::is_standard_layout<T>::value && !std::is_pointer<T>::value,
+                "Only numbers and structs may be written");
+  WriteBytes(&value, sizeof(value));
+}
+
+template<typename T>
+void Journal::Entry::WriteArray(T const* const values, int const count) {
+  static_assert(std::is_standard_layout<T>::value && !std::is_pointer<T>::value,
+                "Only arrays of numbers and structs may be written");
+  if (journal_ == nullptr) {
+    return;
+  }
+  CHECK_LE(0, count);
+  CHECK(values != nullptr || count == 0);
+  Write(static_cast<std::int32_t>(count));
+  WriteBytes(values, count * sizeof(T));
+}
+
+template<typename T>
+T Journal::Reader::Read() {
+  static_assert(std::is_standard_layout<T>::value && !std::is_pointer<T>::value,
+                "Only numbers and structs may be read");
+  T value;
+  ReadBytes(&value, sizeof(value));
+  return value;
+}
+
+template<typename T>
+std::vector<T> Journal::Reader::ReadArray() {
+  static_assert(std::is_standard_layout<T>::value && !std::is_pointer<T>::value,
+                "Only arrays of numbers and structs may be read");
+  std::int32_t const count = Read<std::int32_t>();
+  CHECK_LE(0, count);
+  std::vector<T> values;
+  // Make sure that |data()| is not null even if |count| is 0, as the functions
+  // of the interface reject null arrays.
+  values.reserve(std::max(count, 1));
+  values.resize(count);
+  if (count > 0) {
+    ReadBytes(values.data(), count * sizeof(T));
+  }
+  return values;
+}
+
+}  // namespace ksp_plugin
+}  // namespace principia
@@ -0,0 +1,763 @@
+#include "ksp_plugin/journal_player.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "quantities/si.hpp"
+
+namespace principia {
+
+using si::Second;
+
+namespace ksp_plugin {
+
+JournalPlayer::JournalPlayer(std::string const& path)
+    : reader_(path),
+      latencies_(Journal::kNumberOfMethods) {}
+
+JournalPlayer::~JournalPlayer() {
+  for (auto const& pair : lines_and_iterators_) {
+    LineAndIterator* line_and_iterator = pair.second;
+    principia__DeleteLineAndIterator(&line_and_iterator);
+  }
+  for (auto const& pair : transforms_) {
+    RenderingTransforms* transforms = pair.second;
+    principia__DeleteTransforms(&transforms);
+  }
+  for (auto const& pair : serializations_) {
+    char const* serialization = pair.second;
+    principia__DeletePluginSerialization(&serialization);
+  }
+  for (auto const& pair : serializers_) {
+    delete pair.second;
+  }
+  for (auto const& pair : plugins_) {
+    Plugin const* plugin = pair.second;
+    principia__DeletePlugin(&plugin);
+  }
+  // The deserializers that are still running are leaked, since deleting them
+  // would wait for data that never comes.
+}
+
+bool JournalPlayer::Play() {
+  if (!reader_.ReadEntry()) {
+    return false;
+  }
+  PlayEntry();
+  CHECK(reader_.AtEndOfEntry())
+      << "Payload not exhausted for " << Journal::Name(reader_.method());
+  ++calls_;
+  return true;
+}
+
+std::int64_t JournalPlayer::calls() const {
+  return calls_;
+}
+
+std::vector<Time> const& JournalPlayer::latencies(
+    Journal::Method const method) const {
+  CHECK_LT(method, Journal::kNumberOfMethods);
+  return latencies_[method];
+}
+
+void JournalPlayer::set_spill_directory(std::string const& directory) {
+  spill_directory_ = directory;
+}
+
+template<typename T>
+T* JournalPlayer::Find(std::uint64_t const recorded,
+                       Objects<T> const& objects) {
+  if (recorded == 0) {
+    return nullptr;
+  }
+  auto const it = objects.find(recorded);
+  CHECK(it != objects.end()) << "Unknown object " << recorded;
+  return it->second;
+}
+
+template<typename T>
+void JournalPlayer::Insert(std::uint64_t const recorded,
+                           T* const replayed,
+                           not_null<Objects<T>*> const objects) {
+  CHECK_EQ(recorded == 0, replayed == nullptr)
+      << "Replay diverged for object " << recorded;
+  if (recorded != 0) {
+    (*objects)[recorded] = replayed;
+  }
+}
+
+template<typename Call>
+void JournalPlayer::Measure(Call const& call) {
+  Clock::time_point const start = Clock::now();
+  call();
+  std::chrono::duration<double> const elapsed = Clock::now() - start;
+  latencies_[reader_.method()].push_back(elapsed.count() * Second);
+}
+
+void JournalPlayer::PlayEntry() {
+  switch (reader_.method()) {
+    case Journal::kInitGoogleLogging: {
+      Measure([]() { principia__InitGoogleLogging(); });
+      break;
+    }
+    case Journal::kSetBufferedLogging: {
+      int const max_severity = reader_.Read<int>();
+      Measure([&]() { principia__SetBufferedLogging(max_severity); });
+      break;
+    }
+    case Journal::kGetBufferedLogging: {
+      Measure([]() { principia__GetBufferedLogging(); });
+      break;
+    }
+    case Journal::kSetBufferDuration: {
+      int const seconds = reader_.Read<int>();
+      Measure([&]() { principia__SetBufferDuration(seconds); });
+      break;
+    }
+    case Journal::kGetBufferDuration: {
+      Measure([]() { principia__GetBufferDuration(); });
+      break;
+    }
+    case Journal::kSetSuppressedLogging: {
+      int const min_severity = reader_.Read<int>();
+      Measure([&]() { principia__SetSuppressedLogging(min_severity); });
+      break;
+    }
+    case Journal::kGetSuppressedLogging: {
+      Measure([]() { principia__GetSuppressedLogging(); });
+      break;
+    }
+    case Journal::kSetVerboseLogging: {
+      int const level = reader_.Read<int>();
+      Measure([&]() { principia__SetVerboseLogging(level); });
+      break;
+    }
+    case Journal::kGetVerboseLogging: {
+      Measure([]() { principia__GetVerboseLogging(); });
+      break;
+    }
+    case Journal::kSetStderrLogging: {
+      int const min_severity = reader_.Read<int>();
+      Measure([&]() { principia__SetStderrLogging(min_severity); });
+      break;
+    }
+    case Journal::kGetStderrLogging: {
+      Measure([]() { principia__GetStderrLogging(); });
+      break;
+    }
+    case Journal::kLogInfo: {
+      std::string const message = reader_.ReadString();
+      Measure([&]() { principia__LogInfo(message.c_str()); });
+      break;
+    }
+    case Journal::kLogWarning: {
+      std::string const message = reader_.ReadString();
+      Measure([&]() { principia__LogWarning(message.c_str()); });
+      break;
+    }
+    case Journal::kLogError: {
+      std::string const message = reader_.ReadString();
+      Measure([&]() { principia__LogError(message.c_str()); });
+      break;
+    }
+    case Journal::kLogFatal: {
+      std::string const message = reader_.ReadString();
+      Measure([&]() { principia__LogFatal(message.c_str()); });
+      break;
+    }
+    case Journal::kNewPlugin: {
+      double const initial_time = reader_.Read<double>();
+      int const sun_index = reader_.Read<int>();
+      double const sun_gravitational_parameter = reader_.Read<double>();
+      double const planetarium_rotation_in_degrees = reader_.Read<double>();
+      Plugin* plugin = nullptr;
+      Measure([&]() {
+        plugin = principia__NewPlugin(initial_time,
+                                      sun_index,
+                                      sun_gravitational_parameter,
+                                      planetarium_rotation_in_degrees);
+      });
+      Insert<Plugin>(reader_.ReadPointer(), plugin, &plugins_);
+      break;
+    }
+    case Journal::kDeletePlugin: {
+      std::uint64_t const recorded = reader_.ReadPointer();
+      Plugin const* plugin = Find(recorded, plugins_);
+      Measure([&]() { principia__DeletePlugin(&plugin); });
+      plugins_.erase(recorded);
+      break;
+    }
+    case Journal::kInsertCelestial: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const celestial_index = reader_.Read<int>();
+      double const gravitational_parameter = reader_.Read<double>();
+      int const parent_index = reader_.Read<int>();
+      QP const from_parent = reader_.Read<QP>();
+      Measure([&]() {
+        principia__InsertCelestial(plugin,
+                                   celestial_index,
+                                   gravitational_parameter,
+                                   parent_index,
+                                   from_parent);
+      });
+      break;
+    }
+    case Journal::kUpdateCelestialHierarchy: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const celestial_index = reader_.Read<int>();
+      int const parent_index = reader_.Read<int>();
+      Measure([&]() {
+        principia__UpdateCelestialHierarchy(plugin,
+                                            celestial_index,
+                                            parent_index);
+      });
+      break;
+    }
+    case Journal::kEndInitialization: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      Measure([&]() { principia__EndInitialization(plugin); });
+      break;
+    }
+    case Journal::kInsertOrKeepVessel: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      int const parent_index = reader_.Read<int>();
+      Measure([&]() {
+        principia__InsertOrKeepVessel(plugin,
+                                      vessel_guid.c_str(),
+                                      parent_index);
+      });
+      break;
+    }
+    case Journal::kInternVesselGUID: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      Measure([&]() {
+        principia__InternVesselGUID(plugin, vessel_guid.c_str());
+      });
+      break;
+    }
+    case Journal::kInsertOrKeepVesselByHandle: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const vessel_handle = reader_.Read<int>();
+      int const parent_index = reader_.Read<int>();
+      Measure([&]() {
+        principia__InsertOrKeepVesselByHandle(plugin,
+                                              vessel_handle,
+                                              parent_index);
+      });
+      break;
+    }
+    case Journal::kInsertOrKeepVessels: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::vector<int> const vessel_handles = reader_.ReadArray<int>();
+      std::vector<int> const parent_indices = reader_.ReadArray<int>();
+      CHECK_EQ(vessel_handles.size(), parent_indices.size());
+      int const count = static_cast<int>(vessel_handles.size());
+      std::unique_ptr<bool[]> const inserted(new bool[count]);
+      Measure([&]() {
+        principia__InsertOrKeepVessels(plugin,
+                                       vessel_handles.data(),
+                                       parent_indices.data(),
+                                       count,
+                                       inserted.get());
+      });
+      break;
+    }
+    case Journal::kSetVesselStateOffset: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      QP const from_parent = reader_.Read<QP>();
+      Measure([&]() {
+        principia__SetVesselStateOffset(plugin,
+                                        vessel_guid.c_str(),
+                                        from_parent);
+      });
+      break;
+    }
+    case Journal::kSetVesselStateOffsetByHandle: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const vessel_handle = reader_.Read<int>();
+      QP const from_parent = reader_.Read<QP>();
+      Measure([&]() {
+        principia__SetVesselStateOffsetByHandle(plugin,
+                                                vessel_handle,
+                                                from_parent);
+      });
+      break;
+    }
+    case Journal::kSetVesselStateOffsets: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::vector<int> const vessel_handles = reader_.ReadArray<int>();
+      std::vector<QP> const from_parents = reader_.ReadArray<QP>();
+      CHECK_EQ(vessel_handles.size(), from_parents.size());
+      Measure([&]() {
+        principia__SetVesselStateOffsets(
+            plugin,
+            vessel_handles.data(),
+            from_parents.data(),
+            static_cast<int>(vessel_handles.size()));
+      });
+      break;
+    }
+    case Journal::kAdvanceTime: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      double const t = reader_.Read<double>();
+      double const planetarium_rotation = reader_.Read<double>();
+      Measure([&]() {
+        principia__AdvanceTime(plugin, t, planetarium_rotation);
+      });
+      break;
+    }
+    case Journal::kForgetAllHistoriesBefore: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      double const t = reader_.Read<double>();
+      Measure([&]() { principia__ForgetAllHistoriesBefore(plugin, t); });
+      break;
+    }
+    case Journal::kSpillAllHistoriesBefore: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      double const t = reader_.Read<double>();
+      std::string directory = reader_.ReadString();
+      if (!spill_directory_.empty()) {
+        directory = spill_directory_;
+      }
+      Measure([&]() {
+        principia__SpillAllHistoriesBefore(plugin, t, directory.c_str());
+      });
+      break;
+    }
+    case Journal::kEnableHistorySpilling: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string directory = reader_.ReadString();
+      double const resident_history_length = reader_.Read<double>();
+      if (!spill_directory_.empty()) {
+        directory = spill_directory_;
+      }
+      Measure([&]() {
+        principia__EnableHistorySpilling(plugin,
+                                         directory.c_str(),
+                                         resident_history_length);
+      });
+      break;
+    }
+    case Journal::kSetSpeculativeHistories: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      bool const speculative = reader_.Read<bool>();
+      Measure([&]() {
+        principia__set_speculative_histories(plugin, speculative);
+      });
+      break;
+    }
+    case Journal::kSetDenseProlongations: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      bool const dense = reader_.Read<bool>();
+      Measure([&]() { principia__set_dense_prolongations(plugin, dense); });
+      break;
+    }
+    case Journal::kSetFastTimeWarp: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      bool const fast = reader_.Read<bool>();
+      Measure([&]() { principia__set_fast_time_warp(plugin, fast); });
+      break;
+    }
+    case Journal::kSetIncrementalForgetting: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      bool const incremental = reader_.Read<bool>();
+      Measure([&]() {
+        principia__set_incremental_forgetting(plugin, incremental);
+      });
+      break;
+    }
+    case Journal::kAdvanceTimeProfiledFrames: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      Measure([&]() { principia__AdvanceTimeProfiledFrames(plugin); });
+      break;
+    }
+    case Journal::kAdvanceTimePhaseMeasurement: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const frame = reader_.Read<int>();
+      int const phase = reader_.Read<int>();
+      Measure([&]() {
+        principia__AdvanceTimePhaseMeasurement(plugin, frame, phase);
+      });
+      break;
+    }
+    case Journal::kAdvanceTimePhasePercentile: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const phase = reader_.Read<int>();
+      double const percentile = reader_.Read<double>();
+      Measure([&]() {
+        principia__AdvanceTimePhasePercentile(plugin, phase, percentile);
+      });
+      break;
+    }
+    case Journal::kVesselFromParent: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      Measure([&]() {
+        principia__VesselFromParent(plugin, vessel_guid.c_str());
+      });
+      break;
+    }
+    case Journal::kVesselFromParentByHandle: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const vessel_handle = reader_.Read<int>();
+      Measure([&]() {
+        principia__VesselFromParentByHandle(plugin, vessel_handle);
+      });
+      break;
+    }
+    case Journal::kVesselsFromParents: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::vector<int> const vessel_handles = reader_.ReadArray<int>();
+      int const count = static_cast<int>(vessel_handles.size());
+      std::unique_ptr<QP[]> const from_parents(new QP[count]);
+      Measure([&]() {
+        principia__VesselsFromParents(plugin,
+                                      vessel_handles.data(),
+                                      count,
+                                      from_parents.get());
+      });
+      break;
+    }
+    case Journal::kCelestialFromParent: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const celestial_index = reader_.Read<int>();
+      Measure([&]() {
+        principia__CelestialFromParent(plugin, celestial_index);
+      });
+      break;
+    }
+    case Journal::kNewBodyCentredNonRotatingTransforms: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const reference_body_index = reader_.Read<int>();
+      RenderingTransforms* transforms = nullptr;
+      Measure([&]() {
+        transforms = principia__NewBodyCentredNonRotatingTransforms(
+                         plugin, reference_body_index);
+      });
+      Insert<RenderingTransforms>(reader_.ReadPointer(),
+                                   transforms,
+                                   &transforms_);
+      break;
+    }
+    case Journal::kNewBarycentricRotatingTransforms: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const primary_index = reader_.Read<int>();
+      int const secondary_index = reader_.Read<int>();
+      RenderingTransforms* transforms = nullptr;
+      Measure([&]() {
+        transforms = principia__NewBarycentricRotatingTransforms(
+                         plugin, primary_index, secondary_index);
+      });
+      Insert<RenderingTransforms>(reader_.ReadPointer(),
+                                   transforms,
+                                   &transforms_);
+      break;
+    }
+    case Journal::kDeleteTransforms: {
+      std::uint64_t const recorded = reader_.ReadPointer();
+      RenderingTransforms* transforms = Find(recorded, transforms_);
+      Measure([&]() { principia__DeleteTransforms(&transforms); });
+      transforms_.erase(recorded);
+      break;
+    }
+    case Journal::kTransformsCacheStatistics: {
+      RenderingTransforms* const transforms =
+          Find(reader_.ReadPointer(), transforms_);
+      Measure([&]() { principia__TransformsCacheStatistics(transforms); });
+      break;
+    }
+    case Journal::kRenderedVesselTrajectory: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      RenderingTransforms* const transforms =
+          Find(reader_.ReadPointer(), transforms_);
+      XYZ const sun_world_position = reader_.Read<XYZ>();
+      double const tolerance = reader_.Read<double>();
+      double const level_of_detail = reader_.Read<double>();
+      LineAndIterator* line_and_iterator = nullptr;
+      Measure([&]() {
+        line_and_iterator =
+            principia__RenderedVesselTrajectory(plugin,
+                                                vessel_guid.c_str(),
+                                                transforms,
+                                                sun_world_position,
+                                                tolerance,
+                                                level_of_detail);
+      });
+      Insert<LineAndIterator>(reader_.ReadPointer(),
+                              line_and_iterator,
+                              &lines_and_iterators_);
+      break;
+    }
+    case Journal::kRenderedPrediction: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      RenderingTransforms* const transforms =
+          Find(reader_.ReadPointer(), transforms_);
+      XYZ const sun_world_position = reader_.Read<XYZ>();
+      double const tolerance = reader_.Read<double>();
+      double const level_of_detail = reader_.Read<double>();
+      LineAndIterator* line_and_iterator = nullptr;
+      Measure([&]() {
+        line_and_iterator =
+            principia__RenderedPrediction(plugin,
+                                          vessel_guid.c_str(),
+                                          transforms,
+                                          sun_world_position,
+                                          tolerance,
+                                          level_of_detail);
+      });
+      Insert<LineAndIterator>(reader_.ReadPointer(),
+                              line_and_iterator,
+                              &lines_and_iterators_);
+      break;
+    }
+    case Journal::kNumberOfSegments: {
+      LineAndIterator* const line_and_iterator =
+          Find(reader_.ReadPointer(), lines_and_iterators_);
+      Measure([&]() { principia__NumberOfSegments(line_and_iterator); });
+      break;
+    }
+    case Journal::kFetchAndIncrement: {
+      LineAndIterator* const line_and_iterator =
+          Find(reader_.ReadPointer(), lines_and_iterators_);
+      Measure([&]() { principia__FetchAndIncrement(line_and_iterator); });
+      break;
+    }
+    case Journal::kFetchAndIncrementSegments: {
+      LineAndIterator* const line_and_iterator =
+          Find(reader_.ReadPointer(), lines_and_iterators_);
+      int const count = reader_.Read<int>();
+      std::unique_ptr<XYZSegment[]> const segments(new XYZSegment[count]);
+      Measure([&]() {
+        principia__FetchAndIncrementSegments(line_and_iterator,
+                                             segments.get(),
+                                             count);
+      });
+      break;
+    }
+    case Journal::kAtEnd: {
+      LineAndIterator* const line_and_iterator =
+          Find(reader_.ReadPointer(), lines_and_iterators_);
+      Measure([&]() { principia__AtEnd(line_and_iterator); });
+      break;
+    }
+    case Journal::kDeleteLineAndIterator: {
+      std::uint64_t const recorded = reader_.ReadPointer();
+      LineAndIterator* line_and_iterator =
+          Find(recorded, lines_and_iterators_);
+      Measure([&]() { principia__DeleteLineAndIterator(&line_and_iterator); });
+      lines_and_iterators_.erase(recorded);
+      break;
+    }
+    case Journal::kSetPredictedVessel: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      Measure([&]() {
+        principia__set_predicted_vessel(plugin, vessel_guid.c_str());
+      });
+      break;
+    }
+    case Journal::kAddPredictedVessel: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      Measure([&]() {
+        principia__add_predicted_vessel(plugin, vessel_guid.c_str());
+      });
+      break;
+    }
+    case Journal::kRemovePredictedVessel: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      Measure([&]() {
+        principia__remove_predicted_vessel(plugin, vessel_guid.c_str());
+      });
+      break;
+    }
+    case Journal::kClearPredictedVessel: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      Measure([&]() { principia__clear_predicted_vessel(plugin); });
+      break;
+    }
+    case Journal::kHasPrediction: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      Measure([&]() {
+        principia__has_prediction(plugin, vessel_guid.c_str());
+      });
+      break;
+    }
+    case Journal::kSetPredictionLength: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      double const t = reader_.Read<double>();
+      Measure([&]() { principia__set_prediction_length(plugin, t); });
+      break;
+    }
+    case Journal::kSetPredictionStep: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      double const t = reader_.Read<double>();
+      Measure([&]() { principia__set_prediction_step(plugin, t); });
+      break;
+    }
+    case Journal::kSetAsynchronousPredictions: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      bool const asynchronous = reader_.Read<bool>();
+      Measure([&]() {
+        principia__set_asynchronous_predictions(plugin, asynchronous);
+      });
+      break;
+    }
+    case Journal::kPredictionStaleness: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      Measure([&]() { principia__prediction_staleness(plugin); });
+      break;
+    }
+    case Journal::kHasVessel: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      Measure([&]() { principia__has_vessel(plugin, vessel_guid.c_str()); });
+      break;
+    }
+    case Journal::kHasVesselByHandle: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const vessel_handle = reader_.Read<int>();
+      Measure([&]() {
+        principia__has_vessel_by_handle(plugin, vessel_handle);
+      });
+      break;
+    }
+    case Journal::kAddVesselToNextPhysicsBubble: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      std::vector<KSPPart> const parts = reader_.ReadArray<KSPPart>();
+      Measure([&]() {
+        principia__AddVesselToNextPhysicsBubble(
+            plugin,
+            vessel_guid.c_str(),
+            parts.data(),
+            static_cast<int>(parts.size()));
+      });
+      break;
+    }
+    case Journal::kPhysicsBubbleIsEmpty: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      Measure([&]() { principia__PhysicsBubbleIsEmpty(plugin); });
+      break;
+    }
+    case Journal::kBubbleDisplacementCorrection: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      XYZ const sun_position = reader_.Read<XYZ>();
+      Measure([&]() {
+        principia__BubbleDisplacementCorrection(plugin, sun_position);
+      });
+      break;
+    }
+    case Journal::kBubbleVelocityCorrection: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      int const reference_body_index = reader_.Read<int>();
+      Measure([&]() {
+        principia__BubbleVelocityCorrection(plugin, reference_body_index);
+      });
+      break;
+    }
+    case Journal::kNavballOrientation: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      RenderingTransforms* const transforms =
+          Find(reader_.ReadPointer(), transforms_);
+      XYZ const sun_world_position = reader_.Read<XYZ>();
+      XYZ const ship_world_position = reader_.Read<XYZ>();
+      Measure([&]() {
+        principia__NavballOrientation(plugin,
+                                      transforms,
+                                      sun_world_position,
+                                      ship_world_position);
+      });
+      break;
+    }
+    case Journal::kVesselTangent: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::string const vessel_guid = reader_.ReadString();
+      RenderingTransforms* const transforms =
+          Find(reader_.ReadPointer(), transforms_);
+      Measure([&]() {
+        principia__VesselTangent(plugin, vessel_guid.c_str(), transforms);
+      });
+      break;
+    }
+    case Journal::kCurrentTime: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      Measure([&]() { principia__current_time(plugin); });
+      break;
+    }
+    case Journal::kSerializePlugin: {
+      Plugin* const plugin = Find(reader_.ReadPointer(), plugins_);
+      std::uint64_t const recorded_serializer = reader_.ReadPointer();
+      PullSerializer* serializer = Find(recorded_serializer, serializers_);
+      char const* serialization = nullptr;
+      Measure([&]() {
+        serialization = principia__SerializePlugin(plugin, &serializer);
+      });
+      serializers_.erase(recorded_serializer);
+      Insert<PullSerializer>(reader_.ReadPointer(), serializer, &serializers_);
+      Insert<char const>(reader_.ReadPointer(),
+                         serialization,
+                         &serializations_);
+      break;
+    }
+    case Journal::kDeletePluginSerialization: {
+      std::uint64_t const recorded = reader_.ReadPointer();
+      char const* serialization = Find(recorded, serializations_);
+      Measure([&]() {
+        principia__DeletePluginSerialization(&serialization);
+      });
+      serializations_.erase(recorded);
+      break;
+    }
+    case Journal::kDeserializePlugin: {
+      std::string const serialization = reader_.ReadString();
+      std::uint64_t const recorded_deserializer = reader_.ReadPointer();
+      std::uint64_t const recorded_plugin = reader_.ReadPointer();
+      PushDeserializer* deserializer =
+          Find(recorded_deserializer, deserializers_);
+      if (deserializer == nullptr) {
+        // The first call of a sequence.
+        deserialized_plugin_ = Find(recorded_plugin, plugins_);
+      }
+      Measure([&]() {
+        principia__DeserializePlugin(serialization.c_str(),
+                                     static_cast<int>(serialization.size()),
+                                     &deserializer,
+                                     &deserialized_plugin_);
+      });
+      deserializers_.erase(recorded_deserializer);
+      std::uint64_t const recorded_deserializer_after = reader_.ReadPointer();
+      if (!serialization.empty()) {
+        Insert<PushDeserializer>(recorded_deserializer_after,
+                                 deserializer,
+                                 &deserializers_);
+      }
+      // The plugin is only known at the end of the sequence.
+      std::uint64_t const recorded_plugin_after = reader_.ReadPointer();
+      if (serialization.empty()) {
+        Insert<Plugin>(recorded_plugin_after,
+                       const_cast<Plugin*>(deserialized_plugin_),
+                       &plugins_);
+      }
+      break;
+    }
+    case Journal::kSayHello: {
+      Measure([]() { principia__SayHello(); });
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unexpected method " << reader_.method();
+  }
+}
+
+}  // namespace ksp_plugin
+}  // namespace principia
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/not_null.hpp"
+#include "base/pull_serializer.hpp"
+#include "base/push_deserializer.hpp"
+#include "ksp_plugin/interface.hpp"
+#include "ksp_plugin/journal.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using base::not_null;
+using base::PullSerializer;
+using base::PushDeserializer;
+using quantities::Time;
+
+namespace ksp_plugin {
+
+// Replays a journal written by |Journal| by calling the functions of the C
+// interface with the recorded arguments, and measures the wall time taken by
+// each call.  The objects created during the replay (plugins, transforms,
+// etc.) stand for the ones that had the recorded addresses.
+class JournalPlayer {
+ public:
+  explicit JournalPlayer(std::string const& path);
+  // Deletes the objects that the replayed calls created and didn't delete.
+  ~JournalPlayer();
+
+  // Replays the next call of the journal and returns true, or returns false if
+  // all the calls have been replayed.
+  bool Play();
+
+  // The number of calls replayed so far.
+  std::int64_t calls() const;
+
+  // The wall times taken by the calls to |method| replayed so far, in the
+  // order of the calls.
+  std::vector<Time> const& latencies(Journal::Method const method) const;
+
+  // If |directory| is not empty, the histories are spilled to |directory|
+  // instead of to the recorded directory, which may not exist on the machine
+  // that replays the journal.
+  void set_spill_directory(std::string const& directory);
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  template<typename T>
+  using Objects = std::map<std::uint64_t, T*>;
+
+  // Returns the object created during the replay for the |recorded| address,
+  // which must be null or known.
+  template<typename T>
+  static T* Find(std::uint64_t const recorded, Objects<T> const& objects);
+
+  // Records that the object at the |recorded| address was replayed by
+  // |replayed|.  Checks that the replay doesn't diverge, i.e., that |replayed|
+  // is null if and only if |recorded| is.  Does nothing if they are null.
+  template<typename T>
+  static void Insert(std::uint64_t const recorded,
+                     T* const replayed,
+                     not_null<Objects<T>*> const objects);
+
+  // Calls |call| and adds the time it took to the latencies of the current
+  // method.
+  template<typename Call>
+  void Measure(Call const& call);
+
+  void PlayEntry();
+
+  Journal::Reader reader_;
+  std::string spill_directory_;
+  std::int64_t calls_ = 0;
+  std::vector<std::vector<Time>> latencies_;
+
+  Objects<Plugin> plugins_;
+  Objects<RenderingTransforms> transforms_;
+  Objects<LineAndIterator> lines_and_iterators_;
+  Objects<PullSerializer> serializers_;
+  Objects<char const> serializations_;
+  Objects<PushDeserializer> deserializers_;
+
+  // The deserialization writes the plugin through the pointer passed to the
+  // first call of a sequence, so the pointer must outlive the sequence.
+  Plugin const* deserialized_plugin_ = nullptr;
+};
+
+}  // namespace ksp_plugin
+}  // namespace principia
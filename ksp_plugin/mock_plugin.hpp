@@ -35,46 +35,94 @@ class MockPlugin : public Plugin {
   MOCK_METHOD2(InsertOrKeepVessel,
                bool(GUID const& vessel_guid, Index const parent_index));
 
+  MOCK_METHOD1(InternVesselGUID, VesselHandle(GUID const& vessel_guid));
+
+  MOCK_METHOD2(InsertOrKeepVesselByHandle,
+               bool(VesselHandle const vessel_handle,
+                    Index const parent_index));
+
   MOCK_METHOD2(SetVesselStateOffset,
                void(GUID const& vessel_guid,
                     RelativeDegreesOfFreedom<AliceSun> const& from_parent));
 
+  MOCK_METHOD2(SetVesselStateOffsetByHandle,
+               void(VesselHandle const vessel_handle,
+                    RelativeDegreesOfFreedom<AliceSun> const& from_parent));
+
   MOCK_METHOD2(AdvanceTime,
                void(Instant const& t, Angle const& planetarium_rotation));
 
   MOCK_CONST_METHOD1(ForgetAllHistoriesBefore, void(Instant const& t));
 
+  MOCK_CONST_METHOD2(SpillAllHistoriesBefore,
+                     void(Instant const& t, std::string const& directory));
+  MOCK_METHOD2(EnableHistorySpilling,
+               void(std::string const& directory,
+                    Time const& resident_history_length));
+
   MOCK_CONST_METHOD1(VesselFromParent,
                      RelativeDegreesOfFreedom<AliceSun>(
                          GUID const& vessel_guid));
 
+  MOCK_CONST_METHOD1(VesselFromParentByHandle,
+                     RelativeDegreesOfFreedom<AliceSun>(
+                         VesselHandle const vessel_handle));
+
   MOCK_CONST_METHOD1(CelestialFromParent,
                      RelativeDegreesOfFreedom<AliceSun>(
                          Index const celestial_index));
 
-  MOCK_CONST_METHOD3(
+  MOCK_CONST_METHOD5(
       RenderedVesselTrajectory,
       RenderedTrajectory<World>(
           GUID const& vessel_guid,
           not_null<RenderingTransforms*> const transforms,
-          Position<World> const& sun_world_position));
+          Position<World> const& sun_world_position,
+          Length const& tolerance,
+          double const level_of_detail));
 
-  MOCK_METHOD2(
+  MOCK_METHOD5(
       RenderedPrediction,
       RenderedTrajectory<World>(
+          GUID const& vessel_guid,
           not_null<RenderingTransforms*> const transforms,
-          Position<World> const& sun_world_position));
+          Position<World> const& sun_world_position,
+          Length const& tolerance,
+          double const level_of_detail));
 
   MOCK_METHOD1(set_predicted_vessel, void(GUID const& vessel_guid));
 
+  MOCK_METHOD1(add_predicted_vessel, void(GUID const& vessel_guid));
+
+  MOCK_METHOD1(remove_predicted_vessel, void(GUID const& vessel_guid));
+
   MOCK_METHOD0(clear_predicted_vessel, void());
 
+  MOCK_CONST_METHOD1(has_prediction, bool(GUID const& vessel_guid));
+
   MOCK_METHOD1(set_prediction_length, void(Time const& t));
 
   MOCK_METHOD1(set_prediction_step, void(Time const& t));
 
+  MOCK_METHOD1(set_asynchronous_predictions, void(bool const asynchronous));
+
+  MOCK_CONST_METHOD0(prediction_staleness, Time());
+
+  MOCK_METHOD1(set_speculative_histories, void(bool const speculative));
+
+  MOCK_METHOD1(set_dense_prolongations, void(bool const dense));
+
+  MOCK_METHOD1(set_fast_time_warp, void(bool const fast));
+
+  MOCK_METHOD1(set_incremental_forgetting, void(bool const incremental));
+
+  MOCK_CONST_METHOD0(advance_time_profiler, AdvanceTimeProfiler const&());
+
   MOCK_CONST_METHOD1(has_vessel, bool(GUID const& vessel_guid));
 
+  MOCK_CONST_METHOD1(has_vessel_by_handle,
+                     bool(VesselHandle const vessel_handle));
+
   // NOTE(phl): gMock 1.7.0 doesn't support returning a std::unique_ptr<>.  So
   // we override the function of the Plugin class with bona fide functions which
   // call mock functions which fill a std::unique_ptr<> instead of returning it.
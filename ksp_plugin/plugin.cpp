@@ -1,6 +1,7 @@
 ﻿#include "ksp_plugin/plugin.hpp"
 
 #include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cmath>
 #include <map>
 #include <string>
@@ -29,11 +30,21 @@ using geometry::AngularVelocity;
 using geometry::BarycentreCalculator;
 using geometry::Bivector;
 using geometry::Identity;
+using geometry::InnerProduct;
 using geometry::Normalize;
 using geometry::Permutation;
 using geometry::Sign;
+using integrators::BlanesMoan2002SRKN14A;
 using integrators::McLachlanAtela1992Order5Optimal;
+using quantities::Abs;
+using quantities::Area;
 using quantities::Force;
+using quantities::Length;
+using quantities::Pow;
+using quantities::Speed;
+using quantities::Sqrt;
+using si::Centi;
+using si::Metre;
 using si::Radian;
 
 namespace {
@@ -46,6 +57,99 @@ Permutation<World, AliceWorld> const kWorldLookingGlass(
 Permutation<WorldSun, AliceSun> const kSunLookingGlass(
     Permutation<WorldSun, AliceSun>::CoordinatePermutation::XZY);
 
+// The maximum number of forgotten history points whose memory is reclaimed
+// by a call to |AdvanceTime|.  This bounds the time spent in a frame after a
+// long history has been forgotten.
+std::int64_t const kMaxReclaimedPointsPerAdvance = 10000;
+
+// The largest differences between the predictions, interpolated at
+// |current_time_|, and the ends of the prolongations for which the predictions
+// are extended rather than recomputed.
+Length const kPredictionPositionTolerance = 1 * Metre;
+Speed const kPredictionVelocityTolerance = 1 * Centi(Metre) / Second;
+
+// The minimum number of steps of size |Δt_| by which the speculative histories
+// are integrated ahead of the current time.
+int const kSpeculativeHistorySteps = 16;
+
+// The number of calls to |AdvanceTime| measured by the profiler, about four
+// seconds at 60 frames per second.
+int const kProfiledAdvanceTimeFrames = 256;
+
+// Bounds on the ratio of the time warp step to |Δt_|.  Below the minimum, the
+// more expensive steps of the time warp integrator don't pay off.
+int const kMinTimeWarpStepMultiple = 4;
+int const kMaxTimeWarpStepMultiple = 1024;
+
+// The minimum number of time warp steps per dynamical time |Sqrt(r³ / μ)| of a
+// body at distance r from a celestial of gravitational parameter μ, and per
+// time |r / v| that it would take to reach the celestial at its relative speed
+// v.  For a circular orbit these times are equal, and this is about 400 steps
+// per period.  On a fast hyperbolic approach the second one is shorter.
+double const kTimeWarpStepsPerDynamicalTime = 64;
+
+// The number of time warp steps after which the step is selected again, so
+// that it falls back to |Δt_| when the bodies approach the celestials.  As the
+// step is bounded by |r / v| / |kTimeWarpStepsPerDynamicalTime|, a body covers
+// at most a quarter of its distance to a celestial between two selections.
+// Only the last point of each selection is appended to the histories.
+int const kTimeWarpStepsPerSelection = 16;
+
+// Appends to |result| the segments of a polygon joining some of the |points|,
+// including the first and the last, such that no point is farther than
+// |tolerance| from the polygon.  This is the Douglas-Peucker algorithm, made
+// iterative because the trajectories may have many points.
+void AppendSimplifiedSegments(
+    std::vector<Position<World>> const& points,
+    Length const& tolerance,
+    not_null<RenderedTrajectory<World>*> const result) {
+  if (points.size() < 2) {
+    return;
+  }
+  std::vector<bool> kept(points.size(), false);
+  kept.front() = true;
+  kept.back() = true;
+  // The ranges of points that remain to be simplified.  The points at the ends
+  // of each range are kept.
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  ranges.emplace_back(0, points.size() - 1);
+  while (!ranges.empty()) {
+    std::size_t const first = ranges.back().first;
+    std::size_t const last = ranges.back().second;
+    ranges.pop_back();
+    Displacement<World> const chord = points[last] - points[first];
+    Area const chord_squared = InnerProduct(chord, chord);
+    Length max_distance;
+    std::size_t farthest = first;
+    for (std::size_t i = first + 1; i < last; ++i) {
+      Displacement<World> const from_first = points[i] - points[first];
+      double s = 0;
+      if (chord_squared != Area()) {
+        s = std::min(std::max(InnerProduct(from_first, chord) / chord_squared,
+                              0.0),
+                     1.0);
+      }
+      Length const distance = (from_first - s * chord).Norm();
+      if (distance > max_distance) {
+        max_distance = distance;
+        farthest = i;
+      }
+    }
+    if (max_distance > tolerance) {
+      kept[farthest] = true;
+      ranges.emplace_back(first, farthest);
+      ranges.emplace_back(farthest, last);
+    }
+  }
+  std::size_t previous = 0;
+  for (std::size_t i = 1; i < points.size(); ++i) {
+    if (kept[i]) {
+      result->emplace_back(points[previous], points[i]);
+      previous = i;
+    }
+  }
+}
+
 }  // namespace
 
 Plugin::Plugin(Instant const& initial_time,
@@ -56,6 +160,8 @@ Plugin::Plugin(Instant const& initial_time,
       n_body_system_(make_not_null_unique<NBodySystem<Barycentric>>()),
       history_integrator_(&McLachlanAtela1992Order5Optimal()),
       prolongation_integrator_(&McLachlanAtela1992Order5Optimal()),
+      time_warp_integrator_(&BlanesMoan2002SRKN14A()),
+      advance_time_profiler_(kProfiledAdvanceTimeFrames),
       planetarium_rotation_(planetarium_rotation),
       current_time_(initial_time),
       sun_(celestials_.emplace(sun_index,
@@ -110,31 +216,77 @@ void Plugin::UpdateCelestialHierarchy(Index const celestial_index,
 
 bool Plugin::InsertOrKeepVessel(GUID const& vessel_guid,
                                 Index const parent_index) {
+  CHECK(!initializing_);
+  return InsertOrKeepVesselByHandle(InternVesselGUID(vessel_guid),
+                                    parent_index);
+}
+
+VesselHandle Plugin::InternVesselGUID(GUID const& vessel_guid) {
+  auto const it = vessel_handles_.find(vessel_guid);
+  if (it != vessel_handles_.end()) {
+    return it->second;
+  }
+  VesselHandle const vessel_handle =
+      static_cast<VesselHandle>(interned_vessels_.size());
+  auto const inserted = vessel_handles_.emplace(vessel_guid, vessel_handle);
+  CHECK(inserted.second);
+  // The vessel may have been inserted by |ReadFromMessage|.
+  auto const it_vessel = vessels_.find(vessel_guid);
+  Vessel* vessel = nullptr;
+  if (it_vessel != vessels_.end()) {
+    vessel = it_vessel->second.get();
+  }
+  interned_vessels_.push_back({&inserted.first->first, vessel});
+  VLOG(1) << "Interned GUID " << vessel_guid << " as " << vessel_handle;
+  return vessel_handle;
+}
+
+bool Plugin::InsertOrKeepVesselByHandle(VesselHandle const vessel_handle,
+                                        Index const parent_index) {
   VLOG(1) << __FUNCTION__ << '\n'
-          << NAMED(vessel_guid) << '\n' << NAMED(parent_index);
+          << NAMED(vessel_handle) << '\n' << NAMED(parent_index);
   CHECK(!initializing_);
+  CHECK_LE(0, vessel_handle);
+  CHECK_LT(vessel_handle, interned_vessels_.size());
+  InternedVessel& interned_vessel = interned_vessels_[vessel_handle];
+  GUID const& vessel_guid = *interned_vessel.guid;
   not_null<Celestial const*> parent =
       FindOrDie(celestials_, parent_index).get();
-  auto inserted = vessels_.emplace(vessel_guid,
-                                   make_not_null_unique<Vessel>(parent));
-  not_null<Vessel*> const vessel = inserted.first->second.get();
+  bool const inserted = interned_vessel.vessel == nullptr;
+  if (inserted) {
+    auto const emplaced = vessels_.emplace(
+        vessel_guid,
+        make_not_null_unique<Vessel>(parent));
+    CHECK(emplaced.second);
+    interned_vessel.vessel = emplaced.first->second.get();
+  }
+  not_null<Vessel*> const vessel = interned_vessel.vessel;
   kept_vessels_.emplace(vessel);
   vessel->set_parent(parent);
-  LOG_IF(INFO, inserted.second) << "Inserted vessel with GUID " << vessel_guid
-                                << " at " << vessel;
+  LOG_IF(INFO, inserted) << "Inserted vessel with GUID " << vessel_guid
+                         << " at " << vessel;
   VLOG(1) << "Parent of vessel with GUID " << vessel_guid <<" is at index "
           << parent_index;
-  return inserted.second;
+  return inserted;
 }
 
 void Plugin::SetVesselStateOffset(
     GUID const& vessel_guid,
     RelativeDegreesOfFreedom<AliceSun> const& from_parent) {
+  CHECK(!initializing_);
+  // Don't intern the GUIDs of nonexistent vessels.
+  find_vessel_by_guid_or_die(vessel_guid);
+  SetVesselStateOffsetByHandle(InternVesselGUID(vessel_guid), from_parent);
+}
+
+void Plugin::SetVesselStateOffsetByHandle(
+    VesselHandle const vessel_handle,
+    RelativeDegreesOfFreedom<AliceSun> const& from_parent) {
   VLOG(1) << __FUNCTION__ << '\n'
-          << NAMED(vessel_guid) << '\n' << NAMED(from_parent);
+          << NAMED(vessel_handle) << '\n' << NAMED(from_parent);
   CHECK(!initializing_);
-  not_null<std::unique_ptr<Vessel>> const& vessel =
-      find_vessel_by_guid_or_die(vessel_guid);
+  not_null<Vessel*> const vessel = find_vessel_by_handle_or_die(vessel_handle);
+  GUID const& vessel_guid = *interned_vessels_[vessel_handle].guid;
   CHECK(!vessel->is_initialized())
       << "Vessel with GUID " << vessel_guid << " already has a trajectory";
   LOG(INFO) << "Initial |{orbit.pos, orbit.vel}| for vessel with GUID "
@@ -145,7 +297,7 @@ void Plugin::SetVesselStateOffset(
   vessel->CreateProlongation(
       current_time_,
       vessel->parent()->prolongation().last().degrees_of_freedom() + relative);
-  auto const inserted = unsynchronized_vessels_.emplace(vessel.get());
+  auto const inserted = unsynchronized_vessels_.emplace(vessel);
   CHECK(inserted.second);
 }
 
@@ -154,54 +306,134 @@ void Plugin::AdvanceTime(Instant const& t, Angle const& planetarium_rotation) {
           << NAMED(t) << '\n' << NAMED(planetarium_rotation);
   CHECK(!initializing_);
   CHECK_GT(t, current_time_);
+  Time const advance = t - current_time_;
+  AdvanceTimeProfiler& profiler = advance_time_profiler_;
+  profiler.StartFrame();
+  profiler.StartPhase(AdvanceTimeProfiler::kCleanUpVessels);
   CleanUpVessels();
+  profiler.StartPhase(AdvanceTimeProfiler::kPrepareBubble);
   bubble_->Prepare(BarycentricToWorldSun(), current_time_, t);
   if (HistoryTime() + Δt_ < t) {
     // The histories are far enough behind that we can advance them at least one
     // step and reset the prolongations.
+    profiler.StartPhase(AdvanceTimeProfiler::kEvolveHistories);
     EvolveHistories(t);
     // TODO(egg): I think |!bubble_->empty()| => |has_dirty_vessels()|.
     if (has_unsynchronized_vessels() ||
         has_dirty_vessels() ||
         !bubble_->empty()) {
+      profiler.StartPhase(
+          AdvanceTimeProfiler::kSynchronizeNewVesselsAndCleanDirtyVessels);
       SynchronizeNewVesselsAndCleanDirtyVessels();
     }
+    profiler.StartPhase(AdvanceTimeProfiler::kResetProlongations);
     ResetProlongations();
   }
+  profiler.StartPhase(AdvanceTimeProfiler::kEvolveProlongationsAndBubble);
   EvolveProlongationsAndBubble(t);
   VLOG(1) << "Time has been advanced" << '\n'
           << "from : " << current_time_ << '\n'
           << "to   : " << t;
   current_time_ = t;
   planetarium_rotation_ = planetarium_rotation;
+  profiler.StartPhase(AdvanceTimeProfiler::kUpdatePredictions);
   UpdatePredictions();
+  profiler.StartPhase(AdvanceTimeProfiler::kSpeculateHistories);
+  SpeculateHistories(advance);
+  profiler.StartPhase(AdvanceTimeProfiler::kReclaimForgottenHistoryPoints);
+  ReclaimForgottenHistoryPoints();
+  profiler.StartPhase(AdvanceTimeProfiler::kSpillOldHistoryPoints);
+  SpillOldHistoryPoints();
+  profiler.EndFrame();
 }
 
 void Plugin::ForgetAllHistoriesBefore(Instant const& t) const {
   CHECK_LT(t, HistoryTime());
+  auto const forget_before = [this, &t](
+      not_null<Trajectory<Barycentric>*> const history) {
+    if (incremental_forgetting_) {
+      history->DetachBefore(t);
+    } else {
+      history->ForgetBefore(t);
+    }
+  };
   for (auto const& pair : celestials_) {
     not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
-    celestial->mutable_history()->ForgetBefore(t);
+    forget_before(celestial->mutable_history());
   }
   for (auto const& pair : vessels_) {
     not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
     // Only forget the synchronized vessels, the others don't have an history.
     if (unsynchronized_vessels_.count(vessel.get()) == 0) {
-      vessel->mutable_history()->ForgetBefore(t);
+      forget_before(vessel->mutable_history());
     }
   }
 }
 
+void Plugin::SpillAllHistoriesBefore(Instant const& t,
+                                     std::string const& directory) const {
+  for (auto const& pair : celestials_) {
+    Index const index = pair.first;
+    not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+    not_null<Trajectory<Barycentric>*> const history =
+        celestial->mutable_history();
+    if (!history->is_spilling_enabled()) {
+      history->EnableSpilling(directory + "/celestial_" +
+                              std::to_string(index) + "_" +
+                              std::to_string(history->generation()) +
+                              ".spill");
+    }
+    history->SpillBefore(t);
+  }
+  for (auto const& pair : vessels_) {
+    GUID const& guid = pair.first;
+    not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
+    // Only spill the synchronized vessels, the others don't have an history.
+    if (unsynchronized_vessels_.count(vessel.get()) == 0) {
+      not_null<Trajectory<Barycentric>*> const history =
+          vessel->mutable_history();
+      // The generation distinguishes the files of vessels that were removed
+      // and inserted again with the same GUID.
+      if (!history->is_spilling_enabled()) {
+        history->EnableSpilling(directory + "/vessel_" + guid + "_" +
+                                std::to_string(history->generation()) +
+                                ".spill");
+      }
+      history->SpillBefore(t);
+    }
+  }
+}
+
+void Plugin::EnableHistorySpilling(std::string const& directory,
+                                   Time const& resident_history_length) {
+  CHECK(!directory.empty());
+  CHECK_LT(Time(), resident_history_length);
+  history_spill_directory_ = directory;
+  resident_history_length_ = resident_history_length;
+}
+
 RelativeDegreesOfFreedom<AliceSun> Plugin::VesselFromParent(
     GUID const& vessel_guid) const {
   CHECK(!initializing_);
-  not_null<std::unique_ptr<Vessel>> const& vessel =
-      find_vessel_by_guid_or_die(vessel_guid);
-  CHECK(vessel->is_initialized()) << "Vessel with GUID " << vessel_guid
-                                  << " was not given an initial state";
+  return VesselFromParent(vessel_guid,
+                          *find_vessel_by_guid_or_die(vessel_guid));
+}
+
+RelativeDegreesOfFreedom<AliceSun> Plugin::VesselFromParentByHandle(
+    VesselHandle const vessel_handle) const {
+  CHECK(!initializing_);
+  not_null<Vessel*> const vessel = find_vessel_by_handle_or_die(vessel_handle);
+  return VesselFromParent(*interned_vessels_[vessel_handle].guid, *vessel);
+}
+
+RelativeDegreesOfFreedom<AliceSun> Plugin::VesselFromParent(
+    GUID const& vessel_guid,
+    Vessel const& vessel) const {
+  CHECK(vessel.is_initialized()) << "Vessel with GUID " << vessel_guid
+                                 << " was not given an initial state";
   RelativeDegreesOfFreedom<Barycentric> const barycentric_result =
-      vessel->prolongation().last().degrees_of_freedom() -
-      vessel->parent()->prolongation().last().degrees_of_freedom();
+      vessel.prolongation().last().degrees_of_freedom() -
+      vessel.parent()->prolongation().last().degrees_of_freedom();
   RelativeDegreesOfFreedom<AliceSun> const result =
       PlanetariumRotation()(barycentric_result);
   VLOG(1) << "Vessel with GUID " << vessel_guid
@@ -230,7 +462,9 @@ RelativeDegreesOfFreedom<AliceSun> Plugin::CelestialFromParent(
 RenderedTrajectory<World> Plugin::RenderedVesselTrajectory(
     GUID const& vessel_guid,
     not_null<RenderingTransforms*> const transforms,
-    Position<World> const& sun_world_position) const {
+    Position<World> const& sun_world_position,
+    Length const& tolerance,
+    double const level_of_detail) const {
   CHECK(!initializing_);
   not_null<std::unique_ptr<Vessel>> const& vessel =
       find_vessel_by_guid_or_die(vessel_guid);
@@ -244,53 +478,153 @@ RenderedTrajectory<World> Plugin::RenderedVesselTrajectory(
   }
 
   // Compute the apparent trajectory using the given |transforms|.
-  return RenderTrajectory(vessel->body(),
-                          transforms->first(*vessel,
-                                            &MobileInterface::history),
+  return RenderTrajectory(*vessel,
+                          &MobileInterface::history,
+                          vessel->history().first().time(),
+                          vessel->history().last().time(),
                           transforms,
-                          sun_world_position);
+                          sun_world_position,
+                          tolerance,
+                          level_of_detail);
 }
 
 RenderedTrajectory<World> Plugin::RenderedPrediction(
+    GUID const& vessel_guid,
     not_null<RenderingTransforms*> const transforms,
-    Position<World> const& sun_world_position) {
+    Position<World> const& sun_world_position,
+    Length const& tolerance,
+    double const level_of_detail) {
   CHECK(!initializing_);
-  if (!HasPredictions()) {
+  if (!has_prediction(vessel_guid)) {
     return RenderedTrajectory<World>();
   }
+  not_null<std::unique_ptr<Vessel>> const& vessel =
+      find_vessel_by_guid_or_die(vessel_guid);
+  Trajectory<Barycentric> const& prediction = vessel->prediction();
+  // The prediction is not forked from the prolongation, it starts at or
+  // before |current_time_|.  It is rendered from its start so that it is
+  // joined to the vessel.
   RenderedTrajectory<World> result =
-      RenderTrajectory(predicted_vessel_->body(),
-                       transforms->first_on_or_after(
-                           *predicted_vessel_,
-                           &MobileInterface::prediction,
-                           *predicted_vessel_->prediction().fork_time()),
+      RenderTrajectory(*vessel,
+                       &MobileInterface::prediction,
+                       prediction.first().time(),
+                       prediction.last().time(),
                        transforms,
-                       sun_world_position);
+                       sun_world_position,
+                       tolerance,
+                       level_of_detail);
   return result;
 }
 
 void Plugin::set_predicted_vessel(GUID const& vessel_guid) {
-  clear_predicted_vessel();
-  predicted_vessel_ = find_vessel_by_guid_or_die(vessel_guid).get();
+  not_null<Vessel*> const vessel =
+      find_vessel_by_guid_or_die(vessel_guid).get();
+  if (predicted_vessels_.size() != 1 ||
+      predicted_vessels_.count(vessel) == 0) {
+    clear_predicted_vessel();
+    predicted_vessels_.insert(vessel);
+  }
+}
+
+void Plugin::add_predicted_vessel(GUID const& vessel_guid) {
+  not_null<Vessel*> const vessel =
+      find_vessel_by_guid_or_die(vessel_guid).get();
+  if (predicted_vessels_.count(vessel) == 0) {
+    InvalidatePredictions();
+    predicted_vessels_.insert(vessel);
+  }
+}
+
+void Plugin::remove_predicted_vessel(GUID const& vessel_guid) {
+  not_null<Vessel*> const vessel =
+      find_vessel_by_guid_or_die(vessel_guid).get();
+  if (predicted_vessels_.count(vessel) > 0) {
+    RemovePredictedVessel(vessel);
+  }
 }
 
 void Plugin::clear_predicted_vessel() {
-  DeletePredictions();
-  predicted_vessel_ = nullptr;
+  InvalidatePredictions();
+  predicted_vessels_.clear();
+}
+
+bool Plugin::has_prediction(GUID const& vessel_guid) const {
+  auto const it = vessels_.find(vessel_guid);
+  return it != vessels_.end() &&
+         predicted_vessels_.count(it->second.get()) > 0 &&
+         HasPredictions();
 }
 
 void Plugin::set_prediction_length(Time const& t) {
-  prediction_length_ = t;
+  if (t != prediction_length_) {
+    InvalidatePredictions();
+    prediction_length_ = t;
+  }
 }
 
 void Plugin::set_prediction_step(Time const& t) {
-  prediction_step_ = t;
+  if (t != prediction_step_) {
+    InvalidatePredictions();
+    prediction_step_ = t;
+  }
+}
+
+void Plugin::set_asynchronous_predictions(bool const asynchronous) {
+  if (asynchronous != asynchronous_predictions_) {
+    InvalidatePredictions();
+    asynchronous_predictions_ = asynchronous;
+  }
+}
+
+Time Plugin::prediction_staleness() const {
+  if (HasPredictions()) {
+    return current_time_ - prediction_time_;
+  } else {
+    return Time();
+  }
+}
+
+void Plugin::set_speculative_histories(bool const speculative) {
+  speculative_histories_enabled_ = speculative;
+}
+
+std::int64_t Plugin::committed_speculative_steps() const {
+  return committed_speculative_steps_;
+}
+
+void Plugin::set_dense_prolongations(bool const dense) {
+  dense_prolongations_ = dense;
+  if (!dense_prolongations_) {
+    dense_step_.reset();
+  }
+}
+
+void Plugin::set_fast_time_warp(bool const fast) {
+  fast_time_warp_ = fast;
+}
+
+void Plugin::set_incremental_forgetting(bool const incremental) {
+  incremental_forgetting_ = incremental;
+}
+
+std::int64_t Plugin::time_warp_steps() const {
+  return time_warp_steps_;
+}
+
+AdvanceTimeProfiler const& Plugin::advance_time_profiler() const {
+  return advance_time_profiler_;
 }
 
 bool Plugin::has_vessel(GUID const& vessel_guid) const {
   return vessels_.find(vessel_guid) != vessels_.end();
 }
 
+bool Plugin::has_vessel_by_handle(VesselHandle const vessel_handle) const {
+  CHECK_LE(0, vessel_handle);
+  CHECK_LT(vessel_handle, interned_vessels_.size());
+  return interned_vessels_[vessel_handle].vessel != nullptr;
+}
+
 not_null<std::unique_ptr<RenderingTransforms>>
 Plugin::NewBodyCentredNonRotatingTransforms(
     Index const reference_body_index) const {
@@ -327,6 +661,12 @@ void Plugin::AddVesselToNextPhysicsBubble(
   not_null<std::unique_ptr<Vessel>> const& vessel =
       find_vessel_by_guid_or_die(vessel_guid);
   dirty_vessels_.insert(vessel.get());
+  if (speculative_histories_ != nullptr &&
+      std::find(speculative_histories_->vessels.begin(),
+                speculative_histories_->vessels.end(),
+                vessel.get()) != speculative_histories_->vessels.end()) {
+    speculative_histories_->obsolete = true;
+  }
   bubble_->AddVesselToNext(vessel.get(), std::move(parts));
 }
 
@@ -511,6 +851,8 @@ Plugin::Plugin(GUIDToOwnedVessel vessels,
       n_body_system_(make_not_null_unique<NBodySystem<Barycentric>>()),
       history_integrator_(&McLachlanAtela1992Order5Optimal()),
       prolongation_integrator_(&McLachlanAtela1992Order5Optimal()),
+      time_warp_integrator_(&BlanesMoan2002SRKN14A()),
+      advance_time_profiler_(kProfiledAdvanceTimeFrames),
       planetarium_rotation_(planetarium_rotation),
       current_time_(current_time),
       sun_(FindOrDie(celestials_, sun_index).get()) {
@@ -530,6 +872,16 @@ not_null<std::unique_ptr<Vessel>> const& Plugin::find_vessel_by_guid_or_die(
   VLOG_AND_RETURN(1, FindOrDie(vessels_, vessel_guid));
 }
 
+not_null<Vessel*> Plugin::find_vessel_by_handle_or_die(
+    VesselHandle const vessel_handle) const {
+  CHECK_LE(0, vessel_handle);
+  CHECK_LT(vessel_handle, interned_vessels_.size());
+  InternedVessel const& interned_vessel = interned_vessels_[vessel_handle];
+  CHECK(interned_vessel.vessel != nullptr)
+      << "No vessel with GUID " << *interned_vessel.guid;
+  return interned_vessel.vessel;
+}
+
 bool Plugin::has_dirty_vessels() const {
   return !dirty_vessels_.empty();
 }
@@ -543,12 +895,16 @@ bool Plugin::is_dirty(not_null<Vessel*> const vessel) const {
 }
 
 bool Plugin::has_predicted_vessel() const {
-  return predicted_vessel_ != nullptr;
+  return !predicted_vessels_.empty();
 }
 
 bool Plugin::HasPredictions() const {
   if (has_predicted_vessel()) {
-    bool const has_prediction = predicted_vessel_->has_prediction();
+    bool const has_prediction =
+        (*predicted_vessels_.begin())->has_prediction();
+    for (not_null<Vessel*> const vessel : predicted_vessels_) {
+      CHECK_EQ(vessel->has_prediction(), has_prediction);
+    }
     for (auto const& pair : celestials_) {
       not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
       CHECK_EQ(celestial->has_prediction(), has_prediction);
@@ -559,14 +915,155 @@ bool Plugin::HasPredictions() const {
   }
 }
 
+void Plugin::RemovePredictedVessel(not_null<Vessel*> const vessel) {
+  if (predicted_vessels_.size() == 1) {
+    // The predictions of the celestials are only kept for those of the
+    // vessels.
+    InvalidatePredictions();
+  } else {
+    if (HasPredictions()) {
+      vessel->DeletePrediction();
+    }
+    // The order of the predictions changes.
+    if (pending_prediction_ != nullptr) {
+      pending_prediction_->obsolete = true;
+    }
+    // The trajectories of the other vessels remain their predictions, but they
+    // may not be extended.
+    if (completed_prediction_ != nullptr) {
+      completed_prediction_->obsolete = true;
+    }
+  }
+  CHECK_EQ(1, predicted_vessels_.erase(vessel));
+}
+
 void Plugin::DeletePredictions() {
   if (HasPredictions()) {
-    predicted_vessel_->DeletePrediction();
+    for (not_null<Vessel*> const vessel : predicted_vessels_) {
+      vessel->DeletePrediction();
+    }
     for (auto const& pair : celestials_) {
       not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
       celestial->DeletePrediction();
     }
   }
+  completed_prediction_.reset();
+}
+
+void Plugin::InvalidatePredictions() {
+  DeletePredictions();
+  if (pending_prediction_ != nullptr) {
+    pending_prediction_->obsolete = true;
+  }
+}
+
+std::unique_ptr<Plugin::AsynchronousPrediction> Plugin::NewPrediction(
+    bool const extension) const {
+  auto prediction = std::make_unique<AsynchronousPrediction>();
+  prediction->snapshot_time = current_time_;
+  prediction->extension = extension;
+  prediction->trajectories.reserve(celestials_.size() +
+                                   predicted_vessels_.size());
+  auto const snapshot = [this, extension, &prediction](
+      not_null<Body const*> const body,
+      Trajectory<Barycentric> const& prolongation) {
+    Trajectory<Barycentric> const& start =
+        extension ? *completed_prediction_->trajectories[
+                        prediction->trajectories.size()]
+                  : prolongation;
+    prediction->trajectories.push_back(
+        make_not_null_unique<Trajectory<Barycentric>>(body));
+    prediction->trajectories.back()->Append(
+        start.last().time(),
+        start.last().degrees_of_freedom());
+  };
+  for (auto const& pair : celestials_) {
+    not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+    snapshot(&celestial->body(), celestial->prolongation());
+  }
+  for (not_null<Vessel*> const vessel : predicted_vessels_) {
+    prediction->vessel_bodies.emplace_back();
+    snapshot(&prediction->vessel_bodies.back(), vessel->prolongation());
+  }
+  return prediction;
+}
+
+void Plugin::SetCompletedPrediction(
+    std::unique_ptr<AsynchronousPrediction> prediction) {
+  DeletePredictions();
+  completed_prediction_ = std::move(prediction);
+  auto it = completed_prediction_->trajectories.cbegin();
+  for (auto const& pair : celestials_) {
+    not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+    celestial->set_prediction(it->get());
+    ++it;
+  }
+  for (not_null<Vessel*> const vessel : predicted_vessels_) {
+    vessel->set_prediction(it->get());
+    ++it;
+  }
+  prediction_time_ = completed_prediction_->snapshot_time;
+}
+
+bool Plugin::CompletedPredictionIsReusable() {
+  // Outside of the bubble the vessels have no intrinsic acceleration, so their
+  // prolongations follow the same dynamics as their predictions.
+  if (completed_prediction_ == nullptr ||
+      completed_prediction_->obsolete ||
+      completed_prediction_->trajectories.front()->last().time() <=
+          current_time_) {
+    return false;
+  }
+  for (not_null<Vessel*> const vessel : predicted_vessels_) {
+    if (bubble_->contains(vessel)) {
+      return false;
+    }
+  }
+  // The points before |current_time_| are not rendered; forgetting them
+  // bounds the length of the completed prediction as it is extended.  The
+  // first point left is at or before |current_time_|.
+  for (auto const& trajectory : completed_prediction_->trajectories) {
+    trajectory->ForgetBefore(current_time_ - prediction_step_);
+  }
+  // The prolongations and the predictions are integrated with different steps
+  // from different states, so they only agree up to the integration and
+  // interpolation errors.  If they drifted apart, the predictions no longer
+  // start from the state of the vessels.
+  auto it = completed_prediction_->trajectories.cbegin();
+  auto const matches = [this, &it](
+      Trajectory<Barycentric> const& prolongation) {
+    Trajectory<Barycentric> const& prediction = **it;
+    ++it;
+    auto const before = prediction.first();
+    auto after = before;
+    ++after;
+    CHECK_LE(before.time(), current_time_);
+    CHECK(!after.at_end());
+    Hermite3<Instant, Position<Barycentric>> const interpolation(
+        {before.time(), after.time()},
+        {before.degrees_of_freedom().position(),
+         after.degrees_of_freedom().position()},
+        {before.degrees_of_freedom().velocity(),
+         after.degrees_of_freedom().velocity()});
+    DegreesOfFreedom<Barycentric> const& end =
+        prolongation.last().degrees_of_freedom();
+    return (interpolation.Evaluate(current_time_) - end.position()).Norm() <=
+               kPredictionPositionTolerance &&
+           (interpolation.EvaluateDerivative(current_time_) -
+                end.velocity()).Norm() <= kPredictionVelocityTolerance;
+  };
+  for (auto const& pair : celestials_) {
+    not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+    if (!matches(celestial->prolongation())) {
+      return false;
+    }
+  }
+  for (not_null<Vessel*> const vessel : predicted_vessels_) {
+    if (!matches(vessel->prolongation())) {
+      return false;
+    }
+  }
+  return true;
 }
 
 Instant const& Plugin::HistoryTime() const {
@@ -605,6 +1102,17 @@ void Plugin::CleanUpVessels() {
       if (dirty_vessels_.erase(vessel)) {
         LOG(INFO) << "Vessel was dirty";
       }
+      if (predicted_vessels_.count(vessel) > 0) {
+        LOG(INFO) << "Vessel was predicted";
+        RemovePredictedVessel(vessel);
+      }
+      if (speculative_histories_ != nullptr) {
+        speculative_histories_->obsolete = true;
+      }
+      auto const handle = vessel_handles_.find(it->first);
+      if (handle != vessel_handles_.end()) {
+        interned_vessels_[handle->second].vessel = nullptr;
+      }
       // |std::map::erase| invalidates its parameter so we post-increment.
       vessels_.erase(it++);
     }
@@ -633,35 +1141,232 @@ void Plugin::EvolveHistories(Instant const& t) {
   VLOG(1) << __FUNCTION__ << '\n' << NAMED(t);
   // Integration with a constant step.
   NBodySystem<Barycentric>::Trajectories trajectories;
-  // NOTE(egg): This may be too large, vessels that are not new and in the
-  // physics bubble or dirty will not be added.
-  trajectories.reserve(vessels_.size() - unsynchronized_vessels_.size() +
-                       celestials_.size());
+  std::vector<not_null<Vessel*>> const vessels = HistoryVessels();
+  trajectories.reserve(celestials_.size() + vessels.size());
   for (auto const& pair : celestials_) {
     not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
     trajectories.push_back(celestial->mutable_history());
   }
-  for (auto const& pair : vessels_) {
-    not_null<Vessel*> const vessel = pair.second.get();
-    if (vessel->is_synchronized() &&
-        !bubble_->contains(vessel) &&
-        !is_dirty(vessel)) {
-      trajectories.push_back(vessel->mutable_history());
-    }
+  for (not_null<Vessel*> const vessel : vessels) {
+    trajectories.push_back(vessel->mutable_history());
+  }
+  CommitSpeculativeHistories(t, vessels, trajectories);
+  if (fast_time_warp_) {
+    WarpHistories(t, trajectories);
+  }
+  // The speculative histories may not have been integrated far enough, and the
+  // time warp integration stops short of |t| by less than its step.
+  if (HistoryTime() + Δt_ <= t) {
+    VLOG(1) << "Starting the evolution of the histories" << '\n'
+            << "from : " << HistoryTime();
+    ProfiledIntegrate(*history_integrator_,  // integrator
+                      t,                     // tmax
+                      Δt_,                   // Δt
+                      0,                     // sampling_period
+                      false,                 // tmax_is_exact
+                      trajectories);         // trajectories
   }
-  VLOG(1) << "Starting the evolution of the histories" << '\n'
-          << "from : " << HistoryTime();
-  n_body_system_->Integrate(*history_integrator_,  // integrator
-                            t,                     // tmax
-                            Δt_,                   // Δt
-                            0,                     // sampling_period
-                            false,                 // tmax_is_exact
-                            trajectories);         // trajectories
   CHECK_GE(HistoryTime(), current_time_);
   VLOG(1) << "Evolved the histories" << '\n'
           << "to   : " << HistoryTime();
 }
 
+void Plugin::WarpHistories(
+    Instant const& t,
+    NBodySystem<Barycentric>::Trajectories const& histories) {
+  for (;;) {
+    int const multiple = TimeWarpStepMultiple(t - HistoryTime(), histories);
+    if (multiple < kMinTimeWarpStepMultiple) {
+      break;
+    }
+    Time const step = multiple * Δt_;
+    Instant const history_time = HistoryTime();
+    Instant const tmax =
+        std::min(t, history_time + kTimeWarpStepsPerSelection * step);
+    VLOG(1) << "Warping the histories from " << history_time << " to "
+            << tmax << " with a step of " << step;
+    ProfiledIntegrate(*time_warp_integrator_,  // integrator
+                      tmax,                    // tmax
+                      step,                    // Δt
+                      0,                       // sampling_period
+                      false,                   // tmax_is_exact
+                      histories);              // trajectories
+    time_warp_steps_ += static_cast<std::int64_t>(
+        std::round((HistoryTime() - history_time) / step));
+  }
+}
+
+int Plugin::TimeWarpStepMultiple(
+    Time const& max_step,
+    NBodySystem<Barycentric>::Trajectories const& histories) const {
+  Time min_time_scale =
+      kTimeWarpStepsPerDynamicalTime * kMaxTimeWarpStepMultiple * Δt_;
+  for (std::size_t i = 0; i < histories.size(); ++i) {
+    DegreesOfFreedom<Barycentric> const& degrees_of_freedom =
+        histories[i]->last().degrees_of_freedom();
+    std::size_t j = 0;
+    for (auto const& pair : celestials_) {
+      not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+      if (i != j) {
+        RelativeDegreesOfFreedom<Barycentric> const relative =
+            degrees_of_freedom -
+            celestial->history().last().degrees_of_freedom();
+        Length const distance = relative.displacement().Norm();
+        Speed const speed = relative.velocity().Norm();
+        min_time_scale = std::min(
+            min_time_scale,
+            Sqrt(Pow<3>(distance) /
+                     celestial->body().gravitational_parameter()));
+        if (speed > Speed()) {
+          min_time_scale = std::min(min_time_scale, distance / speed);
+        }
+      }
+      ++j;
+    }
+  }
+  Time const step_bound =
+      std::min(max_step, min_time_scale / kTimeWarpStepsPerDynamicalTime);
+  int multiple = 1;
+  while (2 * multiple <= kMaxTimeWarpStepMultiple &&
+         2 * multiple * Δt_ <= step_bound) {
+    multiple *= 2;
+  }
+  return multiple;
+}
+
+std::vector<not_null<Vessel*>> Plugin::HistoryVessels() const {
+  std::vector<not_null<Vessel*>> vessels;
+  for (auto const& pair : vessels_) {
+    not_null<Vessel*> const vessel = pair.second.get();
+    if (IsHistoryVessel(vessel)) {
+      vessels.push_back(vessel);
+    }
+  }
+  return vessels;
+}
+
+bool Plugin::IsHistoryVessel(not_null<Vessel*> const vessel) const {
+  return vessel->is_synchronized() &&
+         !bubble_->contains(vessel) &&
+         !is_dirty(vessel);
+}
+
+bool Plugin::SpeculativeHistoriesAreIdle() {
+  if (!speculative_histories_integrated_.valid()) {
+    return true;
+  }
+  if (speculative_histories_integrated_.wait_for(std::chrono::seconds(0)) !=
+      std::future_status::ready) {
+    return false;
+  }
+  speculative_histories_integrated_.get();
+  return true;
+}
+
+void Plugin::CommitSpeculativeHistories(
+    Instant const& t,
+    std::vector<not_null<Vessel*>> const& vessels,
+    NBodySystem<Barycentric>::Trajectories const& histories) {
+  if (speculative_histories_ == nullptr || !SpeculativeHistoriesAreIdle()) {
+    return;
+  }
+  auto const& speculative = speculative_histories_->trajectories;
+  Instant const history_time = HistoryTime();
+  if (speculative_histories_->obsolete ||
+      speculative_histories_->vessels != vessels ||
+      speculative.front()->first().time() != history_time) {
+    speculative_histories_->obsolete = true;
+    return;
+  }
+  CHECK_EQ(histories.size(), speculative.size());
+  // Find the last speculative point at or before |t|, and the one before it.
+  // All the speculative histories have the same times.
+  std::int64_t steps = 0;
+  Instant previous = history_time;
+  Instant last = history_time;
+  for (auto it = speculative.front()->first();
+       !it.at_end() && it.time() <= t;
+       ++it) {
+    if (it.time() > history_time) {
+      previous = last;
+      last = it.time();
+      ++steps;
+    }
+  }
+  if (steps == 0) {
+    return;
+  }
+  VLOG(1) << "Committing " << steps << " speculative steps" << '\n'
+          << "from : " << history_time << '\n'
+          << "to   : " << last;
+  for (std::size_t i = 0; i < histories.size(); ++i) {
+    auto const it = speculative[i]->on_or_after(last);
+    CHECK_EQ(last, it.time());
+    histories[i]->Append(last, it.degrees_of_freedom());
+    // The speculation continues from |last|.
+    speculative[i]->ForgetBefore(previous);
+  }
+  committed_speculative_steps_ += steps;
+}
+
+void Plugin::SpeculateHistories(Time const& advance) {
+  if (!SpeculativeHistoriesAreIdle()) {
+    return;
+  }
+  if (!speculative_histories_enabled_) {
+    speculative_histories_.reset();
+    return;
+  }
+  std::vector<not_null<Vessel*>> const vessels = HistoryVessels();
+  if (speculative_histories_ == nullptr ||
+      speculative_histories_->obsolete ||
+      speculative_histories_->vessels != vessels ||
+      speculative_histories_->trajectories.front()->first().time() !=
+          HistoryTime()) {
+    // Restart the speculation from the end of the histories.
+    speculative_histories_ = std::make_unique<SpeculativeHistories>();
+    speculative_histories_->vessels = vessels;
+    auto const snapshot = [this](not_null<Body const*> const body,
+                                 Trajectory<Barycentric> const& history) {
+      speculative_histories_->trajectories.push_back(
+          make_not_null_unique<Trajectory<Barycentric>>(body));
+      speculative_histories_->trajectories.back()->Append(
+          history.last().time(),
+          history.last().degrees_of_freedom());
+    };
+    for (auto const& pair : celestials_) {
+      not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+      snapshot(&celestial->body(), celestial->history());
+    }
+    for (not_null<Vessel*> const vessel : vessels) {
+      speculative_histories_->vessel_bodies.emplace_back();
+      snapshot(&speculative_histories_->vessel_bodies.back(),
+               vessel->history());
+    }
+  }
+  NBodySystem<Barycentric>::Trajectories trajectories;
+  trajectories.reserve(speculative_histories_->trajectories.size());
+  for (auto const& trajectory : speculative_histories_->trajectories) {
+    trajectories.push_back(trajectory.get());
+  }
+  Instant const tmax =
+      current_time_ + std::max(kSpeculativeHistorySteps * Δt_, 2 * advance);
+  if (tmax < trajectories.front()->last().time() + Δt_) {
+    return;
+  }
+  // The speculation takes the same steps as |EvolveHistories()|, but keeps
+  // all the points so that the histories may be advanced to any time.
+  speculative_histories_integrated_ = history_pool_.Add(
+      [this, trajectories, tmax]() {
+        n_body_system_->Integrate(*history_integrator_,
+                                  tmax,
+                                  Δt_,
+                                  1,  // sampling_period
+                                  false,  // tmax_is_exact
+                                  trajectories);
+      });
+}
+
 void Plugin::SynchronizeNewVesselsAndCleanDirtyVessels() {
   VLOG(1) << __FUNCTION__;
   NBodySystem<Barycentric>::Trajectories trajectories;
@@ -686,12 +1391,12 @@ void Plugin::SynchronizeNewVesselsAndCleanDirtyVessels() {
   }
   VLOG(1) << "Starting the synchronization of the new vessels"
           << (bubble_->empty() ? "" : " and of the bubble");
-  n_body_system_->Integrate(*prolongation_integrator_,  // integrator
-                            HistoryTime(),              // tmax
-                            Δt_,                        // Δt
-                            0,                          // sampling_period
-                            true,                       // tmax_is_exact
-                            trajectories);              // trajectories
+  ProfiledIntegrate(*prolongation_integrator_,  // integrator
+                    HistoryTime(),              // tmax
+                    Δt_,                        // Δt
+                    0,                          // sampling_period
+                    true,                       // tmax_is_exact
+                    trajectories);              // trajectories
   if (!bubble_->empty()) {
     SynchronizeBubbleHistories();
   }
@@ -748,18 +1453,102 @@ void Plugin::ResetProlongations() {
   VLOG(1) << "Prolongations have been reset";
 }
 
+void Plugin::UpdateDenseStep(std::vector<not_null<Vessel*>> const& vessels) {
+  if (dense_step_ != nullptr &&
+      dense_step_->trajectories.front().arguments().first == HistoryTime() &&
+      dense_step_->vessels == vessels) {
+    return;
+  }
+  VLOG(1) << "Integrating the dense step" << '\n'
+          << "from : " << HistoryTime();
+  // Integrate one step from the end of the histories.
+  std::vector<not_null<std::unique_ptr<Trajectory<Barycentric>>>> steps;
+  NBodySystem<Barycentric>::Trajectories trajectories;
+  steps.reserve(celestials_.size() + vessels.size());
+  trajectories.reserve(celestials_.size() + vessels.size());
+  auto const start = [&steps, &trajectories](
+      not_null<Body const*> const body,
+      Trajectory<Barycentric> const& history) {
+    steps.push_back(make_not_null_unique<Trajectory<Barycentric>>(body));
+    steps.back()->Append(history.last().time(),
+                         history.last().degrees_of_freedom());
+    trajectories.push_back(steps.back().get());
+  };
+  for (auto const& pair : celestials_) {
+    not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+    start(&celestial->body(), celestial->history());
+  }
+  for (not_null<Vessel*> const vessel : vessels) {
+    start(vessel->body(), vessel->history());
+  }
+  ProfiledIntegrate(*prolongation_integrator_,  // integrator
+                    HistoryTime() + Δt_,        // tmax
+                    Δt_,                        // Δt
+                    0,                          // sampling_period
+                    true,                       // tmax_is_exact
+                    trajectories);              // trajectories
+  dense_step_ = std::make_unique<DenseStep>();
+  dense_step_->vessels = vessels;
+  dense_step_->trajectories.reserve(steps.size());
+  for (auto const& step : steps) {
+    DegreesOfFreedom<Barycentric> const begin =
+        step->first().degrees_of_freedom();
+    DegreesOfFreedom<Barycentric> const end =
+        step->last().degrees_of_freedom();
+    dense_step_->trajectories.emplace_back(
+        std::make_pair(step->first().time(), step->last().time()),
+        std::make_pair(begin.position(), end.position()),
+        std::make_pair(begin.velocity(), end.velocity()));
+  }
+}
+
 void Plugin::EvolveProlongationsAndBubble(Instant const& t) {
   VLOG(1) << __FUNCTION__ << '\n' << NAMED(t);
+  std::vector<not_null<Vessel*>> dense_vessels;
+  // The celestials may only be interpolated if no prolongation is integrated.
+  bool dense_celestials = false;
+  if (dense_prolongations_) {
+    dense_vessels = HistoryVessels();
+    dense_celestials = dense_vessels.size() == vessels_.size();
+    UpdateDenseStep(dense_vessels);
+    CHECK_LE(t, dense_step_->trajectories.front().arguments().second);
+    auto const interpolate = [&t](
+        Hermite3<Instant, Position<Barycentric>> const& step,
+        not_null<Trajectory<Barycentric>*> const prolongation) {
+      // After the prolongations have been reset, they may already end at |t|.
+      if (prolongation->last().time() < t) {
+        prolongation->Append(t, {step.Evaluate(t),
+                                 step.EvaluateDerivative(t)});
+      }
+    };
+    auto it = dense_step_->trajectories.cbegin();
+    for (auto const& pair : celestials_) {
+      not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+      if (dense_celestials) {
+        interpolate(*it, celestial->mutable_prolongation());
+      }
+      ++it;
+    }
+    for (not_null<Vessel*> const vessel : dense_vessels) {
+      interpolate(*it, vessel->mutable_prolongation());
+      ++it;
+    }
+    if (dense_celestials) {
+      return;
+    }
+  }
   NBodySystem<Barycentric>::Trajectories trajectories;
   trajectories.reserve(vessels_.size() + celestials_.size() -
-                       bubble_->number_of_vessels() + bubble_->size());
+                       bubble_->number_of_vessels() + bubble_->size() -
+                       dense_vessels.size());
   for (auto const& pair : celestials_) {
     not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
     trajectories.push_back(celestial->mutable_prolongation());
   }
   for (auto const& pair : vessels_) {
     not_null<Vessel*> const vessel = pair.second.get();
-    if (!bubble_->contains(vessel)) {
+    if (!bubble_->contains(vessel) &&
+        !(dense_prolongations_ && IsHistoryVessel(vessel))) {
       trajectories.push_back(vessel->mutable_prolongation());
     }
   }
@@ -770,12 +1559,12 @@ void Plugin::EvolveProlongationsAndBubble(Instant const& t) {
           << (bubble_->empty() ? "" : " and bubble") << '\n'
           << "from : " << trajectories.front()->last().time() << '\n'
           << "to   : " << t;
-  n_body_system_->Integrate(*prolongation_integrator_,  // integrator
-                            t,                          // tmax
-                            Δt_,                        // Δt
-                            0,                          // sampling_period
-                            true,                       // tmax_is_exact
-                            trajectories);              // trajectories
+  ProfiledIntegrate(*prolongation_integrator_,  // integrator
+                    t,                          // tmax
+                    Δt_,                        // Δt
+                    0,                          // sampling_period
+                    true,                       // tmax_is_exact
+                    trajectories);              // trajectories
   if (!bubble_->empty()) {
     DegreesOfFreedom<Barycentric> const& centre_of_mass =
         bubble_->centre_of_mass_trajectory().last().degrees_of_freedom();
@@ -790,21 +1579,29 @@ void Plugin::EvolveProlongationsAndBubble(Instant const& t) {
 }
 
 void Plugin::UpdatePredictions() {
-  DeletePredictions();
-  if (has_predicted_vessel()) {
-    NBodySystem<Barycentric>::Trajectories predictions;
-    // Room for all the celestials and for the vessel.
-    predictions.reserve(celestials_.size() + 1);
-    for (auto const& index_celestial : celestials_) {
-      auto const& celestial = index_celestial.second;
-      celestial->ForkPrediction();
-      predictions.emplace_back(celestial->mutable_prediction());
-    }
-    predicted_vessel_->ForkPrediction();
-    predictions.emplace_back(predicted_vessel_->mutable_prediction());
-    n_body_system_->Integrate(
+  if (!has_predicted_vessel()) {
+    return;
+  }
+  if (asynchronous_predictions_) {
+    UpdatePredictionsAsynchronously();
+    return;
+  }
+  if (CompletedPredictionIsReusable()) {
+    // The predictions are extended in place, no point is copied.
+    prediction_time_ = current_time_;
+  } else {
+    SetCompletedPrediction(NewPrediction(false));
+  }
+  NBodySystem<Barycentric>::Trajectories predictions;
+  predictions.reserve(completed_prediction_->trajectories.size());
+  for (auto const& trajectory : completed_prediction_->trajectories) {
+    predictions.push_back(trajectory.get());
+  }
+  Instant const tmax = current_time_ + prediction_length_;
+  if (predictions.back()->last().time() + prediction_step_ <= tmax) {
+    ProfiledIntegrate(
         *prolongation_integrator_,
-        current_time_ + prediction_length_,
+        tmax,
         prediction_step_,
         1,  // sampling_period
         false,  // tmax_is_exact
@@ -812,11 +1609,145 @@ void Plugin::UpdatePredictions() {
   }
 }
 
+void Plugin::UpdatePredictionsAsynchronously() {
+  if (pending_prediction_ != nullptr) {
+    if (pending_prediction_integrated_.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      return;
+    }
+    pending_prediction_integrated_.get();
+    std::unique_ptr<AsynchronousPrediction> pending =
+        std::move(pending_prediction_);
+    if (pending->obsolete) {
+      // Discard it.
+    } else if (pending->extension) {
+      // Only the points computed since the snapshot are copied.  The first
+      // point of the extension is the last one of the completed prediction.
+      CHECK(completed_prediction_ != nullptr);
+      for (std::size_t i = 0; i < pending->trajectories.size(); ++i) {
+        Trajectory<Barycentric>& completed =
+            *completed_prediction_->trajectories[i];
+        Trajectory<Barycentric> const& extension = *pending->trajectories[i];
+        for (auto it = extension.first(); !it.at_end(); ++it) {
+          if (it.time() > completed.last().time()) {
+            completed.Append(it.time(), it.degrees_of_freedom());
+          }
+        }
+      }
+      prediction_time_ = pending->snapshot_time;
+    } else if (pending->trajectories.front()->last().time() > current_time_) {
+      // The trajectories change hands, no point is copied.  If the integration
+      // took so long that the pending prediction is entirely in the past, the
+      // current one is kept instead.
+      SetCompletedPrediction(std::move(pending));
+    }
+  }
+
+  // Take a snapshot of the end of the completed prediction if it is reusable,
+  // of the prolongations otherwise, and integrate it on |prediction_pool_|.
+  bool const prediction_is_reusable = CompletedPredictionIsReusable();
+  Instant const tmax = current_time_ + prediction_length_;
+  if (prediction_is_reusable &&
+      completed_prediction_->trajectories.front()->last().time() +
+          prediction_step_ > tmax) {
+    return;
+  }
+  pending_prediction_ = NewPrediction(prediction_is_reusable);
+  NBodySystem<Barycentric>::Trajectories trajectories;
+  trajectories.reserve(pending_prediction_->trajectories.size());
+  for (auto const& trajectory : pending_prediction_->trajectories) {
+    trajectories.push_back(trajectory.get());
+  }
+  Time const step = prediction_step_;
+  pending_prediction_integrated_ = prediction_pool_.Add(
+      [this, trajectories, tmax, step]() {
+        n_body_system_->Integrate(
+            *prolongation_integrator_,
+            tmax,
+            step,
+            1,  // sampling_period
+            false,  // tmax_is_exact
+            trajectories);
+      });
+}
+
+void Plugin::SpillOldHistoryPoints() const {
+  if (history_spill_directory_.empty()) {
+    return;
+  }
+  SpillAllHistoriesBefore(current_time_ - resident_history_length_,
+                          history_spill_directory_);
+}
+
+void Plugin::ReclaimForgottenHistoryPoints() {
+  std::int64_t budget = kMaxReclaimedPointsPerAdvance;
+  for (auto const& pair : celestials_) {
+    not_null<std::unique_ptr<Celestial>> const& celestial = pair.second;
+    budget -= celestial->mutable_history()->ReclaimDetachedPoints(budget);
+    if (budget == 0) {
+      return;
+    }
+  }
+  for (auto const& pair : vessels_) {
+    not_null<std::unique_ptr<Vessel>> const& vessel = pair.second;
+    if (unsynchronized_vessels_.count(vessel.get()) == 0) {
+      budget -= vessel->mutable_history()->ReclaimDetachedPoints(budget);
+      if (budget == 0) {
+        return;
+      }
+    }
+  }
+}
+
+void Plugin::ProfiledIntegrate(
+    SRKNIntegrator const& integrator,
+    Instant const& tmax,
+    Time const& Δt,
+    int const sampling_period,
+    bool const tmax_is_exact,
+    NBodySystem<Barycentric>::Trajectories const& trajectories) {
+  Instant const t0 = trajectories.front()->last().time();
+  // The integration only appends points, so the growth of the trajectories is
+  // the number of points appended.
+  std::int64_t points_appended = 0;
+  std::int64_t allocations = 0;
+  for (not_null<Trajectory<Barycentric>*> const trajectory : trajectories) {
+    points_appended -= trajectory->resident_points();
+    allocations -= trajectory->system_allocations();
+  }
+  std::int64_t force_evaluations = 0;
+  n_body_system_->Integrate(integrator,
+                            tmax,
+                            Δt,
+                            sampling_period,
+                            tmax_is_exact,
+                            trajectories,
+                            &force_evaluations);
+  Instant const t1 = trajectories.front()->last().time();
+  // The last step may be shorter than |Δt| if |tmax_is_exact|.  The tolerance
+  // accounts for rounding errors.
+  std::int64_t const steps =
+      static_cast<std::int64_t>(std::ceil((t1 - t0) / Δt - 1e-6));
+  for (not_null<Trajectory<Barycentric>*> const trajectory : trajectories) {
+    points_appended += trajectory->resident_points();
+    allocations += trajectory->system_allocations();
+  }
+  advance_time_profiler_.RecordIntegration(steps,
+                                           force_evaluations,
+                                           points_appended,
+                                           allocations);
+}
+
 RenderedTrajectory<World> Plugin::RenderTrajectory(
-    not_null<Body const*> const body,
-    Trajectory<Barycentric>::TransformingIterator<Rendering> const& actual_it,
+    MobileInterface const& mobile,
+    RenderingTransforms::LazyTrajectory<Barycentric> const& from_trajectory,
+    Instant const& t1,
+    Instant const& t2,
     not_null<RenderingTransforms*> const transforms,
-    Position<World> const& sun_world_position) const {
+    Position<World> const& sun_world_position,
+    Length const& tolerance,
+    double const level_of_detail) const {
+  CHECK_LE(0, level_of_detail);
   RenderedTrajectory<World> result;
   auto const to_world =
       AffineMap<Barycentric, World, Length, OrthogonalMap>(
@@ -824,30 +1755,68 @@ RenderedTrajectory<World> Plugin::RenderTrajectory(
           sun_world_position,
           OrthogonalMap<WorldSun, World>::Identity() * BarycentricToWorldSun());
 
-  // First build the trajectory resulting from the first transform.
-  Trajectory<Rendering> intermediate_trajectory(body);
-  for (auto it = actual_it; !it.at_end(); ++it) {
-    intermediate_trajectory.Append(it.time(), it.degrees_of_freedom());
-  }
-
-  // Then build the apparent trajectory using the second transform.
-  Trajectory<Barycentric> apparent_trajectory(body);
-  for (auto intermediate_it = transforms->second(intermediate_trajectory);
-       !intermediate_it.at_end();
-       ++intermediate_it) {
-    apparent_trajectory.Append(intermediate_it.time(),
-                               intermediate_it.degrees_of_freedom());
+  // The level of detail decreases with the time distance from |current_time_|:
+  // a point is skipped if it is closer in time to the previous rendered point
+  // than |level_of_detail| times its time distance.  The points are skipped
+  // before they are transformed.  The first point and the point at |t2| are
+  // always rendered.
+  RenderingTransforms::PointFilter filter;
+  if (level_of_detail > 0) {
+    filter = [this, level_of_detail, &t2, rendered = false,
+              last_rendered_time = Instant()](
+        Instant const& time) mutable {
+      if (rendered &&
+          time < t2 &&
+          time - last_rendered_time <
+              level_of_detail * Abs(time - current_time_)) {
+        return false;
+      }
+      rendered = true;
+      last_rendered_time = time;
+      return true;
+    };
   }
 
-  // Finally use the apparent trajectory to build the result.
-  auto initial_it = apparent_trajectory.first();
-  if (!initial_it.at_end()) {
-    for (auto final_it = initial_it;
-         ++final_it, !final_it.at_end();
-         initial_it = final_it) {
-      result.emplace_back(to_world(initial_it.degrees_of_freedom().position()),
-                          to_world(final_it.degrees_of_freedom().position()));
-    }
+  if (tolerance == Length()) {
+    // Stream the points through the given |transforms| and |to_world|, joining
+    // each point to the previous one.  No intermediate trajectory is built.
+    bool has_previous = false;
+    Position<World> previous;
+    transforms->TransformRange(
+        mobile,
+        from_trajectory,
+        t1,
+        t2,
+        [&has_previous, &previous, &result, &to_world](
+            Instant const& time,
+            Position<Barycentric> const& position,
+            Velocity<Barycentric> const& velocity) {
+          Position<World> const world_position = to_world(position);
+          if (has_previous) {
+            result.emplace_back(previous, world_position);
+          }
+          previous = world_position;
+          has_previous = true;
+        },
+        &rendering_pool_,
+        filter);
+  } else {
+    // The simplification needs all the points.
+    std::vector<Position<World>> world_positions;
+    transforms->TransformRange(
+        mobile,
+        from_trajectory,
+        t1,
+        t2,
+        [&world_positions, &to_world](
+            Instant const& time,
+            Position<Barycentric> const& position,
+            Velocity<Barycentric> const& velocity) {
+          world_positions.push_back(to_world(position));
+        },
+        &rendering_pool_,
+        filter);
+    AppendSimplifiedSegments(world_positions, tolerance, &result);
   }
   VLOG(1) << "Returning a " << result.size() << "-segment trajectory";
   return result;
@@ -1,21 +1,30 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <future>  // NOLINT(build/c++11)
+#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "base/monostable.hpp"
+#include "base/thread_pool.hpp"
 #include "geometry/named_quantities.hpp"
 #include "geometry/point.hpp"
 #include "gtest/gtest.h"
+#include "ksp_plugin/advance_time_profiler.hpp"
 #include "ksp_plugin/celestial.hpp"
 #include "ksp_plugin/frames.hpp"
 #include "ksp_plugin/physics_bubble.hpp"
 #include "ksp_plugin/vessel.hpp"
+#include "numerics/hermite3.hpp"
 #include "physics/body.hpp"
+#include "physics/massless_body.hpp"
 #include "physics/n_body_system.hpp"
 #include "physics/trajectory.hpp"
 #include "physics/transforms.hpp"
@@ -27,11 +36,13 @@
 namespace principia {
 namespace ksp_plugin {
 
+using base::ThreadPool;
 using geometry::Displacement;
 using geometry::Instant;
 using geometry::Point;
 using geometry::Rotation;
 using integrators::SPRKIntegrator;
+using numerics::Hermite3;
 using physics::Body;
 using physics::FrameField;
 using physics::NBodySystem;
@@ -47,6 +58,9 @@ using GUID = std::string;
 // The index of a body in |FlightGlobals.Bodies|, obtained by
 // |b.flightGlobalsIndex| in C#. We use this as a key in an |std::map|.
 using Index = int;
+// A handle for a |GUID|, returned by |Plugin::InternVesselGUID|.  It is cheaper
+// to pass and to look up than a |GUID|.
+using VesselHandle = int;
 
 // Represents the line segment {(1-s) |begin| + s |end| | s ∈ [0, 1]}.
 // It is immediate that ∀ s ∈ [0, 1], (1-s) |begin| + s |end| is a convex
@@ -136,6 +150,16 @@ class Plugin {
   virtual bool InsertOrKeepVessel(GUID const& vessel_guid,
                                   Index const parent_index);
 
+  // Returns the handle for |vessel_guid|, creating it if needed.  The handle is
+  // valid for the lifetime of the plugin, even if there is no vessel with
+  // that GUID or if the vessel is removed and inserted again.  The functions
+  // suffixed with |ByHandle| are equivalent to their counterparts taking a
+  // |GUID|, but they don't have to look up or construct strings.
+  virtual VesselHandle InternVesselGUID(GUID const& vessel_guid);
+
+  virtual bool InsertOrKeepVesselByHandle(VesselHandle const vessel_handle,
+                                          Index const parent_index);
+
   // Set the position and velocity of the vessel with GUID |vessel_guid|
   // relative to its parent at current time. |SetVesselStateOffset| must only
   // be called once per vessel. Must be called after initialization.
@@ -146,6 +170,10 @@ class Plugin {
       GUID const& vessel_guid,
       RelativeDegreesOfFreedom<AliceSun> const& from_parent);
 
+  virtual void SetVesselStateOffsetByHandle(
+      VesselHandle const vessel_handle,
+      RelativeDegreesOfFreedom<AliceSun> const& from_parent);
+
   // Simulates the system until instant |t|. All vessels that have not been
   // refreshed by calling |InsertOrKeepVessel| since the last call to
   // |AdvanceTime| will be removed.  Sets |current_time_| to |t|.
@@ -162,9 +190,27 @@ class Plugin {
   virtual void AdvanceTime(Instant const& t, Angle const& planetarium_rotation);
 
   // Forgets the histories of the |celestials_| and of the synchronized vessels
-  // before |t|.
+  // before |t|.  The memory used by the forgotten points is reclaimed
+  // immediately, unless |set_incremental_forgetting(true)| was called, in
+  // which case it is reclaimed incrementally by the subsequent calls to
+  // |AdvanceTime|.
   virtual void ForgetAllHistoriesBefore(Instant const& t) const;
 
+  // Moves the points of the histories of the |celestials_| and of the
+  // synchronized vessels at or before |t| out of the heap, to memory-mapped
+  // files created in |directory|.  The histories are unchanged as far as the
+  // clients of this class are concerned.
+  virtual void SpillAllHistoriesBefore(Instant const& t,
+                                       std::string const& directory) const;
+
+  // From now on, each call to |AdvanceTime()| spills the points of the
+  // histories that are older than |resident_history_length| to files created
+  // in |directory|, so that the memory used by the histories doesn't grow with
+  // their length.  The points detached by |ForgetAllHistoriesBefore()| are only
+  // spilled once they have been reclaimed.
+  virtual void EnableHistorySpilling(std::string const& directory,
+                                     Time const& resident_history_length);
+
   // Returns the displacement and velocity of the vessel with GUID |vessel_guid|
   // relative to its parent at current time. For a KSP |Vessel| |v|, the
   // argument corresponds to  |v.id.ToString()|, the return value to
@@ -174,6 +220,9 @@ class Plugin {
   virtual RelativeDegreesOfFreedom<AliceSun> VesselFromParent(
       GUID const& vessel_guid) const;
 
+  virtual RelativeDegreesOfFreedom<AliceSun> VesselFromParentByHandle(
+      VesselHandle const vessel_handle) const;
+
   // Returns the displacement and velocity of the celestial at index
   // |celestial_index| relative to its parent at current time. For a KSP
   // |CelestialBody| |b|, the argument corresponds to |b.flightGlobalsIndex|,
@@ -188,35 +237,118 @@ class Plugin {
   // |sun_world_position| is the current position of the sun in |World| space as
   // returned by |Planetarium.fetch.Sun.position|.  It is used to define the
   // relation between |WorldSun| and |World|.  No transfer of ownership.
+  // If |level_of_detail| is not 0, the density of the points of the polygon
+  // decreases with their time distance from |current_time()|: two consecutive
+  // points are at least |level_of_detail| times this distance apart in time.
+  // If |level_of_detail| is 0 all the points of the trajectory are used.  The
+  // polygon deviates from the one joining these points by at most |tolerance|;
+  // if |tolerance| is 0 all of them are used.
   virtual RenderedTrajectory<World> RenderedVesselTrajectory(
       GUID const& vessel_guid,
       not_null<RenderingTransforms*> const transforms,
-      Position<World> const& sun_world_position) const;
+      Position<World> const& sun_world_position,
+      Length const& tolerance,
+      double const level_of_detail) const;
 
-  // Returns a polygon in |World| space depicting the trajectory of
-  // |predicted_vessel_| from |current_time()| to
+  // Returns a polygon in |World| space depicting the prediction of the vessel
+  // with the given |GUID| from |current_time()| to
   // |current_time() + prediction_length_| in the frame defined by |transforms|.
   // |sun_world_position| is the current  position of the sun in |World| space
   // as returned by |Planetarium.fetch.Sun.position|.  It is used to define the
   // relation between |WorldSun| and |World|.  No transfer of ownership.
-  // |predicted_vessel_| must have been set, and |AdvanceTime()| must have been
-  // called after |predicted_vessel_| was set.  Not const because of the stupid
-  // global variable |transforms_are_operating_on_predictions_|.
+  // The result is empty unless |has_prediction(vessel_guid)|.  The prediction
+  // is rendered from its first point, which is at most one prediction step
+  // before |current_time()| unless it is an asynchronous prediction that has
+  // not been extended since its snapshot.  Not const because of the stupid
+  // global variable |transforms_are_operating_on_predictions_|.  |tolerance| and
+  // |level_of_detail| are as for |RenderedVesselTrajectory|.
   virtual RenderedTrajectory<World> RenderedPrediction(
+      GUID const& vessel_guid,
       not_null<RenderingTransforms*> const transforms,
-      Position<World> const& sun_world_position);
+      Position<World> const& sun_world_position,
+      Length const& tolerance,
+      double const level_of_detail);
 
+  // Makes the vessel with the given |GUID| the only one in
+  // |predicted_vessels_|.  The predictions are kept if it already was.
   virtual void set_predicted_vessel(GUID const& vessel_guid);
-  // Calls |DeletePredictions()| and nulls |predicted_vessel_|.
+  // Adds the vessel with the given |GUID| to |predicted_vessels_|.  Since the
+  // predictions of all the |predicted_vessels_| are integrated together, this
+  // deletes the existing predictions if the vessel was not already predicted.
+  virtual void add_predicted_vessel(GUID const& vessel_guid);
+  // Removes the vessel with the given |GUID| from |predicted_vessels_|, if it
+  // is there, and deletes its prediction.  The predictions of the other
+  // vessels are kept.
+  virtual void remove_predicted_vessel(GUID const& vessel_guid);
+  // Calls |DeletePredictions()| and clears |predicted_vessels_|.
   virtual void clear_predicted_vessel();
+  // True if the vessel with the given |GUID| is in |predicted_vessels_| and
+  // its prediction has been computed by |AdvanceTime()|.
+  virtual bool has_prediction(GUID const& vessel_guid) const;
 
+  // Calls |DeletePredictions()| if |t| is not the current length.
   virtual void set_prediction_length(Time const& t);
 
-  // The step used when computing the prediction.
+  // The step used when computing the prediction.  Calls |DeletePredictions()|
+  // if |t| is not the current step.
   virtual void set_prediction_step(Time const& t);
 
+  // If |asynchronous| is true, the predictions are integrated on
+  // |prediction_pool_| from a snapshot taken by |AdvanceTime()|, which never
+  // waits for them; the last completed prediction is rendered until the next
+  // one completes.  Otherwise, they are integrated by |AdvanceTime()|.
+  // Defaults to false.
+  virtual void set_asynchronous_predictions(bool const asynchronous);
+
+  // The time elapsed between the snapshot from which the current prediction
+  // was integrated and |current_time()|.  Always 0 if the predictions are not
+  // asynchronous, or if there is no prediction.
+  virtual Time prediction_staleness() const;
+
+  // If |speculative| is true, the histories of the celestials and of the
+  // vessels that are only subject to gravity are integrated on |history_pool_|
+  // ahead of |current_time()|, and |AdvanceTime()| appends the points that
+  // have already been computed to the histories instead of integrating them.
+  // |AdvanceTime()| never waits for the speculation.  Defaults to false.
+  virtual void set_speculative_histories(bool const speculative);
+
+  // The number of steps of size |Δt_| by which |AdvanceTime()| advanced the
+  // histories using the speculative histories rather than by integrating
+  // them.
+  std::int64_t committed_speculative_steps() const;
+
+  // If |dense| is true, |AdvanceTime()| doesn't integrate the prolongations of
+  // the vessels that are only subject to gravity: it interpolates them in the
+  // current step of size |Δt_| of their histories, which is integrated once.
+  // The celestials are interpolated too, unless some prolongations must still
+  // be integrated: those of the physics bubble and of the vessels that are
+  // unsynchronized or dirty.  Defaults to false.
+  virtual void set_dense_prolongations(bool const dense);
+
+  // If |fast| is true, when |AdvanceTime()| advances the histories by many
+  // steps, as happens under high time warp, it integrates them with a
+  // higher-order integrator and steps that are a power-of-2 multiple of |Δt_|.
+  // The multiple is selected from the advance and from the dynamical times and
+  // relative speeds of the bodies with respect to the celestials, so the steps
+  // fall back to |Δt_| near close approaches.  Defaults to false.
+  virtual void set_fast_time_warp(bool const fast);
+
+  // If |incremental| is true, |ForgetAllHistoriesBefore()| only detaches the
+  // forgotten points, and each call to |AdvanceTime()| frees a bounded number
+  // of them, so that forgetting a long history doesn't stall a frame.
+  // Defaults to false.
+  virtual void set_incremental_forgetting(bool const incremental);
+
+  // The number of steps taken by the time warp integrator of the histories.
+  std::int64_t time_warp_steps() const;
+
+  // The measurements of the phases of the last calls to |AdvanceTime()|.
+  virtual AdvanceTimeProfiler const& advance_time_profiler() const;
+
   virtual bool has_vessel(GUID const& vessel_guid) const;
 
+  virtual bool has_vessel_by_handle(VesselHandle const vessel_handle) const;
+
   virtual not_null<std::unique_ptr<RenderingTransforms>>
   NewBodyCentredNonRotatingTransforms(Index const reference_body_index) const;
 
@@ -276,6 +408,7 @@ class Plugin {
   using GUIDToUnownedVessel = std::map<GUID, not_null<Vessel*> const>;
   using IndexToOwnedCelestial =
       std::map<Index, not_null<std::unique_ptr<Celestial>>>;
+  struct AsynchronousPrediction;
 
   // This constructor should only be used during deserialization.
   // |unsynchronized_vessels_| is initialized consistently.  All vessels are
@@ -290,6 +423,15 @@ class Plugin {
 
   not_null<std::unique_ptr<Vessel>> const& find_vessel_by_guid_or_die(
       GUID const& vessel_guid) const;
+  // |vessel_handle| must have been returned by |InternVesselGUID|, and there
+  // must be a vessel with the corresponding GUID.
+  not_null<Vessel*> find_vessel_by_handle_or_die(
+      VesselHandle const vessel_handle) const;
+
+  // The implementation of |VesselFromParent| and |VesselFromParentByHandle|.
+  RelativeDegreesOfFreedom<AliceSun> VesselFromParent(
+      GUID const& vessel_guid,
+      Vessel const& vessel) const;
 
   // Returns |!dirty_vessels_.empty()|.
   bool has_dirty_vessels() const;
@@ -297,12 +439,37 @@ class Plugin {
   bool has_unsynchronized_vessels() const;
   // Returns |dirty_vessels_.count(vessel) > 0|.
   bool is_dirty(not_null<Vessel*> const vessel) const;
-  // Returns |predicted_vessel_ != nullptr|.
+  // Returns |!predicted_vessels_.empty()|.
   bool has_predicted_vessel() const;
-  // Returns true if there is a |predicted_vessel_| and it has a prediction.
+  // Returns true if there are |predicted_vessels_| and they have predictions.
   bool HasPredictions() const;
+  // Removes |vessel| from |predicted_vessels_|, where it must be, and deletes
+  // its prediction.
+  void RemovePredictedVessel(not_null<Vessel*> const vessel);
   // Deletes all the predictions.
   void DeletePredictions();
+  // Deletes all the predictions, and marks the |pending_prediction_|, if any,
+  // as obsolete.  Called when the predicted vessel or the parameters of the
+  // predictions change.
+  void InvalidatePredictions();
+  // Returns a prediction for the celestials and the |predicted_vessels_| whose
+  // trajectories each have a single point, the end of the corresponding
+  // trajectory of the |completed_prediction_| if |extension|, the end of the
+  // corresponding prolongation otherwise.
+  std::unique_ptr<AsynchronousPrediction> NewPrediction(
+      bool const extension) const;
+  // Deletes the predictions and makes |prediction| the
+  // |completed_prediction_|, whose trajectories become the predictions.
+  void SetCompletedPrediction(
+      std::unique_ptr<AsynchronousPrediction> prediction);
+  // Returns true if the |completed_prediction_| may be extended: it is not
+  // obsolete, it extends beyond |current_time_|, none of the
+  // |predicted_vessels_| is in the |bubble_|, and its trajectories, interpolated
+  // at |current_time_|, are within a tolerance of the ends of the
+  // prolongations.  Unless it is obsolete or in the past, forgets the points of
+  // the |completed_prediction_| that are more than |prediction_step_| before
+  // |current_time_|.
+  bool CompletedPredictionIsReusable();
 
   // The common last time of the histories of synchronized vessels and
   // celestials.
@@ -331,8 +498,48 @@ class Plugin {
   void CheckVesselInvariants(GUIDToOwnedVessel::const_iterator const it) const;
   // Evolves the histories of the |celestials_| and of the synchronized vessels
   // up to at most |t|. |t| must be large enough that at least one step of
-  // size |Δt_| can fit between |current_time_| and |t|.
+  // size |Δt_| can fit between |current_time_| and |t|.  Uses the
+  // |speculative_histories_| if possible.
   void EvolveHistories(Instant const& t);
+  // Called from |EvolveHistories()| if |fast_time_warp_|, evolves the
+  // |histories|, which must be the histories of the celestials, in the order
+  // of |celestials_|, followed by those of the vessels, towards |t| with the
+  // |time_warp_integrator_| for as long as |TimeWarpStepMultiple()| is at
+  // least |kMinTimeWarpStepMultiple|.
+  void WarpHistories(Instant const& t,
+                     NBodySystem<Barycentric>::Trajectories const& histories);
+  // Returns the largest power of 2, at most |kMaxTimeWarpStepMultiple|, such
+  // that a multiple of |Δt_| by that power is at most |max_step| and is small
+  // compared to the dynamical time of each of the |histories| with respect to
+  // each celestial, and to the time it would take to reach that celestial at
+  // their relative speed.  Returns 1 if there is no such power.
+  int TimeWarpStepMultiple(
+      Time const& max_step,
+      NBodySystem<Barycentric>::Trajectories const& histories) const;
+  // Returns the vessels whose histories are evolved by |EvolveHistories()|,
+  // i.e., the synchronized vessels that are neither in the |bubble_| nor
+  // dirty, in the order of |vessels_|.
+  std::vector<not_null<Vessel*>> HistoryVessels() const;
+  // Returns true if |vessel| is one of the |HistoryVessels()|.
+  bool IsHistoryVessel(not_null<Vessel*> const vessel) const;
+  // Returns true if no integration of the |speculative_histories_| is in
+  // progress on |history_pool_|.
+  bool SpeculativeHistoriesAreIdle();
+  // If the |speculative_histories_| are idle and were integrated from the
+  // current histories of the celestials and of |vessels|, appends their last
+  // point at or before |t| to |histories|, which must be the histories of the
+  // celestials, in the order of |celestials_|, and of |vessels|.  Otherwise
+  // marks them obsolete.
+  void CommitSpeculativeHistories(
+      Instant const& t,
+      std::vector<not_null<Vessel*>> const& vessels,
+      NBodySystem<Barycentric>::Trajectories const& histories);
+  // If the histories are speculative and the |speculative_histories_| are
+  // idle, starts extending them on |history_pool_| up to
+  // |kSpeculativeHistorySteps| steps or twice |advance| ahead of
+  // |current_time_|, whichever is longer.  If they are obsolete, they are
+  // first restarted from the current histories.
+  void SpeculateHistories(Time const& advance);
   // Synchronizes the |unsynchronized_vessels_|, clears
   // |unsynchronized_vessels_|.  Prolongs the histories of the vessels in the
   // physics bubble by evolving the trajectory of the |current_physics_bubble_|
@@ -347,23 +554,69 @@ class Plugin {
   // Resets the prolongations of all vessels and celestials to |HistoryTime()|.
   // All vessels must satisfy |is_synchronized()|.
   void ResetProlongations();
+  // Makes sure that the |dense_step_| starts at |HistoryTime()| and is for the
+  // given |vessels|, integrating it if needed.
+  void UpdateDenseStep(std::vector<not_null<Vessel*>> const& vessels);
   // Evolves the prolongations of all celestials and vessels up to exactly
   // instant |t|.  Also evolves the trajectory of the |current_physics_bubble_|
-  // if there is one.
+  // if there is one.  If |dense_prolongations_|, the prolongations are
+  // interpolated in the |dense_step_| where possible.
   void EvolveProlongationsAndBubble(Instant const& t);
-  // Calls |DeletePredictions()|.  If |has_predicted_vessel()|, computes
-  // |system_predictions_| and |prediction_| for the |predicted_vessel_|
-  // according to |prediction_length_| and |prediction_step_|.
+  // If |has_predicted_vessel()|, makes sure that the predictions of the
+  // celestials and of the |predicted_vessels_| extend to
+  // |current_time_ + prediction_length_| with a step of |prediction_step_|.
+  // They are all integrated together, in the trajectories of the
+  // |completed_prediction_|, which are not forked from the prolongations and
+  // therefore survive their reset.  The |completed_prediction_| is extended in
+  // place if |CompletedPredictionIsReusable()|, otherwise it is recomputed from
+  // the ends of the prolongations.
+  // If |asynchronous_predictions_|, calls |UpdatePredictionsAsynchronously()|
+  // instead.
   void UpdatePredictions();
+  // If the |pending_prediction_| has completed and is not obsolete, either
+  // appends its points to the |completed_prediction_| if it is an extension,
+  // or makes it the |completed_prediction_|, whose trajectories become the
+  // predictions.  The cost on the calling thread is proportional to the
+  // number of points computed since the last call, not to the length of the
+  // predictions.  If there is no |pending_prediction_| left, starts a new one,
+  // which extends the |completed_prediction_| under the same conditions as
+  // |UpdatePredictions|, and otherwise starts at the end of the
+  // prolongations.
+  void UpdatePredictionsAsynchronously();
+  // Frees the memory of a bounded number of the points detached by
+  // |ForgetAllHistoriesBefore|.
+  void ReclaimForgottenHistoryPoints();
+  // If |EnableHistorySpilling()| was called, spills the points of the
+  // histories older than |resident_history_length_|.
+  void SpillOldHistoryPoints() const;
+  // Calls |n_body_system_->Integrate| with the given arguments, and records
+  // the work done in the current phase of the |advance_time_profiler_|.  Must
+  // only be called on the thread that calls |AdvanceTime()|.
+  void ProfiledIntegrate(
+      SRKNIntegrator const& integrator,
+      Instant const& tmax,
+      Time const& Δt,
+      int const sampling_period,
+      bool const tmax_is_exact,
+      NBodySystem<Barycentric>::Trajectories const& trajectories);
 
   // A utility for |RenderedPrediction| and |RenderedVesselTrajectory|,
   // returns a |RenderedTrajectory| as computed by the given |transforms|
-  // from the trajectory of |body| starting at |actual_it|.
+  // from the points of the trajectory |from_trajectory| of |mobile| in
+  // [|t1|, |t2|].  The points are streamed through the transforms, on
+  // |rendering_pool_| if there are many of them.  If |level_of_detail| is not
+  // 0, the points are thinned out with their time distance from
+  // |current_time_| before being transformed.  If |tolerance| is not 0, the
+  // result is simplified by the Douglas-Peucker algorithm.
   RenderedTrajectory<World> RenderTrajectory(
-      not_null<Body const*> const body,
-      Trajectory<Barycentric>::TransformingIterator<Rendering> const& actual_it,
-      not_null<RenderingTransforms*>const transforms,
-      Position<World> const& sun_world_position) const;
+      MobileInterface const& mobile,
+      RenderingTransforms::LazyTrajectory<Barycentric> const& from_trajectory,
+      Instant const& t1,
+      Instant const& t2,
+      not_null<RenderingTransforms*> const transforms,
+      Position<World> const& sun_world_position,
+      Length const& tolerance,
+      double const level_of_detail) const;
 
   // TODO(egg): Constant time step for now.
   Time const Δt_ = 10 * Second;
@@ -381,13 +634,106 @@ class Plugin {
   // prolongation.  The pointers are not owning.
   std::set<not_null<Vessel*> const> dirty_vessels_;
 
+  // The GUIDs interned by |InternVesselGUID|, and their handles, which are
+  // indices in |interned_vessels_|.
+  std::unordered_map<GUID, VesselHandle> vessel_handles_;
+  struct InternedVessel {
+    // Points to a key of |vessel_handles_|.
+    not_null<GUID const*> guid;
+    // The vessel in |vessels_| with that GUID, or null if there is none.  Not
+    // owning.
+    Vessel* vessel;
+  };
+  std::vector<InternedVessel> interned_vessels_;
+
   // The vessels that will be kept during the next call to |AdvanceTime|.
   std::set<not_null<Vessel const*> const> kept_vessels_;
 
-  // Only one prediction for now, using constant timestep.
-  Vessel* predicted_vessel_ = nullptr;
+  // The vessels for which predictions are computed, using constant timestep.
+  // The pointers are not owning.
+  std::set<not_null<Vessel*> const> predicted_vessels_;
   Time prediction_length_ = 1 * Hour;
   Time prediction_step_ = Δt_;
+  bool asynchronous_predictions_ = false;
+  // The time of the state from which the current predictions were integrated.
+  Instant prediction_time_;
+
+  // A prediction integrated on |prediction_pool_|, or on the main thread unless
+  // |asynchronous_predictions_|.  The |trajectories| are roots for the
+  // celestials, in the order of |celestials_|, and for the
+  // |predicted_vessels_|, in their order.  They start at the end of the
+  // prolongations, or at the end of the |completed_prediction_| if
+  // |extension|.  Only |trajectories| are accessed by the pool.
+  struct AsynchronousPrediction {
+    // The value of |current_time_| when the integration was started.
+    Instant snapshot_time;
+    bool extension = false;
+    // Set if the predicted vessels or the parameters of the prediction changed
+    // after the snapshot.
+    bool obsolete = false;
+    // Stand for the |predicted_vessels_|, which may be destroyed before the
+    // integration completes.
+    std::list<MasslessBody> vessel_bodies;
+    std::vector<not_null<std::unique_ptr<Trajectory<Barycentric>>>>
+        trajectories;
+  };
+  std::unique_ptr<AsynchronousPrediction> pending_prediction_;
+  // Ready when the integration of the |pending_prediction_| has completed.
+  std::future<void> pending_prediction_integrated_;
+  // The last prediction integrated on |prediction_pool_|, or the one extended
+  // by |UpdatePredictions| unless |asynchronous_predictions_|.  Its
+  // |trajectories| are the predictions, which are not owned by the vessels and
+  // celestials, and are only accessed by the main thread.
+  std::unique_ptr<AsynchronousPrediction> completed_prediction_;
+
+  bool speculative_histories_enabled_ = false;
+  // Histories integrated on |history_pool_| beyond |HistoryTime()|.  The
+  // |trajectories| are roots that start at |HistoryTime()| unless the
+  // histories were advanced without them, and are in the order of
+  // |celestials_| and of the |vessels|.  Only |trajectories| are accessed by
+  // the pool.
+  struct SpeculativeHistories {
+    // Set if a vessel was removed or one of the |vessels| joined the physics
+    // bubble.
+    bool obsolete = false;
+    std::vector<not_null<Vessel*>> vessels;
+    // Stand for the |vessels|, which may be destroyed before the integration
+    // completes.
+    std::list<MasslessBody> vessel_bodies;
+    std::vector<not_null<std::unique_ptr<Trajectory<Barycentric>>>>
+        trajectories;
+  };
+  std::unique_ptr<SpeculativeHistories> speculative_histories_;
+  // Valid while an integration of the |speculative_histories_| has not been
+  // waited for.
+  std::future<void> speculative_histories_integrated_;
+  std::int64_t committed_speculative_steps_ = 0;
+
+  bool dense_prolongations_ = false;
+  // The continuous extension over [|HistoryTime()|, |HistoryTime() + Δt_|] of
+  // the motion of the celestials, in the order of |celestials_|, and of the
+  // |vessels|, which are only subject to gravity.
+  struct DenseStep {
+    std::vector<not_null<Vessel*>> vessels;
+    std::vector<Hermite3<Instant, Position<Barycentric>>> trajectories;
+  };
+  std::unique_ptr<DenseStep> dense_step_;
+
+  bool fast_time_warp_ = false;
+  std::int64_t time_warp_steps_ = 0;
+
+  bool incremental_forgetting_ = false;
+
+  // Empty if the histories are not spilled by |AdvanceTime()|.
+  std::string history_spill_directory_;
+  Time resident_history_length_;
+
+  // The threads used to transform the trajectories for rendering.  They are
+  // only started by the first trajectory long enough to be transformed in
+  // parallel.  Mutable because rendering doesn't change the state of the
+  // plugin.
+  mutable ThreadPool rendering_pool_{
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()))};
 
   not_null<std::unique_ptr<PhysicsBubble>> const bubble_;
 
@@ -396,6 +742,10 @@ class Plugin {
   not_null<SRKNIntegrator const*> const history_integrator_;
   // The integrator computing the prolongations.
   not_null<SRKNIntegrator const*> const prolongation_integrator_;
+  // The higher-order integrator computing the histories under time warp.
+  not_null<SRKNIntegrator const*> const time_warp_integrator_;
+
+  AdvanceTimeProfiler advance_time_profiler_;
 
   // Whether initialization is ongoing.
   base::Monostable initializing_;
@@ -406,6 +756,13 @@ class Plugin {
 
   not_null<Celestial*> const sun_;  // Not owning.
 
+  // The threads integrating the |pending_prediction_| and the
+  // |speculative_histories_|.  They are only started once asynchronous
+  // predictions or speculative histories are used.  Declared last so that they
+  // are joined before the members used by the integrations are destroyed.
+  ThreadPool prediction_pool_{1};
+  ThreadPool history_pool_{1};
+
   friend class TestablePlugin;
 };
 
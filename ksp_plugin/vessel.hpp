@@ -88,7 +88,12 @@ class Vessel : public MobileInterface {
   // Requires |is_initialized()| and |!has_prediction()|.
   void ForkPrediction();
 
-  // Deletes the |prediction_|.
+  // Makes |prediction| the |prediction_|.  It must be a root trajectory which
+  // outlives its use as the prediction.  No transfer of ownership.  Requires
+  // |is_initialized()| and |!has_prediction()|.
+  void set_prediction(not_null<Trajectory<Barycentric>*> const prediction);
+
+  // Deletes the |prediction_| if it was forked, forgets it otherwise.
   void DeletePrediction();
 
   // The vessel must satisfy |is_initialized()|.
@@ -105,8 +105,20 @@ inline void Vessel::ForkPrediction() {
   prediction_ = mutable_prolongation()->NewFork(prolongation().last().time());
 }
 
+inline void Vessel::set_prediction(
+    not_null<Trajectory<Barycentric>*> const prediction) {
+  CHECK(is_initialized());
+  CHECK(prediction_ == nullptr);
+  CHECK(prediction->is_root());
+  prediction_ = prediction;
+}
+
 inline void Vessel::DeletePrediction() {
-  prolongation_->DeleteFork(&prediction_);
+  if (CHECK_NOTNULL(prediction_)->is_root()) {
+    prediction_ = nullptr;
+  } else {
+    prolongation_->DeleteFork(&prediction_);
+  }
 }
 
 inline void Vessel::WriteToMessage(
@@ -32,6 +32,21 @@ public partial class PrincipiaPluginAdapter : ScenarioModule {
   // the evaluation of the cubic).
   private const int kMaxVectorLinePoints = 32766;
 
+  // The number of segments fetched from native code by each call to
+  // |FetchAndIncrementSegments|.
+  private const int kSegmentBufferSize = 1024;
+  private LineSegment[] segment_buffer_ = new LineSegment[kSegmentBufferSize];
+
+  // If |spill_histories_|, the points of the histories older than this many
+  // seconds are spilled to files in a temporary directory by |AdvanceTime|.
+  // The directory is specific to the process, since the plugins of two
+  // instances of the game would otherwise use the same file names.
+  private const double kResidentHistoryLength = 1 << 18;
+  private readonly String history_spill_directory_ =
+      System.IO.Path.Combine(
+          System.IO.Path.GetTempPath(),
+          "Principia." + System.Diagnostics.Process.GetCurrentProcess().Id);
+
   private ApplicationLauncherButton toolbar_button_;
   private bool hide_all_gui_ = false;
 
@@ -45,6 +60,8 @@ public partial class PrincipiaPluginAdapter : ScenarioModule {
   private UnityEngine.Rect main_window_rectangle_;
 
   private IntPtr plugin_ = IntPtr.Zero;
+  // The handles returned by |InternVesselGUID| for |plugin_|.
+  private Dictionary<Guid, int> vessel_handles_ = new Dictionary<Guid, int>();
   // TODO(egg): rendering only one trajectory at the moment.
   private VectorLine rendered_prediction_;
   private VectorLine rendered_trajectory_;
@@ -58,6 +75,8 @@ public partial class PrincipiaPluginAdapter : ScenarioModule {
   [KSPField(isPersistant = true)]
   private bool display_patched_conics_ = false;
   [KSPField(isPersistant = true)]
+  private bool asynchronous_predictions_ = false;
+  [KSPField(isPersistant = true)]
   private bool fix_navball_in_plotting_frame_ = true;
 
   private readonly double[] prediction_step_sizes_ =
@@ -78,6 +97,18 @@ public partial class PrincipiaPluginAdapter : ScenarioModule {
        1 << 26, 1 << 27, 1 << 28, 1 << 29, double.PositiveInfinity};
   [KSPField(isPersistant = true)]
   private int history_length_index_ = 10;
+  [KSPField(isPersistant = true)]
+  private bool speculative_histories_ = false;
+  [KSPField(isPersistant = true)]
+  private bool dense_prolongations_ = false;
+  [KSPField(isPersistant = true)]
+  private bool fast_time_warp_ = false;
+  [KSPField(isPersistant = true)]
+  private bool incremental_forgetting_ = false;
+  // Spilling cannot be turned off for a running plugin, it stays on until the
+  // plugin is next constructed or loaded.
+  [KSPField(isPersistant = true)]
+  private bool spill_histories_ = false;
 
   [KSPField(isPersistant = true)]
   private bool show_reference_frame_selection_ = true;
@@ -85,6 +116,12 @@ public partial class PrincipiaPluginAdapter : ScenarioModule {
   private bool show_prediction_settings_ = true;
   [KSPField(isPersistant = true)]
   private bool show_logging_settings_ = false;
+  [KSPField(isPersistant = true)]
+  private bool show_profiling_ = false;
+  // Whether the calls to the plugin are recorded in a journal, starting with
+  // the next construction or deserialization of the plugin.
+  [KSPField(isPersistant = true)]
+  private bool record_journal_ = false;
 #if CRASH_BUTTON
   [KSPField(isPersistant = true)]
   private bool show_crash_options_ = false;
@@ -204,27 +241,59 @@ where is_in_physics_bubble(vessel)
                                       universal_time);
   }
 
-  private void UpdateVessel(Vessel vessel, double universal_time) {
-    bool inserted = InsertOrKeepVessel(
-        plugin_,
-        vessel.id.ToString(),
-        vessel.orbit.referenceBody.flightGlobalsIndex);
-    if (inserted) {
-      SetVesselStateOffset(plugin      : plugin_,
-                           vessel_guid : vessel.id.ToString(),
-                           from_parent : new QP{q = (XYZ)vessel.orbit.pos,
-                                                p = (XYZ)vessel.orbit.vel});
+  private int VesselHandle(Vessel vessel) {
+    int vessel_handle;
+    if (!vessel_handles_.TryGetValue(vessel.id, out vessel_handle)) {
+      vessel_handle = InternVesselGUID(plugin_, vessel.id.ToString());
+      vessel_handles_.Add(vessel.id, vessel_handle);
+    }
+    return vessel_handle;
+  }
+
+  // Updates all the |vessels| with a few calls to the plugin, instead of a few
+  // calls per vessel.
+  private void UpdateVessels(List<Vessel> vessels, double universal_time) {
+    int count = vessels.Count;
+    int[] vessel_handles = new int[count];
+    int[] parent_indices = new int[count];
+    for (int i = 0; i < count; ++i) {
+      vessel_handles[i] = VesselHandle(vessels[i]);
+      parent_indices[i] = vessels[i].orbit.referenceBody.flightGlobalsIndex;
+    }
+    bool[] inserted = new bool[count];
+    InsertOrKeepVessels(plugin_,
+                        vessel_handles,
+                        parent_indices,
+                        count,
+                        inserted);
+    var inserted_handles = new List<int>();
+    var initial_offsets = new List<QP>();
+    for (int i = 0; i < count; ++i) {
+      if (inserted[i]) {
+        inserted_handles.Add(vessel_handles[i]);
+        initial_offsets.Add(new QP{q = (XYZ)vessels[i].orbit.pos,
+                                   p = (XYZ)vessels[i].orbit.vel});
+      }
+    }
+    if (inserted_handles.Count > 0) {
+      SetVesselStateOffsets(plugin_,
+                            inserted_handles.ToArray(),
+                            initial_offsets.ToArray(),
+                            inserted_handles.Count);
+    }
+    QP[] from_parents = new QP[count];
+    VesselsFromParents(plugin_, vessel_handles, count, from_parents);
+    for (int i = 0; i < count; ++i) {
+      // NOTE(egg): Here we work around a KSP bug: |Orbit.pos| for a vessel
+      // corresponds to the position one timestep in the future.  This is not
+      // the case for celestial bodies.
+      vessels[i].orbit.UpdateFromStateVectors(
+          pos     : (Vector3d)from_parents[i].q +
+                    (Vector3d)from_parents[i].p * UnityEngine.Time.deltaTime,
+          vel     : (Vector3d)from_parents[i].p,
+          refBody : vessels[i].orbit.referenceBody,
+          UT      : universal_time);
     }
-    QP from_parent = VesselFromParent(plugin_, vessel.id.ToString());
-    // NOTE(egg): Here we work around a KSP bug: |Orbit.pos| for a vessel
-    // corresponds to the position one timestep in the future.  This is not
-    // the case for celestial bodies.
-    vessel.orbit.UpdateFromStateVectors(
-        pos     : (Vector3d)from_parent.q +
-                  (Vector3d)from_parent.p * UnityEngine.Time.deltaTime,
-        vel     : (Vector3d)from_parent.p,
-        refBody : vessel.orbit.referenceBody,
-        UT      : universal_time);
   }
 
   private void AddToPhysicsBubble(Vessel vessel) {
@@ -241,19 +310,21 @@ where is_in_physics_bubble(vessel)
              gravitational_acceleration_to_be_applied_by_ksp = (XYZ)gravity,
              id = part.flightID}).ToArray();
     if (parts.Count() > 0) {
-      bool inserted = InsertOrKeepVessel(
+      int vessel_handle = VesselHandle(vessel);
+      bool inserted = InsertOrKeepVesselByHandle(
           plugin_,
-          vessel.id.ToString(),
+          vessel_handle,
           vessel.orbit.referenceBody.flightGlobalsIndex);
       if (inserted) {
         // NOTE(egg): this is only used when a (plugin-managed) physics bubble
         // appears with a new vessel (e.g. when exiting the atmosphere).
         // TODO(egg): these degrees of freedom are off by one Δt and we don't
         // compensate for the pos/vel synchronization bug.
-        SetVesselStateOffset(plugin      : plugin_,
-                             vessel_guid : vessel.id.ToString(),
-                             from_parent : new QP{q = (XYZ)vessel.orbit.pos,
-                                                  p = (XYZ)vessel.orbit.vel});
+        SetVesselStateOffsetByHandle(
+            plugin        : plugin_,
+            vessel_handle : vessel_handle,
+            from_parent   : new QP{q = (XYZ)vessel.orbit.pos,
+                                   p = (XYZ)vessel.orbit.vel});
       }
       AddVesselToNextPhysicsBubble(plugin      : plugin_,
                                    vessel_guid : vessel.id.ToString(),
@@ -385,6 +456,7 @@ where is_in_physics_bubble(vessel)
     base.OnLoad(node);
     if (node.HasValue(kPrincipiaKey)) {
       Cleanup();
+      StartOrStopJournal();
       SetRotatingFrameThresholds();
 
       IntPtr deserializer = IntPtr.Zero;
@@ -399,6 +471,7 @@ where is_in_physics_bubble(vessel)
                           ref plugin_);
       }
       DeserializePlugin("", 0, ref deserializer, ref plugin_);
+      EnableHistorySpilling();
 
       UpdateRenderingFrame();
       plugin_construction_ = DateTime.Now;
@@ -572,16 +645,23 @@ where is_in_physics_bubble(vessel)
             prediction_step_sizes_[prediction_step_index_]);
         set_prediction_length(plugin_,
                               prediction_lengths_[prediction_length_index_]);
+        set_asynchronous_predictions(plugin_, asynchronous_predictions_);
       } else {
         clear_predicted_vessel(plugin_);
       }
+      set_speculative_histories(plugin_, speculative_histories_);
+      set_dense_prolongations(plugin_, dense_prolongations_);
+      set_fast_time_warp(plugin_, fast_time_warp_);
+      set_incremental_forgetting(plugin_, incremental_forgetting_);
       AdvanceTime(plugin_, universal_time, Planetarium.InverseRotAngle);
       ForgetAllHistoriesBefore(
           plugin_,
           universal_time - history_lengths_[history_length_index_]);
       ApplyToBodyTree(body => UpdateBody(body, universal_time));
+      var vessels_to_update = new List<Vessel>();
       ApplyToVesselsOnRailsOrInInertialPhysicsBubbleInSpace(
-          vessel => UpdateVessel(vessel, universal_time));
+          vessels_to_update.Add);
+      UpdateVessels(vessels_to_update, universal_time);
       if (!PhysicsBubbleIsEmpty(plugin_)) {
         Vector3d displacement_offset =
             (Vector3d)BubbleDisplacementCorrection(
@@ -637,18 +717,34 @@ where is_in_physics_bubble(vessel)
         if (rendered_trajectory_ == null || rendered_prediction_ == null) {
           ResetRenderedTrajectory();
         }
+        // The size of a pixel at the distance of the target of the map
+        // camera, in |World| units.  Simplifying the trajectories to that
+        // tolerance doesn't change them visibly.
+        double tolerance =
+            PlanetariumCamera.fetch.Distance * ScaledSpace.ScaleFactor * 2 *
+            Math.Tan(PlanetariumCamera.Camera.fieldOfView * Math.PI / 360) /
+            UnityEngine.Screen.height;
+        // Two rendered points are at least a 1024th of their time distance
+        // from the current time apart, so the parts of the trajectories that
+        // are far in the past or in the future are not rendered in full.
+        double level_of_detail = 1.0 / 1024;
         IntPtr trajectory_iterator = IntPtr.Zero;
         trajectory_iterator = RenderedVesselTrajectory(
                                   plugin_,
                                   active_vessel.id.ToString(),
                                   transforms_,
-                                  (XYZ)Planetarium.fetch.Sun.position);
+                                  (XYZ)Planetarium.fetch.Sun.position,
+                                  tolerance,
+                                  level_of_detail);
         RenderAndDeleteTrajectory(ref trajectory_iterator,
                                   rendered_trajectory_);
         trajectory_iterator = RenderedPrediction(
                                   plugin_,
+                                  active_vessel.id.ToString(),
                                   transforms_,
-                                  (XYZ)Planetarium.fetch.Sun.position);
+                                  (XYZ)Planetarium.fetch.Sun.position,
+                                  tolerance,
+                                  level_of_detail);
         RenderAndDeleteTrajectory(ref trajectory_iterator,
                                   rendered_prediction_);
         if (MapView.Draw3DLines) {
@@ -677,29 +773,33 @@ where is_in_physics_bubble(vessel)
   private void RenderAndDeleteTrajectory(ref IntPtr trajectory_iterator,
                                          VectorLine vector_line) {
     try {
-      LineSegment segment;
       int index_in_line_points = vector_line.points3.Length -
           2 * NumberOfSegments(trajectory_iterator);
       // If the |VectorLine| is too big, make sure we're not keeping garbage.
       for (int i = 0; i < index_in_line_points; ++i) {
         vector_line.points3[i] = UnityEngine.Vector3.zero;
       }
-      while (index_in_line_points < 0) {
-        FetchAndIncrement(trajectory_iterator);
-        index_in_line_points += 2;
-      }
-      while (!AtEnd(trajectory_iterator)) {
-        segment = FetchAndIncrement(trajectory_iterator);
-        // TODO(egg): should we do the |LocalToScaledSpace| conversion in
-        // native code?
-        // TODO(egg): could we directly assign to
-        // |vector_line.points3| from C++ using unsafe code and
-        // something like the following?
-        // |fixed (UnityEngine.Vector3* pts = vector_line.points3)|
-        vector_line.points3[index_in_line_points++] =
-            ScaledSpace.LocalToScaledSpace((Vector3d)segment.begin);
-        vector_line.points3[index_in_line_points++] =
-            ScaledSpace.LocalToScaledSpace((Vector3d)segment.end);
+      for (;;) {
+        int fetched = FetchAndIncrementSegments(trajectory_iterator,
+                                                segment_buffer_,
+                                                segment_buffer_.Length);
+        if (fetched == 0) {
+          break;
+        }
+        for (int i = 0; i < fetched; ++i) {
+          // If the |VectorLine| is too small, drop the oldest segments.
+          if (index_in_line_points < 0) {
+            index_in_line_points += 2;
+            continue;
+          }
+          // TODO(egg): should we do the |LocalToScaledSpace| conversion in
+          // native code?
+          vector_line.points3[index_in_line_points++] =
+              ScaledSpace.LocalToScaledSpace(
+                  (Vector3d)segment_buffer_[i].begin);
+          vector_line.points3[index_in_line_points++] =
+              ScaledSpace.LocalToScaledSpace((Vector3d)segment_buffer_[i].end);
+        }
       }
     } finally {
       DeleteLineAndIterator(ref trajectory_iterator);
@@ -753,8 +853,30 @@ where is_in_physics_bubble(vessel)
     }
   }
 
+  // Must be called when there is no plugin, so that the journal records the
+  // construction or deserialization of the next one.
+  private void StartOrStopJournal() {
+    if (record_journal_) {
+      Log.ActivateJournal("glog/Principia/JOURNAL." +
+                          DateTime.Now.ToString("yyyyMMdd-HHmmss") + ".bin");
+    } else {
+      Log.DeactivateJournal();
+    }
+  }
+
+  private void EnableHistorySpilling() {
+    if (!spill_histories_) {
+      return;
+    }
+    System.IO.Directory.CreateDirectory(history_spill_directory_);
+    EnableHistorySpilling(plugin_,
+                          history_spill_directory_,
+                          kResidentHistoryLength);
+  }
+
   private void Cleanup() {
     DeletePlugin(ref plugin_);
+    vessel_handles_.Clear();
     DeleteTransforms(ref transforms_);
     DestroyRenderedTrajectory();
     navball_changed_ = true;
@@ -817,6 +939,32 @@ where is_in_physics_bubble(vessel)
     if (changed_history_length) {
       ResetRenderedTrajectory();
     }
+    speculative_histories_ =
+        UnityEngine.GUILayout.Toggle(
+            value : speculative_histories_,
+            text  : "Integrate the histories in the background");
+    dense_prolongations_ =
+        UnityEngine.GUILayout.Toggle(
+            value : dense_prolongations_,
+            text  : "Interpolate the trajectories between steps");
+    fast_time_warp_ =
+        UnityEngine.GUILayout.Toggle(
+            value : fast_time_warp_,
+            text  : "Use longer steps under time warp");
+    incremental_forgetting_ =
+        UnityEngine.GUILayout.Toggle(
+            value : incremental_forgetting_,
+            text  : "Free old history points over several frames");
+    bool spill_histories =
+        UnityEngine.GUILayout.Toggle(
+            value : spill_histories_,
+            text  : "Spill old history points to disk");
+    if (spill_histories != spill_histories_) {
+      spill_histories_ = spill_histories;
+      if (PluginRunning()) {
+        EnableHistorySpilling();
+      }
+    }
     ToggleableSection(name   : "Reference Frame Selection",
                       show   : ref show_reference_frame_selection_,
                       render : ReferenceFrameSelection);
@@ -826,6 +974,9 @@ where is_in_physics_bubble(vessel)
     ToggleableSection(name   : "Logging Settings",
                       show   : ref show_logging_settings_,
                       render : LoggingSettings);
+    ToggleableSection(name   : "Profiling",
+                      show   : ref show_profiling_,
+                      render : Profiling);
 #if CRASH_BUTTON
     ToggleableSection(name   : "CRASH",
                       show   : ref show_crash_options_,
@@ -971,6 +1122,14 @@ where is_in_physics_bubble(vessel)
     display_patched_conics_ =
         UnityEngine.GUILayout.Toggle(value : display_patched_conics_,
                                      text  : "Display patched conics");
+    asynchronous_predictions_ =
+        UnityEngine.GUILayout.Toggle(value : asynchronous_predictions_,
+                                     text  : "Compute in the background");
+    if (asynchronous_predictions_ && PluginRunning()) {
+      UnityEngine.GUILayout.Label(
+          text : String.Format("Staleness: {0:0.00e0} s",
+                               prediction_staleness(plugin_)));
+    }
 
     bool changed_settings = false;
     Selector(prediction_step_sizes_,
@@ -992,6 +1151,43 @@ where is_in_physics_bubble(vessel)
     }
   }
 
+  // The phases of |Plugin::AdvanceTime()|, in the order of
+  // |AdvanceTimeProfiler::Phase|.
+  private readonly String[] advance_time_phases_ = {
+      "Clean up vessels",
+      "Prepare bubble",
+      "Evolve histories",
+      "Synchronize vessels",
+      "Reset prolongations",
+      "Evolve prolongations",
+      "Update predictions",
+      "Speculate histories",
+      "Reclaim history points",
+      "Spill history points"};
+
+  private void Profiling() {
+    if (!PluginRunning()) {
+      return;
+    }
+    UnityEngine.GUILayout.Label(
+        text : "AdvanceTime over the last " +
+               AdvanceTimeProfiledFrames(plugin_) + " frames " +
+               "(median / 95th percentile):");
+    for (int phase = 0; phase < advance_time_phases_.Length; ++phase) {
+      PhaseMeasurement median =
+          AdvanceTimePhasePercentile(plugin_, phase, 50);
+      PhaseMeasurement p95 = AdvanceTimePhasePercentile(plugin_, phase, 95);
+      UnityEngine.GUILayout.Label(
+          text : advance_time_phases_[phase] + ": " +
+                 (median.duration * 1e3).ToString("F2") + " / " +
+                 (p95.duration * 1e3).ToString("F2") + " ms, " +
+                 median.force_evaluations + " / " +
+                 p95.force_evaluations + " force evaluations, " +
+                 median.allocations + " / " +
+                 p95.allocations + " allocations");
+    }
+  }
+
   private void LoggingSettings() {
     UnityEngine.GUILayout.BeginHorizontal();
     UnityEngine.GUILayout.Label(text : "Verbose level:");
@@ -1077,6 +1273,10 @@ where is_in_physics_bubble(vessel)
       Log.SetBufferedLogging(Math.Min(Log.GetBufferedLogging() + 1, 3));
     }
     UnityEngine.GUILayout.EndHorizontal();
+    record_journal_ =
+        UnityEngine.GUILayout.Toggle(
+            value : record_journal_,
+            text  : "Record a journal when the plugin is next reset or loaded");
   }
 
   private void ShrinkMainWindow() {
@@ -1104,6 +1304,7 @@ where is_in_physics_bubble(vessel)
 
   private void ResetPlugin() {
     Cleanup();
+    StartOrStopJournal();
     SetRotatingFrameThresholds();
     ResetRenderedTrajectory();
     plugin_construction_ = DateTime.Now;
@@ -1122,6 +1323,7 @@ where is_in_physics_bubble(vessel)
     };
     ApplyToBodyTree(insert_body);
     EndInitialization(plugin_);
+    EnableHistorySpilling();
     UpdateRenderingFrame();
     VesselProcessor insert_vessel = vessel => {
       Log.Info("Inserting " + vessel.name + "...");
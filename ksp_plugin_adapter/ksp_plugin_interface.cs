@@ -55,6 +55,15 @@ struct KSPPart {
     public uint id;
   };
 
+  [StructLayout(LayoutKind.Sequential)]
+  private struct PhaseMeasurement {
+    public double duration;
+    public long steps;
+    public long force_evaluations;
+    public long points_appended;
+    public long allocations;
+  };
+
   // Plugin interface.
 
   [DllImport(dllName           : kDllPath,
@@ -107,6 +116,32 @@ struct KSPPart {
       [MarshalAs(UnmanagedType.LPStr)] String vessel_guid,
       int parent_index);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__InternVesselGUID",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern int InternVesselGUID(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.LPStr)] String vessel_guid);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__InsertOrKeepVesselByHandle",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern bool InsertOrKeepVesselByHandle(
+      IntPtr plugin,
+      int vessel_handle,
+      int parent_index);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__InsertOrKeepVessels",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void InsertOrKeepVessels(
+      IntPtr plugin,
+      int[] vessel_handles,
+      int[] parent_indices,
+      int count,
+      [Out, MarshalAs(UnmanagedType.LPArray,
+                      ArraySubType = UnmanagedType.I1)] bool[] inserted);
+
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__SetVesselStateOffset",
              CallingConvention = CallingConvention.Cdecl)]
@@ -115,6 +150,23 @@ struct KSPPart {
       [MarshalAs(UnmanagedType.LPStr)] String vessel_guid,
       QP from_parent);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__SetVesselStateOffsetByHandle",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void SetVesselStateOffsetByHandle(
+      IntPtr plugin,
+      int vessel_handle,
+      QP from_parent);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__SetVesselStateOffsets",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void SetVesselStateOffsets(
+      IntPtr plugin,
+      int[] vessel_handles,
+      QP[] from_parents,
+      int count);
+
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__AdvanceTime",
              CallingConvention = CallingConvention.Cdecl)]
@@ -129,6 +181,63 @@ struct KSPPart {
   private static extern void ForgetAllHistoriesBefore(IntPtr plugin,
                                                       double t);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__EnableHistorySpilling",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void EnableHistorySpilling(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.LPStr)] String directory,
+      double resident_history_length);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__set_speculative_histories",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void set_speculative_histories(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.I1)] bool speculative);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__set_dense_prolongations",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void set_dense_prolongations(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.I1)] bool dense);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__set_fast_time_warp",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void set_fast_time_warp(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.I1)] bool fast);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__set_incremental_forgetting",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void set_incremental_forgetting(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.I1)] bool incremental);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__AdvanceTimeProfiledFrames",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern int AdvanceTimeProfiledFrames(IntPtr plugin);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__AdvanceTimePhaseMeasurement",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern PhaseMeasurement AdvanceTimePhaseMeasurement(
+      IntPtr plugin,
+      int frame,
+      int phase);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__AdvanceTimePhasePercentile",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern PhaseMeasurement AdvanceTimePhasePercentile(
+      IntPtr plugin,
+      int phase,
+      double percentile);
+
   [DllImport(dllName: kDllPath,
              EntryPoint        = "principia__VesselFromParent",
              CallingConvention = CallingConvention.Cdecl)]
@@ -136,6 +245,20 @@ struct KSPPart {
       IntPtr plugin,
       [MarshalAs(UnmanagedType.LPStr)] String vessel_guid);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__VesselFromParentByHandle",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern QP VesselFromParentByHandle(IntPtr plugin,
+                                                    int vessel_handle);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__VesselsFromParents",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void VesselsFromParents(IntPtr plugin,
+                                                int[] vessel_handles,
+                                                int count,
+                                                [Out] QP[] from_parents);
+
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__CelestialFromParent",
              CallingConvention = CallingConvention.Cdecl)]
@@ -171,15 +294,20 @@ struct KSPPart {
       IntPtr plugin,
       [MarshalAs(UnmanagedType.LPStr)] String vessel_guid,
       IntPtr transforms,
-      XYZ sun_world_position);
+      XYZ sun_world_position,
+      double tolerance,
+      double level_of_detail);
 
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__RenderedPrediction",
              CallingConvention = CallingConvention.Cdecl)]
   private static extern IntPtr RenderedPrediction(
       IntPtr plugin,
+      [MarshalAs(UnmanagedType.LPStr)] String vessel_guid,
       IntPtr transforms,
-      XYZ sun_world_position);
+      XYZ sun_world_position,
+      double tolerance,
+      double level_of_detail);
 
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__NumberOfSegments",
@@ -191,6 +319,14 @@ struct KSPPart {
              CallingConvention = CallingConvention.Cdecl)]
   private static extern LineSegment FetchAndIncrement(IntPtr line);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__FetchAndIncrementSegments",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern int FetchAndIncrementSegments(
+      IntPtr line,
+      [Out] LineSegment[] segments,
+      int count);
+
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__AtEnd",
              CallingConvention = CallingConvention.Cdecl)]
@@ -208,11 +344,32 @@ struct KSPPart {
       IntPtr plugin,
       [MarshalAs(UnmanagedType.LPStr)] String vessel_guid);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__add_predicted_vessel",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void add_predicted_vessel(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.LPStr)] String vessel_guid);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__remove_predicted_vessel",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void remove_predicted_vessel(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.LPStr)] String vessel_guid);
+
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__clear_predicted_vessel",
              CallingConvention = CallingConvention.Cdecl)]
   private static extern void clear_predicted_vessel(IntPtr plugin);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__has_prediction",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern bool has_prediction(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.LPStr)] String vessel_guid);
+
   [DllImport(dllName           : kDllPath,
              EntryPoint        = "principia__set_prediction_length",
              CallingConvention = CallingConvention.Cdecl)]
@@ -223,6 +380,18 @@ struct KSPPart {
              CallingConvention = CallingConvention.Cdecl)]
   private static extern void set_prediction_step(IntPtr plugin, double t);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__set_asynchronous_predictions",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern void set_asynchronous_predictions(
+      IntPtr plugin,
+      [MarshalAs(UnmanagedType.I1)] bool asynchronous);
+
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__prediction_staleness",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern double prediction_staleness(IntPtr plugin);
+
   [DllImport(dllName             : kDllPath,
              EntryPoint =        "principia__has_vessel",
              CallingConvention = CallingConvention.Cdecl)]
@@ -230,6 +399,12 @@ struct KSPPart {
       IntPtr plugin,
       [MarshalAs(UnmanagedType.LPStr)] String vessel_guid);
 
+  [DllImport(dllName           : kDllPath,
+             EntryPoint        = "principia__has_vessel_by_handle",
+             CallingConvention = CallingConvention.Cdecl)]
+  private static extern bool has_vessel_by_handle(IntPtr plugin,
+                                                  int vessel_handle);
+
   [DllImport(dllName: kDllPath,
              EntryPoint        = "principia__AddVesselToNextPhysicsBubble",
              CallingConvention = CallingConvention.Cdecl)]
@@ -88,6 +88,17 @@ internal static class Log {
   internal static extern void Fatal(
       [MarshalAs(UnmanagedType.LPStr)] String message);
 
+  [DllImport(dllName           : PrincipiaPluginAdapter.kDllPath,
+             EntryPoint        = "principia__ActivateJournal",
+             CallingConvention = CallingConvention.Cdecl)]
+  internal static extern void ActivateJournal(
+      [MarshalAs(UnmanagedType.LPStr)] String path);
+
+  [DllImport(dllName           : PrincipiaPluginAdapter.kDllPath,
+             EntryPoint        = "principia__DeactivateJournal",
+             CallingConvention = CallingConvention.Cdecl)]
+  internal static extern void DeactivateJournal();
+
 }
 
 }  // namespace ksp_plugin_adapter
@@ -0,0 +1,124 @@
+#include "ksp_plugin/advance_time_profiler.hpp"
+
+#include "base/not_null.hpp"
+#include "gtest/gtest.h"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using base::not_null;
+using quantities::Time;
+
+namespace ksp_plugin {
+
+class AdvanceTimeProfilerTest : public testing::Test {
+ protected:
+  // Measures a frame in which |kEvolveHistories| records the given counts and
+  // |kUpdatePredictions| records nothing.
+  static void MeasureFrame(std::int64_t const steps,
+                           not_null<AdvanceTimeProfiler*> const profiler) {
+    profiler->StartFrame();
+    profiler->StartPhase(AdvanceTimeProfiler::kEvolveHistories);
+    profiler->RecordIntegration(steps, 2 * steps, 3 * steps, steps / 10);
+    profiler->StartPhase(AdvanceTimeProfiler::kUpdatePredictions);
+    profiler->EndFrame();
+  }
+};
+
+TEST_F(AdvanceTimeProfilerTest, Counters) {
+  AdvanceTimeProfiler profiler(10);
+  EXPECT_EQ(0, profiler.frames());
+
+  profiler.StartFrame();
+  // Nothing is recorded outside of a phase.
+  profiler.RecordIntegration(100, 100, 100, 100);
+  profiler.StartPhase(AdvanceTimeProfiler::kEvolveHistories);
+  profiler.RecordIntegration(1, 4, 1, 0);
+  profiler.StartPhase(AdvanceTimeProfiler::kResetProlongations);
+  profiler.StartPhase(AdvanceTimeProfiler::kEvolveHistories);
+  profiler.RecordIntegration(2, 8, 3, 1);
+  profiler.EndFrame();
+
+  EXPECT_EQ(1, profiler.frames());
+  AdvanceTimeProfiler::Measurement const& histories =
+      profiler.measurement(0, AdvanceTimeProfiler::kEvolveHistories);
+  EXPECT_LE(Time(), histories.duration);
+  EXPECT_EQ(3, histories.steps);
+  EXPECT_EQ(12, histories.force_evaluations);
+  EXPECT_EQ(4, histories.points_appended);
+  EXPECT_EQ(1, histories.allocations);
+  AdvanceTimeProfiler::Measurement const& prolongations =
+      profiler.measurement(0, AdvanceTimeProfiler::kResetProlongations);
+  EXPECT_LE(Time(), prolongations.duration);
+  EXPECT_EQ(0, prolongations.steps);
+  AdvanceTimeProfiler::Measurement const& bubble =
+      profiler.measurement(0, AdvanceTimeProfiler::kPrepareBubble);
+  EXPECT_EQ(Time(), bubble.duration);
+  EXPECT_EQ(0, bubble.steps);
+  EXPECT_EQ(0, bubble.force_evaluations);
+  EXPECT_EQ(0, bubble.points_appended);
+  EXPECT_EQ(0, bubble.allocations);
+}
+
+TEST_F(AdvanceTimeProfilerTest, RingBuffer) {
+  AdvanceTimeProfiler profiler(4);
+  for (int steps = 1; steps <= 6; ++steps) {
+    MeasureFrame(steps, &profiler);
+  }
+  EXPECT_EQ(4, profiler.frames());
+  for (int frame = 0; frame < 4; ++frame) {
+    EXPECT_EQ(6 - frame,
+              profiler.measurement(
+                  frame, AdvanceTimeProfiler::kEvolveHistories).steps);
+  }
+}
+
+TEST_F(AdvanceTimeProfilerTest, Percentiles) {
+  AdvanceTimeProfiler profiler(100);
+  EXPECT_EQ(0,
+            profiler.Percentile(AdvanceTimeProfiler::kEvolveHistories,
+                                50).steps);
+  // Measure the frames out of order.
+  for (int i = 0; i < 100; ++i) {
+    MeasureFrame((37 * i) % 100 + 1, &profiler);
+  }
+  AdvanceTimeProfiler::Measurement const median =
+      profiler.Percentile(AdvanceTimeProfiler::kEvolveHistories, 50);
+  EXPECT_EQ(50, median.steps);
+  EXPECT_EQ(100, median.force_evaluations);
+  EXPECT_EQ(150, median.points_appended);
+  EXPECT_EQ(5, median.allocations);
+  EXPECT_EQ(1,
+            profiler.Percentile(AdvanceTimeProfiler::kEvolveHistories,
+                                0).steps);
+  EXPECT_EQ(95,
+            profiler.Percentile(AdvanceTimeProfiler::kEvolveHistories,
+                                95).steps);
+  EXPECT_EQ(100,
+            profiler.Percentile(AdvanceTimeProfiler::kEvolveHistories,
+                                100).steps);
+  EXPECT_LE(Time(),
+            profiler.Percentile(AdvanceTimeProfiler::kUpdatePredictions,
+                                95).duration);
+}
+
+using AdvanceTimeProfilerDeathTest = AdvanceTimeProfilerTest;
+
+TEST_F(AdvanceTimeProfilerDeathTest, Errors) {
+  EXPECT_DEATH({
+    AdvanceTimeProfiler profiler(1);
+    profiler.StartPhase(AdvanceTimeProfiler::kEvolveHistories);
+  }, "frame_in_progress_");
+  EXPECT_DEATH({
+    AdvanceTimeProfiler profiler(1);
+    profiler.StartFrame();
+    profiler.StartFrame();
+  }, "!frame_in_progress_");
+  EXPECT_DEATH({
+    AdvanceTimeProfiler profiler(1);
+    profiler.measurement(0, AdvanceTimeProfiler::kEvolveHistories);
+  }, "Check failed");
+}
+
+}  // namespace ksp_plugin
+}  // namespace principia
@@ -32,6 +32,7 @@ using ::testing::Pointee;
 using ::testing::Property;
 using ::testing::Ref;
 using ::testing::Return;
+using ::testing::ReturnRef;
 using ::testing::SetArgPointee;
 using ::testing::StrictMock;
 using ::testing::_;
@@ -75,6 +76,8 @@ Index const kParentIndex = 2;
 double const kGravitationalParameter = 3;
 double const kPlanetariumRotation = 10;
 double const kTime = 11;
+double const kTolerance = 12;
+double const kLevelOfDetail = 1.0 / 1024;
 
 XYZ kParentPosition = {4, 5, 6};
 XYZ kParentVelocity = {7, 8, 9};
@@ -225,6 +228,93 @@ TEST_F(InterfaceTest, InsertOrKeepVessel) {
   EXPECT_TRUE(plugin_->has_vessel(kVesselGUID));
 }
 
+TEST_F(InterfaceTest, VesselHandles) {
+  VesselHandle const vessel_handle = 42;
+  EXPECT_CALL(*plugin_, InternVesselGUID(kVesselGUID))
+      .WillOnce(Return(vessel_handle));
+  EXPECT_CALL(*plugin_,
+              InsertOrKeepVesselByHandle(vessel_handle, kParentIndex))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*plugin_, has_vessel_by_handle(vessel_handle))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*plugin_,
+              SetVesselStateOffsetByHandle(
+                  vessel_handle,
+                  RelativeDegreesOfFreedom<AliceSun>(
+                      Displacement<AliceSun>(
+                          {kParentPosition.x * SIUnit<Length>(),
+                           kParentPosition.y * SIUnit<Length>(),
+                           kParentPosition.z * SIUnit<Length>()}),
+                      Velocity<AliceSun>(
+                          {kParentVelocity.x * SIUnit<Speed>(),
+                           kParentVelocity.y * SIUnit<Speed>(),
+                           kParentVelocity.z * SIUnit<Speed>()}))));
+  EXPECT_CALL(*plugin_, VesselFromParentByHandle(vessel_handle))
+      .WillOnce(Return(RelativeDegreesOfFreedom<AliceSun>(
+                           Displacement<AliceSun>(
+                               {kParentPosition.x * SIUnit<Length>(),
+                                kParentPosition.y * SIUnit<Length>(),
+                                kParentPosition.z * SIUnit<Length>()}),
+                           Velocity<AliceSun>(
+                               {kParentVelocity.x * SIUnit<Speed>(),
+                                kParentVelocity.y * SIUnit<Speed>(),
+                                kParentVelocity.z * SIUnit<Speed>()}))));
+  EXPECT_EQ(vessel_handle,
+            principia__InternVesselGUID(plugin_.get(), kVesselGUID));
+  EXPECT_TRUE(principia__InsertOrKeepVesselByHandle(plugin_.get(),
+                                                    vessel_handle,
+                                                    kParentIndex));
+  EXPECT_TRUE(principia__has_vessel_by_handle(plugin_.get(), vessel_handle));
+  principia__SetVesselStateOffsetByHandle(plugin_.get(),
+                                          vessel_handle,
+                                          kParentRelativeDegreesOfFreedom);
+  EXPECT_THAT(principia__VesselFromParentByHandle(plugin_.get(),
+                                                  vessel_handle),
+              Eq(kParentRelativeDegreesOfFreedom));
+}
+
+TEST_F(InterfaceTest, BatchedVesselUpdates) {
+  RelativeDegreesOfFreedom<AliceSun> const relative(
+      Displacement<AliceSun>({kParentPosition.x * SIUnit<Length>(),
+                              kParentPosition.y * SIUnit<Length>(),
+                              kParentPosition.z * SIUnit<Length>()}),
+      Velocity<AliceSun>({kParentVelocity.x * SIUnit<Speed>(),
+                          kParentVelocity.y * SIUnit<Speed>(),
+                          kParentVelocity.z * SIUnit<Speed>()}));
+  int const vessel_handles[] = {3, 1};
+  int const parent_indices[] = {kParentIndex, kCelestialIndex};
+  bool inserted[] = {false, false};
+  EXPECT_CALL(*plugin_, InsertOrKeepVesselByHandle(3, kParentIndex))
+      .WillOnce(Return(true));
+  EXPECT_CALL(*plugin_, InsertOrKeepVesselByHandle(1, kCelestialIndex))
+      .WillOnce(Return(false));
+  principia__InsertOrKeepVessels(plugin_.get(),
+                                 vessel_handles,
+                                 parent_indices,
+                                 2,
+                                 inserted);
+  EXPECT_THAT(inserted, ElementsAre(true, false));
+
+  EXPECT_CALL(*plugin_, SetVesselStateOffsetByHandle(3, relative));
+  principia__SetVesselStateOffsets(plugin_.get(),
+                                   vessel_handles,
+                                   &kParentRelativeDegreesOfFreedom,
+                                   1);
+
+  QP from_parents[2];
+  EXPECT_CALL(*plugin_, VesselFromParentByHandle(3))
+      .WillOnce(Return(relative));
+  EXPECT_CALL(*plugin_, VesselFromParentByHandle(1))
+      .WillOnce(Return(relative));
+  principia__VesselsFromParents(plugin_.get(),
+                                vessel_handles,
+                                2,
+                                from_parents);
+  EXPECT_THAT(from_parents,
+              ElementsAre(Eq(kParentRelativeDegreesOfFreedom),
+                          Eq(kParentRelativeDegreesOfFreedom)));
+}
+
 TEST_F(InterfaceTest, SetVesselStateOffset) {
   EXPECT_CALL(*plugin_,
               SetVesselStateOffset(
@@ -256,6 +346,69 @@ TEST_F(InterfaceTest, ForgetAllHistoriesBefore) {
   principia__ForgetAllHistoriesBefore(plugin_.get(), kTime);
 }
 
+TEST_F(InterfaceTest, SpillAllHistoriesBefore) {
+  EXPECT_CALL(*plugin_,
+              SpillAllHistoriesBefore(Instant(kTime * SIUnit<Time>()),
+                                      "spill directory"));
+  principia__SpillAllHistoriesBefore(plugin_.get(), kTime, "spill directory");
+}
+
+TEST_F(InterfaceTest, EnableHistorySpilling) {
+  EXPECT_CALL(*plugin_,
+              EnableHistorySpilling("spill directory", 3 * SIUnit<Time>()));
+  principia__EnableHistorySpilling(plugin_.get(), "spill directory", 3);
+}
+
+TEST_F(InterfaceTest, SetSpeculativeHistories) {
+  EXPECT_CALL(*plugin_, set_speculative_histories(true));
+  principia__set_speculative_histories(plugin_.get(), true);
+}
+
+TEST_F(InterfaceTest, SetDenseProlongations) {
+  EXPECT_CALL(*plugin_, set_dense_prolongations(true));
+  principia__set_dense_prolongations(plugin_.get(), true);
+}
+
+TEST_F(InterfaceTest, SetFastTimeWarp) {
+  EXPECT_CALL(*plugin_, set_fast_time_warp(true));
+  principia__set_fast_time_warp(plugin_.get(), true);
+}
+
+TEST_F(InterfaceTest, SetIncrementalForgetting) {
+  EXPECT_CALL(*plugin_, set_incremental_forgetting(true));
+  principia__set_incremental_forgetting(plugin_.get(), true);
+}
+
+TEST_F(InterfaceTest, AdvanceTimeProfiler) {
+  AdvanceTimeProfiler profiler(10);
+  for (int steps = 1; steps <= 2; ++steps) {
+    profiler.StartFrame();
+    profiler.StartPhase(AdvanceTimeProfiler::kEvolveHistories);
+    profiler.RecordIntegration(steps, 6 * steps, 3 * steps, steps - 1);
+    profiler.EndFrame();
+  }
+  EXPECT_CALL(*plugin_, advance_time_profiler())
+      .WillRepeatedly(ReturnRef(profiler));
+  EXPECT_EQ(2, principia__AdvanceTimeProfiledFrames(plugin_.get()));
+  PhaseMeasurement const last = principia__AdvanceTimePhaseMeasurement(
+      plugin_.get(),
+      0,
+      AdvanceTimeProfiler::kEvolveHistories);
+  EXPECT_LE(0, last.duration);
+  EXPECT_EQ(2, last.steps);
+  EXPECT_EQ(12, last.force_evaluations);
+  EXPECT_EQ(6, last.points_appended);
+  EXPECT_EQ(1, last.allocations);
+  PhaseMeasurement const median = principia__AdvanceTimePhasePercentile(
+      plugin_.get(),
+      AdvanceTimeProfiler::kEvolveHistories,
+      50);
+  EXPECT_EQ(1, median.steps);
+  EXPECT_EQ(6, median.force_evaluations);
+  EXPECT_EQ(3, median.points_appended);
+  EXPECT_EQ(0, median.allocations);
+}
+
 TEST_F(InterfaceTest, VesselFromParent) {
   EXPECT_CALL(*plugin_,
               VesselFromParent(kVesselGUID))
@@ -331,6 +484,18 @@ TEST_F(InterfaceTest, DeleteTransforms) {
   EXPECT_THAT(transforms, IsNull());
 }
 
+TEST_F(InterfaceTest, TransformsCacheStatistics) {
+  RenderingTransforms* transforms =
+      RenderingTransforms::DummyForTesting().release();
+  CacheStatistics const statistics =
+      principia__TransformsCacheStatistics(transforms);
+  EXPECT_EQ(0, statistics.hits);
+  EXPECT_EQ(0, statistics.misses);
+  EXPECT_EQ(0, statistics.evictions);
+  principia__DeleteTransforms(&transforms);
+  EXPECT_THAT(transforms, IsNull());
+}
+
 TEST_F(InterfaceTest, RenderedPrediction) {
   auto dummy_transforms = RenderingTransforms::DummyForTesting().release();
   EXPECT_CALL(*plugin_,
@@ -361,16 +526,22 @@ TEST_F(InterfaceTest, RenderedPrediction) {
 
   EXPECT_CALL(*plugin_,
               RenderedPrediction(
+                  kVesselGUID,
                   check_not_null(transforms),
                   World::origin + Displacement<World>(
                                       {kParentPosition.x * SIUnit<Length>(),
                                        kParentPosition.y * SIUnit<Length>(),
-                                       kParentPosition.z * SIUnit<Length>()})))
+                                       kParentPosition.z * SIUnit<Length>()}),
+                  kTolerance * SIUnit<Length>(),
+                  kLevelOfDetail))
       .WillOnce(Return(rendered_trajectory));
   LineAndIterator* line_and_iterator =
       principia__RenderedPrediction(plugin_.get(),
+                                    kVesselGUID,
                                     transforms,
-                                    kParentPosition);
+                                    kParentPosition,
+                                    kTolerance,
+                                    kLevelOfDetail);
   EXPECT_EQ(kTrajectorySize, line_and_iterator->rendered_trajectory.size());
   EXPECT_EQ(kTrajectorySize, principia__NumberOfSegments(line_and_iterator));
 
@@ -433,13 +604,17 @@ TEST_F(InterfaceTest, LineAndIterator) {
                   World::origin + Displacement<World>(
                                       {kParentPosition.x * SIUnit<Length>(),
                                        kParentPosition.y * SIUnit<Length>(),
-                                       kParentPosition.z * SIUnit<Length>()})))
+                                       kParentPosition.z * SIUnit<Length>()}),
+                  kTolerance * SIUnit<Length>(),
+                  kLevelOfDetail))
       .WillOnce(Return(rendered_trajectory));
   LineAndIterator* line_and_iterator =
       principia__RenderedVesselTrajectory(plugin_.get(),
                                           kVesselGUID,
                                           transforms,
-                                          kParentPosition);
+                                          kParentPosition,
+                                          kTolerance,
+                                          kLevelOfDetail);
   EXPECT_EQ(kTrajectorySize, line_and_iterator->rendered_trajectory.size());
   EXPECT_EQ(kTrajectorySize, principia__NumberOfSegments(line_and_iterator));
 
@@ -465,15 +640,63 @@ TEST_F(InterfaceTest, LineAndIterator) {
   EXPECT_THAT(transforms, IsNull());
 }
 
+TEST_F(InterfaceTest, FetchAndIncrementSegments) {
+  RenderedTrajectory<World> rendered_trajectory;
+  Position<World> position = World::origin;
+  for (int i = 0; i < kTrajectorySize; ++i) {
+    Position<World> next_position =
+        position + Displacement<World>({1 * SIUnit<Length>(),
+                                        2 * SIUnit<Length>(),
+                                        3 * SIUnit<Length>()});
+    rendered_trajectory.emplace_back(position, next_position);
+    position = next_position;
+  }
+  LineAndIterator* line_and_iterator =
+      new LineAndIterator(std::move(rendered_trajectory));
+  line_and_iterator->it = line_and_iterator->rendered_trajectory.begin();
+
+  // Fetch the segments in batches of 4: the last batch is incomplete.
+  XYZSegment segments[4];
+  int i = 0;
+  for (int fetched;
+       (fetched = principia__FetchAndIncrementSegments(line_and_iterator,
+                                                       segments,
+                                                       4)) > 0;) {
+    EXPECT_EQ(std::min(4, kTrajectorySize - i), fetched);
+    for (int j = 0; j < fetched; ++j, ++i) {
+      EXPECT_EQ(1 * i, segments[j].begin.x);
+      EXPECT_EQ(2 * i, segments[j].begin.y);
+      EXPECT_EQ(3 * i, segments[j].begin.z);
+      EXPECT_EQ(1 * (i + 1), segments[j].end.x);
+      EXPECT_EQ(2 * (i + 1), segments[j].end.y);
+      EXPECT_EQ(3 * (i + 1), segments[j].end.z);
+    }
+  }
+  EXPECT_EQ(kTrajectorySize, i);
+  EXPECT_TRUE(principia__AtEnd(line_and_iterator));
+  principia__DeleteLineAndIterator(&line_and_iterator);
+  EXPECT_THAT(line_and_iterator, IsNull());
+}
+
 TEST_F(InterfaceTest, PredictionGettersAndSetters) {
   EXPECT_CALL(*plugin_, set_predicted_vessel(kVesselGUID));
   principia__set_predicted_vessel(plugin_.get(), kVesselGUID);
+  EXPECT_CALL(*plugin_, add_predicted_vessel(kVesselGUID));
+  principia__add_predicted_vessel(plugin_.get(), kVesselGUID);
+  EXPECT_CALL(*plugin_, has_prediction(kVesselGUID)).WillOnce(Return(true));
+  EXPECT_TRUE(principia__has_prediction(plugin_.get(), kVesselGUID));
+  EXPECT_CALL(*plugin_, remove_predicted_vessel(kVesselGUID));
+  principia__remove_predicted_vessel(plugin_.get(), kVesselGUID);
   EXPECT_CALL(*plugin_, clear_predicted_vessel());
   principia__clear_predicted_vessel(plugin_.get());
   EXPECT_CALL(*plugin_, set_prediction_length(42 * Second));
   principia__set_prediction_length(plugin_.get(), 42);
   EXPECT_CALL(*plugin_, set_prediction_step(20 * Milli(Second)));
   principia__set_prediction_step(plugin_.get(), 0.02);
+  EXPECT_CALL(*plugin_, set_asynchronous_predictions(true));
+  principia__set_asynchronous_predictions(plugin_.get(), true);
+  EXPECT_CALL(*plugin_, prediction_staleness()).WillOnce(Return(3 * Second));
+  EXPECT_EQ(3, principia__prediction_staleness(plugin_.get()));
 }
 
 TEST_F(InterfaceTest, PhysicsBubble) {
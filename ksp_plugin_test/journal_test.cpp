@@ -0,0 +1,147 @@
+#include "ksp_plugin/journal.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "ksp_plugin/interface.hpp"
+#include "ksp_plugin/journal_player.hpp"
+
+namespace principia {
+namespace ksp_plugin {
+
+class JournalTest : public testing::Test {
+ protected:
+  JournalTest() : path_("journal_test.bin") {}
+
+  ~JournalTest() override {
+    Journal::Deactivate();
+    std::remove(path_.c_str());
+  }
+
+  std::string const path_;
+};
+
+TEST_F(JournalTest, Entries) {
+  Journal::Activate(path_);
+  {
+    Journal::Entry entry(Journal::kInsertOrKeepVessels);
+    entry.WritePointer(this);
+    int const handles[] = {3, 1, 4};
+    entry.WriteArray(handles, 3);
+    entry.WriteString("guid");
+    entry.Write(QP{{1, 2, 3}, {4, 5, 6}});
+    entry.Write(true);
+  }
+  {
+    Journal::Entry entry(Journal::kSayHello);
+  }
+  Journal::Deactivate();
+  {
+    // Not recorded.
+    Journal::Entry entry(Journal::kAdvanceTime);
+    entry.Write(1.0);
+  }
+
+  Journal::Reader reader(path_);
+  ASSERT_TRUE(reader.ReadEntry());
+  EXPECT_EQ(Journal::kInsertOrKeepVessels, reader.method());
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(this), reader.ReadPointer());
+  EXPECT_THAT(reader.ReadArray<int>(), testing::ElementsAre(3, 1, 4));
+  EXPECT_EQ("guid", reader.ReadString());
+  QP const qp = reader.Read<QP>();
+  EXPECT_EQ(1, qp.q.x);
+  EXPECT_EQ(6, qp.p.z);
+  EXPECT_FALSE(reader.AtEndOfEntry());
+  EXPECT_TRUE(reader.Read<bool>());
+  EXPECT_TRUE(reader.AtEndOfEntry());
+  ASSERT_TRUE(reader.ReadEntry());
+  EXPECT_EQ(Journal::kSayHello, reader.method());
+  EXPECT_TRUE(reader.AtEndOfEntry());
+  EXPECT_FALSE(reader.ReadEntry());
+}
+
+// Records a session through the C interface and replays it.
+TEST_F(JournalTest, RecordAndReplay) {
+  principia__ActivateJournal(path_.c_str());
+  Plugin* plugin = principia__NewPlugin(0 /*initial_time*/,
+                                        0 /*sun_index*/,
+                                        1.32712440018E20,
+                                        0 /*planetarium_rotation*/);
+  principia__InsertCelestial(plugin,
+                             1,
+                             3.986004418E14,
+                             0,
+                             {{1.5E11, 0, 0}, {0, 3E4, 0}});
+  principia__EndInitialization(plugin);
+  int const handle = principia__InternVesselGUID(plugin, "vessel");
+  int const parent = 1;
+  bool inserted;
+  principia__InsertOrKeepVessels(plugin, &handle, &parent, 1, &inserted);
+  EXPECT_TRUE(inserted);
+  QP const from_parent = {{7E6, 0, 0}, {0, 7.5E3, 0}};
+  principia__SetVesselStateOffsets(plugin, &handle, &from_parent, 1);
+  principia__AdvanceTime(plugin, 10, 0);
+  principia__InsertOrKeepVessels(plugin, &handle, &parent, 1, &inserted);
+  EXPECT_FALSE(inserted);
+  principia__AdvanceTime(plugin, 20, 0);
+  RenderingTransforms* transforms =
+      principia__NewBodyCentredNonRotatingTransforms(plugin, 1);
+  LineAndIterator* line_and_iterator = principia__RenderedVesselTrajectory(
+      plugin, "vessel", transforms, {0, 0, 0}, 1 /*tolerance*/,
+      0 /*level_of_detail*/);
+  int const number_of_segments = principia__NumberOfSegments(line_and_iterator);
+  std::vector<XYZSegment> segments(number_of_segments + 1);
+  EXPECT_EQ(number_of_segments,
+            principia__FetchAndIncrementSegments(line_and_iterator,
+                                                 segments.data(),
+                                                 number_of_segments + 1));
+  EXPECT_TRUE(principia__AtEnd(line_and_iterator));
+  principia__DeleteLineAndIterator(&line_and_iterator);
+  principia__DeleteTransforms(&transforms);
+
+  // Round-trip the plugin through its serialization.
+  PullSerializer* serializer = nullptr;
+  PushDeserializer* deserializer = nullptr;
+  Plugin const* deserialized_plugin = nullptr;
+  int chunks = 0;
+  for (;;) {
+    char const* serialization =
+        principia__SerializePlugin(plugin, &serializer);
+    if (serialization == nullptr) {
+      break;
+    }
+    ++chunks;
+    principia__DeserializePlugin(serialization,
+                                 static_cast<int>(std::strlen(serialization)),
+                                 &deserializer,
+                                 &deserialized_plugin);
+    principia__DeletePluginSerialization(&serialization);
+  }
+  principia__DeserializePlugin("", 0, &deserializer, &deserialized_plugin);
+  EXPECT_EQ(20, principia__current_time(deserialized_plugin));
+  Plugin const* const_plugin = plugin;
+  principia__DeletePlugin(&const_plugin);
+  principia__AdvanceTime(const_cast<Plugin*>(deserialized_plugin), 30, 0);
+  principia__DeletePlugin(&deserialized_plugin);
+  principia__DeactivateJournal();
+
+  JournalPlayer player(path_);
+  while (player.Play()) {}
+  EXPECT_EQ(22 + 3 * chunks, player.calls());
+  EXPECT_EQ(3, player.latencies(Journal::kAdvanceTime).size());
+  EXPECT_EQ(2, player.latencies(Journal::kDeletePlugin).size());
+  EXPECT_EQ(1, player.latencies(Journal::kRenderedVesselTrajectory).size());
+  EXPECT_EQ(player.latencies(Journal::kSerializePlugin).size(),
+            player.latencies(Journal::kDeserializePlugin).size());
+  for (Time const& latency : player.latencies(Journal::kAdvanceTime)) {
+    EXPECT_LE(Time(), latency);
+  }
+  EXPECT_TRUE(player.latencies(Journal::kSayHello).empty());
+}
+
+}  // namespace ksp_plugin
+}  // namespace principia
@@ -3,9 +3,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <limits>
 #include <map>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -22,6 +24,7 @@
 namespace principia {
 
 using geometry::Bivector;
+using geometry::InnerProduct;
 using geometry::Permutation;
 using geometry::Trivector;
 using physics::MockNBodySystem;
@@ -107,6 +110,34 @@ class TestablePlugin : public Plugin {
     n_body_system_.reset(n_body_system);
   }
 
+  // Uses an actual |NBodySystem|.
+  TestablePlugin(Instant const& initial_time,
+                 Index const sun_index,
+                 GravitationalParameter const& sun_gravitational_parameter,
+                 Angle const& planetarium_rotation)
+      : Plugin(initial_time,
+               sun_index,
+               sun_gravitational_parameter,
+               planetarium_rotation) {}
+
+  // Blocks until the integration of the speculative histories started by the
+  // last call to |AdvanceTime()|, if any, has completed.  The next call to
+  // |AdvanceTime()| will then commit them.
+  void WaitForSpeculativeHistories() {
+    if (speculative_histories_integrated_.valid()) {
+      speculative_histories_integrated_.wait();
+    }
+  }
+
+  // Blocks until the integration of the prediction started by the last call
+  // to |AdvanceTime()|, if any, has completed.  The next call to
+  // |AdvanceTime()| will then use it.
+  void WaitForPendingPrediction() {
+    if (pending_prediction_integrated_.valid()) {
+      pending_prediction_integrated_.wait();
+    }
+  }
+
   Time const& Δt() const {
     return Δt_;
   }
@@ -118,8 +149,23 @@ class TestablePlugin : public Plugin {
   SRKNIntegrator const& history_integrator() const {
     return *history_integrator_;
   }
+
+  Trajectory<Barycentric> const& vessel_history(GUID const& vessel_guid) const {
+    return find_vessel_by_guid_or_die(vessel_guid)->history();
+  }
 };
 
+// Returns a directory where the tests may create files.
+std::string TemporaryDirectory() {
+  for (char const* const variable : {"TEST_TMPDIR", "TMPDIR", "TEMP", "TMP"}) {
+    char const* const directory = std::getenv(variable);
+    if (directory != nullptr) {
+      return directory;
+    }
+  }
+  return "/tmp";
+}
+
 class PluginTest : public testing::Test {
  protected:
   PluginTest()
@@ -294,6 +340,168 @@ TEST_F(PluginTest, Serialization) {
   EXPECT_FALSE(message.bubble().has_current());
 }
 
+// Checks that the points spilled by |SpillAllHistoriesBefore()| leave the
+// memory but remain part of the serialized plugin.
+TEST_F(PluginTest, SpillAllHistoriesBefore) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  TestablePlugin plugin(Instant(),
+                        celestial,
+                        SIUnit<GravitationalParameter>(),
+                        0 * Radian);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({1000 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>({0 * Metre / Second,
+                           Sqrt(1e-3) * Metre / Second,
+                           0 * Metre / Second})});
+  for (int i = 1; i <= 10; ++i) {
+    plugin.InsertOrKeepVessel(satellite, celestial);
+    plugin.AdvanceTime(Instant() + i * 10 * Second, 0 * Radian);
+  }
+  Trajectory<Barycentric> const& history = plugin.vessel_history(satellite);
+  std::int64_t const resident_points = history.resident_points();
+  EXPECT_EQ(0, history.spilled_points());
+
+  serialization::Plugin unspilled_message;
+  plugin.WriteToMessage(&unspilled_message);
+  plugin.SpillAllHistoriesBefore(Instant() + 50 * Second,
+                                 TemporaryDirectory());
+  EXPECT_LT(0, history.spilled_points());
+  EXPECT_EQ(resident_points,
+            history.resident_points() + history.spilled_points());
+  serialization::Plugin spilled_message;
+  plugin.WriteToMessage(&spilled_message);
+  EXPECT_EQ(unspilled_message.SerializeAsString(),
+            spilled_message.SerializeAsString());
+}
+
+// Checks that |AdvanceTime()| keeps the resident histories short once spilling
+// is enabled, and that the spilled points are still part of the serialized
+// plugin, including for a vessel that was removed and inserted again with the
+// same GUID.
+TEST_F(PluginTest, HistorySpilling) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  TestablePlugin resident_plugin(Instant(),
+                                 celestial,
+                                 SIUnit<GravitationalParameter>(),
+                                 0 * Radian);
+  TestablePlugin spilling_plugin(Instant(),
+                                 celestial,
+                                 SIUnit<GravitationalParameter>(),
+                                 0 * Radian);
+  spilling_plugin.EnableHistorySpilling(TemporaryDirectory(), 100 * Second);
+  RelativeDegreesOfFreedom<AliceSun> const circular_orbit(
+      Displacement<AliceSun>({1000 * Metre, 0 * Metre, 0 * Metre}),
+      Velocity<AliceSun>({0 * Metre / Second,
+                          Sqrt(1e-3) * Metre / Second,
+                          0 * Metre / Second}));
+  for (TestablePlugin* const plugin : {&resident_plugin, &spilling_plugin}) {
+    plugin->EndInitialization();
+    EXPECT_TRUE(plugin->InsertOrKeepVessel(satellite, celestial));
+    plugin->SetVesselStateOffset(satellite, circular_orbit);
+    for (int i = 1; i <= 100; ++i) {
+      // The vessel is removed at the 50th frame and inserted again at the
+      // next.
+      if (i != 50 && plugin->InsertOrKeepVessel(satellite, celestial)) {
+        plugin->SetVesselStateOffset(satellite, circular_orbit);
+      }
+      plugin->AdvanceTime(Instant() + i * 10 * Second, 0 * Radian);
+    }
+  }
+
+  serialization::Plugin resident_message;
+  resident_plugin.WriteToMessage(&resident_message);
+  serialization::Plugin spilling_message;
+  spilling_plugin.WriteToMessage(&spilling_message);
+  EXPECT_EQ(resident_message.SerializeAsString(),
+            spilling_message.SerializeAsString());
+  EXPECT_THAT(spilling_message.vessel(0).vessel().history_and_prolongation().
+                  history().timeline_size(),
+              Gt(10));
+
+  // The vessel was inserted again at 510 s, and only the points of the last
+  // 100 s are kept in memory.
+  Trajectory<Barycentric> const& resident_history =
+      resident_plugin.vessel_history(satellite);
+  Trajectory<Barycentric> const& spilling_history =
+      spilling_plugin.vessel_history(satellite);
+  EXPECT_EQ(0, resident_history.spilled_points());
+  EXPECT_LT(0, spilling_history.spilled_points());
+  EXPECT_GE(11, spilling_history.resident_points());
+  EXPECT_EQ(resident_history.resident_points(),
+            spilling_history.resident_points() +
+                spilling_history.spilled_points());
+}
+
+// Checks that incremental forgetting frees the detached points over a few
+// frames, and that it ends up with the same histories as the synchronous
+// forgetting.
+TEST_F(PluginTest, IncrementalForgetting) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  TestablePlugin synchronous_plugin(Instant(),
+                                    celestial,
+                                    SIUnit<GravitationalParameter>(),
+                                    0 * Radian);
+  TestablePlugin incremental_plugin(Instant(),
+                                    celestial,
+                                    SIUnit<GravitationalParameter>(),
+                                    0 * Radian);
+  incremental_plugin.set_incremental_forgetting(true);
+  RelativeDegreesOfFreedom<AliceSun> const circular_orbit(
+      Displacement<AliceSun>({1000 * Metre, 0 * Metre, 0 * Metre}),
+      Velocity<AliceSun>({0 * Metre / Second,
+                          Sqrt(1e-3) * Metre / Second,
+                          0 * Metre / Second}));
+  // The histories get about 6000 points each, more in total than can be freed
+  // in a frame.
+  for (TestablePlugin* const plugin :
+           {&synchronous_plugin, &incremental_plugin}) {
+    plugin->EndInitialization();
+    EXPECT_TRUE(plugin->InsertOrKeepVessel(satellite, celestial));
+    plugin->SetVesselStateOffset(satellite, circular_orbit);
+    for (int i = 1; i <= 12000; ++i) {
+      plugin->InsertOrKeepVessel(satellite, celestial);
+      plugin->AdvanceTime(Instant() + i * 10 * Second, 0 * Radian);
+    }
+    plugin->ForgetAllHistoriesBefore(Instant() + 119000 * Second);
+  }
+
+  Trajectory<Barycentric> const& synchronous_history =
+      synchronous_plugin.vessel_history(satellite);
+  Trajectory<Barycentric> const& incremental_history =
+      incremental_plugin.vessel_history(satellite);
+  std::int64_t const resident_points = synchronous_history.resident_points();
+  EXPECT_GE(101, resident_points);
+  EXPECT_LT(5000, incremental_history.resident_points());
+
+  // The points are freed over a few frames.
+  int frames = 0;
+  for (; incremental_history.resident_points() > resident_points; ++frames) {
+    ASSERT_GT(10, frames);
+    for (TestablePlugin* const plugin :
+             {&synchronous_plugin, &incremental_plugin}) {
+      EXPECT_FALSE(plugin->InsertOrKeepVessel(satellite, celestial));
+      plugin->AdvanceTime(plugin->current_time() + 1 * Second, 0 * Radian);
+    }
+  }
+  EXPECT_LT(1, frames);
+  EXPECT_EQ(resident_points, incremental_history.resident_points());
+  EXPECT_GE(synchronous_history.reserved_bytes(),
+            incremental_history.reserved_bytes());
+
+  serialization::Plugin synchronous_message;
+  synchronous_plugin.WriteToMessage(&synchronous_message);
+  serialization::Plugin incremental_message;
+  incremental_plugin.WriteToMessage(&incremental_message);
+  EXPECT_EQ(synchronous_message.SerializeAsString(),
+            incremental_message.SerializeAsString());
+}
+
 TEST_F(PluginTest, Initialization) {
   InsertAllSolarSystemBodies();
   plugin_->EndInitialization();
@@ -478,6 +686,43 @@ TEST_F(PluginTest, VesselInsertionAtInitialization) {
                   AlmostEquals(satellite_initial_velocity_, 3)));
 }
 
+TEST_F(PluginTest, VesselHandles) {
+  GUID const guid = "Test Satellite";
+  InsertAllSolarSystemBodies();
+  plugin_->EndInitialization();
+  VesselHandle const handle = plugin_->InternVesselGUID(guid);
+  EXPECT_EQ(handle, plugin_->InternVesselGUID(guid));
+  EXPECT_NE(handle, plugin_->InternVesselGUID("Another Satellite"));
+  EXPECT_FALSE(plugin_->has_vessel_by_handle(handle));
+
+  EXPECT_TRUE(plugin_->InsertOrKeepVesselByHandle(handle,
+                                                  SolarSystem::kEarth));
+  EXPECT_TRUE(plugin_->has_vessel_by_handle(handle));
+  EXPECT_TRUE(plugin_->has_vessel(guid));
+  EXPECT_FALSE(plugin_->InsertOrKeepVessel(guid, SolarSystem::kEarth));
+  plugin_->SetVesselStateOffsetByHandle(handle,
+                                        RelativeDegreesOfFreedom<AliceSun>(
+                                            satellite_initial_displacement_,
+                                            satellite_initial_velocity_));
+  EXPECT_THAT(plugin_->VesselFromParentByHandle(handle),
+              Componentwise(
+                  AlmostEquals(satellite_initial_displacement_, 7460),
+                  AlmostEquals(satellite_initial_velocity_, 3)));
+  EXPECT_EQ(plugin_->VesselFromParent(guid),
+            plugin_->VesselFromParentByHandle(handle));
+
+  // The vessel is not kept after the first call to |AdvanceTime|, so it is
+  // removed by the second one, but its handle remains valid.
+  plugin_->AdvanceTime(initial_time_ + 1 * Second, Angle());
+  EXPECT_TRUE(plugin_->has_vessel_by_handle(handle));
+  plugin_->AdvanceTime(initial_time_ + 2 * Second, Angle());
+  EXPECT_FALSE(plugin_->has_vessel_by_handle(handle));
+  EXPECT_FALSE(plugin_->has_vessel(guid));
+  EXPECT_TRUE(plugin_->InsertOrKeepVessel(guid, SolarSystem::kEarth));
+  EXPECT_TRUE(plugin_->has_vessel_by_handle(handle));
+  EXPECT_EQ(handle, plugin_->InternVesselGUID(guid));
+}
+
 // Checks that the plugin correctly uses its 10-second-step history even when
 // advanced with smaller timesteps.
 TEST_F(PluginTest, AdvanceTimeWithCelestialsOnly) {
@@ -963,7 +1208,9 @@ TEST_F(PluginTest, BodyCentredNonrotatingRenderingIntegration) {
     RenderedTrajectory<World> const rendered_trajectory =
         plugin.RenderedVesselTrajectory(satellite,
                                         geocentric.get(),
-                                        sun_world_position);
+                                        sun_world_position,
+                                        0 * Metre,
+                                        0);
     Position<World> const earth_world_position =
         sun_world_position + alice_sun_to_world(
             plugin.CelestialFromParent(SolarSystem::kEarth).displacement());
@@ -1069,7 +1316,9 @@ TEST_F(PluginTest, BarycentricRotatingRenderingIntegration) {
   RenderedTrajectory<World> const rendered_trajectory =
       plugin.RenderedVesselTrajectory(satellite,
                                       earth_moon_barycentric.get(),
-                                      sun_world_position);
+                                      sun_world_position,
+                                      0 * Metre,
+                                      0);
   Position<World> const earth_world_position =
       sun_world_position + alice_sun_to_world(
           plugin.CelestialFromParent(SolarSystem::kEarth).displacement());
@@ -1132,7 +1381,11 @@ TEST_F(PluginTest, Prediction) {
   plugin.set_prediction_step(2 * π / n * Second);
   plugin.AdvanceTime(Instant(1e-10 * Second), 0 * Radian);
   RenderedTrajectory<World> rendered_prediction =
-      plugin.RenderedPrediction(transforms.get(), World::origin);
+      plugin.RenderedPrediction(satellite,
+                                transforms.get(),
+                                World::origin,
+                                0 * Metre,
+                                0);
   EXPECT_EQ(n, rendered_prediction.size());
   Angle const α = 2 * π * Radian / n;
   for (int k = 0; k < n; ++k) {
@@ -1152,6 +1405,603 @@ TEST_F(PluginTest, Prediction) {
   plugin.clear_predicted_vessel();
 }
 
+// Checks that the prediction of a circular orbit is simplified to within the
+// given tolerance.
+TEST_F(PluginTest, SimplifiedPrediction) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  int const n = 256;
+  Length const tolerance = 0.01 * Metre;
+  Plugin plugin(Instant(),
+                celestial,
+                SIUnit<GravitationalParameter>(),
+                0 * Radian);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  auto transforms = plugin.NewBodyCentredNonRotatingTransforms(celestial);
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({1 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>(
+           {0 * Metre / Second, 1 * Metre / Second, 0 * Metre / Second})});
+  plugin.set_predicted_vessel(satellite);
+  plugin.set_prediction_length(2 * π * Second);
+  plugin.set_prediction_step(2 * π / n * Second);
+  plugin.AdvanceTime(Instant(1e-10 * Second), 0 * Radian);
+  RenderedTrajectory<World> const rendered_prediction =
+      plugin.RenderedPrediction(satellite,
+                                transforms.get(),
+                                World::origin,
+                                0 * Metre,
+                                0);
+  RenderedTrajectory<World> const simplified_prediction =
+      plugin.RenderedPrediction(satellite,
+                                transforms.get(),
+                                World::origin,
+                                tolerance,
+                                0);
+  ASSERT_EQ(n, rendered_prediction.size());
+  // A chord of the unit circle whose sagitta is 1 cm subtends 16 degrees.  The
+  // Douglas-Peucker algorithm splits the arcs in halves, so it ends up with
+  // arcs of 11.25 degrees.
+  EXPECT_EQ(n / 8, simplified_prediction.size());
+  EXPECT_EQ(rendered_prediction.front().begin,
+            simplified_prediction.front().begin);
+  EXPECT_EQ(rendered_prediction.back().end,
+            simplified_prediction.back().end);
+  for (std::size_t i = 0; i + 1 < simplified_prediction.size(); ++i) {
+    EXPECT_EQ(simplified_prediction[i].end,
+              simplified_prediction[i + 1].begin);
+  }
+  // Each point of the full prediction is within |tolerance| of the simplified
+  // one.
+  for (auto const& segment : rendered_prediction) {
+    Length distance = std::numeric_limits<double>::infinity() * Metre;
+    for (auto const& simplified_segment : simplified_prediction) {
+      Displacement<World> const chord =
+          simplified_segment.end - simplified_segment.begin;
+      Displacement<World> const from_begin =
+          segment.begin - simplified_segment.begin;
+      double const s =
+          std::min(std::max(InnerProduct(from_begin, chord) /
+                                InnerProduct(chord, chord),
+                            0.0),
+                   1.0);
+      distance = std::min(distance, (from_begin - s * chord).Norm());
+    }
+    EXPECT_THAT(distance, Le(tolerance));
+  }
+  plugin.clear_predicted_vessel();
+}
+
+// Checks that the points of a long prediction are thinned out with their time
+// distance from the current time if a level of detail is given, and that the
+// ends are preserved.
+TEST_F(PluginTest, LevelOfDetailPrediction) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  int const n = 8192;
+  Plugin plugin(Instant(),
+                celestial,
+                SIUnit<GravitationalParameter>(),
+                0 * Radian);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  auto transforms = plugin.NewBodyCentredNonRotatingTransforms(celestial);
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({1 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>(
+           {0 * Metre / Second, 1 * Metre / Second, 0 * Metre / Second})});
+  plugin.set_predicted_vessel(satellite);
+  plugin.set_prediction_length(2 * π * Second);
+  plugin.set_prediction_step(2 * π / n * Second);
+  plugin.AdvanceTime(Instant(1e-10 * Second), 0 * Radian);
+  EXPECT_EQ(n,
+            plugin.RenderedPrediction(satellite,
+                                      transforms.get(),
+                                      World::origin,
+                                      0 * Metre,
+                                      0).size());
+  RenderedTrajectory<World> const rendered_prediction =
+      plugin.RenderedPrediction(satellite,
+                                transforms.get(),
+                                World::origin,
+                                0 * Metre,
+                                1.0 / 1024);
+  // The points less than 1024 steps away are all rendered, the others are
+  // spaced by about a 1024th of their time distance.
+  EXPECT_THAT(rendered_prediction.size(), AllOf(Gt(n / 4), Lt(n / 2)));
+  EXPECT_THAT(
+      RelativeError(rendered_prediction.front().begin - World::origin,
+                    Displacement<World>({1 * Metre, 0 * Metre, 0 * Metre})),
+      Lt(1e-6));
+  EXPECT_THAT(
+      RelativeError(rendered_prediction.back().end - World::origin,
+                    Displacement<World>({1 * Metre, 0 * Metre, 0 * Metre})),
+      Lt(1e-6));
+  for (std::size_t i = 0; i + 1 < rendered_prediction.size(); ++i) {
+    EXPECT_EQ(rendered_prediction[i].end, rendered_prediction[i + 1].begin);
+  }
+  plugin.clear_predicted_vessel();
+}
+
+// Checks that the prediction of a vessel subject only to gravity is extended
+// rather than recomputed when time advances, including when the prolongations
+// are reset.  The orbit is slow enough for the prolongations to be accurate
+// with a step of |Δt_|.
+TEST_F(PluginTest, IncrementalPrediction) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  int const n = 64;
+  Length const r = 1000 * Metre;
+  Time const period =
+      2 * π * Sqrt(r * r * r / SIUnit<GravitationalParameter>());
+  Time const step = period / n;
+  Plugin plugin(Instant(),
+                celestial,
+                SIUnit<GravitationalParameter>(),
+                0 * Radian);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  auto transforms = plugin.NewBodyCentredNonRotatingTransforms(celestial);
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({r, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>({0 * Metre / Second,
+                           Sqrt(SIUnit<GravitationalParameter>() / r),
+                           0 * Metre / Second})});
+  plugin.set_predicted_vessel(satellite);
+  plugin.set_prediction_length(period / 4);
+  plugin.set_prediction_step(step);
+  Instant const t0(1e-10 * Second);
+  plugin.AdvanceTime(t0, 0 * Radian);
+  Angle const α = 2 * π * Radian / n;
+  auto const on_circle = [r](Angle const& angle) {
+    return Displacement<World>({Cos(angle) * r, 0 * Metre, Sin(angle) * r});
+  };
+  // Checks that |rendered_prediction| has |n / 4| segments starting at the
+  // angle |first| * α.
+  auto const expect_on_circle = [n, α, &on_circle](
+      RenderedTrajectory<World> const& rendered_prediction,
+      int const first) {
+    ASSERT_EQ(n / 4, rendered_prediction.size());
+    for (int k = 0; k < n / 4; ++k) {
+      EXPECT_THAT(RelativeError(rendered_prediction[k].begin - World::origin,
+                                on_circle((first + k) * α)),
+                  Lt(1e-6)) << k;
+    }
+    for (std::size_t i = 0; i + 1 < rendered_prediction.size(); ++i) {
+      EXPECT_EQ(rendered_prediction[i].end, rendered_prediction[i + 1].begin);
+    }
+  };
+  expect_on_circle(plugin.RenderedPrediction(satellite,
+                                             transforms.get(),
+                                             World::origin,
+                                             0 * Metre,
+                                             0),
+                   0);
+
+  // Advancing by half a step resets the prolongations, but the prediction,
+  // which agrees with the new prolongation, is kept.  It still starts at |t0|.
+  plugin.InsertOrKeepVessel(satellite, celestial);
+  plugin.AdvanceTime(t0 + step / 2, 0 * Radian);
+  expect_on_circle(plugin.RenderedPrediction(satellite,
+                                             transforms.get(),
+                                             World::origin,
+                                             0 * Metre,
+                                             0),
+                   0);
+
+  // Advancing by another step forgets the first point of the prediction and
+  // extends it by one step.
+  plugin.InsertOrKeepVessel(satellite, celestial);
+  plugin.AdvanceTime(t0 + 3 * step / 2, 0 * Radian);
+  expect_on_circle(plugin.RenderedPrediction(satellite,
+                                             transforms.get(),
+                                             World::origin,
+                                             0 * Metre,
+                                             0),
+                   1);
+  plugin.clear_predicted_vessel();
+}
+
+// Checks that a prediction that does not agree with the prolongation of its
+// vessel is recomputed.  Here the prediction step is so large that the
+// prediction, interpolated between its points, is far from the orbit.
+TEST_F(PluginTest, InaccuratePredictionIsRecomputed) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  int const n = 4;
+  Length const r = 1000 * Metre;
+  Time const period =
+      2 * π * Sqrt(r * r * r / SIUnit<GravitationalParameter>());
+  Time const step = period / n;
+  Plugin plugin(Instant(),
+                celestial,
+                SIUnit<GravitationalParameter>(),
+                0 * Radian);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  auto transforms = plugin.NewBodyCentredNonRotatingTransforms(celestial);
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({r, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>({0 * Metre / Second,
+                           Sqrt(SIUnit<GravitationalParameter>() / r),
+                           0 * Metre / Second})});
+  plugin.set_predicted_vessel(satellite);
+  plugin.set_prediction_length(period);
+  plugin.set_prediction_step(step);
+  Instant const t0(1e-10 * Second);
+  plugin.AdvanceTime(t0, 0 * Radian);
+
+  plugin.InsertOrKeepVessel(satellite, celestial);
+  plugin.AdvanceTime(t0 + step / 2, 0 * Radian);
+  RenderedTrajectory<World> const rendered_prediction =
+      plugin.RenderedPrediction(satellite,
+                                transforms.get(),
+                                World::origin,
+                                0 * Metre,
+                                0);
+  EXPECT_EQ(n, rendered_prediction.size());
+  EXPECT_THAT(RelativeError(rendered_prediction.front().begin - World::origin,
+                            Displacement<World>({Cos(π / n * Radian) * r,
+                                                 0 * Metre,
+                                                 Sin(π / n * Radian) * r})),
+              Lt(1e-6));
+  plugin.clear_predicted_vessel();
+}
+
+TEST_F(PluginTest, AsynchronousPrediction) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  int const n = 8;
+  TestablePlugin plugin(Instant(),
+                        celestial,
+                        SIUnit<GravitationalParameter>(),
+                        0 * Radian);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite, celestial));
+  auto transforms = plugin.NewBodyCentredNonRotatingTransforms(celestial);
+  plugin.SetVesselStateOffset(
+      satellite,
+      {Displacement<AliceSun>({1 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>(
+           {0 * Metre / Second, 1 * Metre / Second, 0 * Metre / Second})});
+  plugin.set_predicted_vessel(satellite);
+  plugin.set_prediction_length(2 * π * Second);
+  plugin.set_prediction_step(2 * π / n * Second);
+  plugin.set_asynchronous_predictions(true);
+  Instant const snapshot_time(1e-10 * Second);
+  plugin.AdvanceTime(snapshot_time, 0 * Radian);
+  // The prediction is only used by the next call to |AdvanceTime()|.
+  plugin.WaitForPendingPrediction();
+  EXPECT_TRUE(plugin.RenderedPrediction(satellite,
+                                        transforms.get(),
+                                        World::origin,
+                                        0 * Metre,
+                                        0).empty());
+  EXPECT_EQ(Time(), plugin.prediction_staleness());
+
+  Angle const α = 2 * π * Radian / n;
+  // Checks that |rendered_prediction| is a circle starting at the angle
+  // |first| * α.
+  auto const expect_circular = [n, α](
+      RenderedTrajectory<World> const& rendered_prediction,
+      int const first) {
+    EXPECT_EQ(n, rendered_prediction.size());
+    for (int k = 0; k < n; ++k) {
+      EXPECT_THAT(
+          RelativeError(
+              rendered_prediction[k].end - World::origin,
+              Displacement<World>({Cos((first + k + 1) * α) * Metre,
+                                   0 * Metre,
+                                   Sin((first + k + 1) * α) * Metre})),
+          Lt(0.011));
+    }
+  };
+
+  Instant t = snapshot_time + 1e-10 * Second;
+  plugin.InsertOrKeepVessel(satellite, celestial);
+  plugin.AdvanceTime(t, 0 * Radian);
+  EXPECT_EQ(t - snapshot_time, plugin.prediction_staleness());
+  expect_circular(plugin.RenderedPrediction(satellite,
+                                            transforms.get(),
+                                            World::origin,
+                                            0 * Metre,
+                                            0),
+                  0);
+
+  // One step later, the next prediction extends the completed one.
+  Instant const extension_time = snapshot_time + 2 * π / n * Second;
+  plugin.InsertOrKeepVessel(satellite, celestial);
+  plugin.AdvanceTime(extension_time, 0 * Radian);
+  EXPECT_EQ(extension_time - snapshot_time, plugin.prediction_staleness());
+  plugin.WaitForPendingPrediction();
+  t = extension_time + 1e-10 * Second;
+  plugin.InsertOrKeepVessel(satellite, celestial);
+  plugin.AdvanceTime(t, 0 * Radian);
+  EXPECT_EQ(t - extension_time, plugin.prediction_staleness());
+  expect_circular(plugin.RenderedPrediction(satellite,
+                                            transforms.get(),
+                                            World::origin,
+                                            0 * Metre,
+                                            0),
+                  1);
+  plugin.clear_predicted_vessel();
+}
+
+// Checks that the predictions of several vessels are computed together, and
+// that removing a predicted vessel keeps the predictions of the others.
+TEST_F(PluginTest, MultiplePredictions) {
+  GUID const satellite_a = "satellite A";
+  GUID const satellite_b = "satellite B";
+  Index const celestial = 0;
+  int const n = 8;
+  Plugin plugin(Instant(),
+                celestial,
+                SIUnit<GravitationalParameter>(),
+                0 * Radian);
+  plugin.EndInitialization();
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite_a, celestial));
+  EXPECT_TRUE(plugin.InsertOrKeepVessel(satellite_b, celestial));
+  auto transforms = plugin.NewBodyCentredNonRotatingTransforms(celestial);
+  plugin.SetVesselStateOffset(
+      satellite_a,
+      {Displacement<AliceSun>({1 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>(
+           {0 * Metre / Second, 1 * Metre / Second, 0 * Metre / Second})});
+  plugin.SetVesselStateOffset(
+      satellite_b,
+      {Displacement<AliceSun>({-1 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>(
+           {0 * Metre / Second, -1 * Metre / Second, 0 * Metre / Second})});
+  plugin.add_predicted_vessel(satellite_a);
+  plugin.add_predicted_vessel(satellite_b);
+  plugin.set_prediction_length(2 * π * Second);
+  plugin.set_prediction_step(2 * π / n * Second);
+  EXPECT_FALSE(plugin.has_prediction(satellite_a));
+  plugin.AdvanceTime(Instant(1e-10 * Second), 0 * Radian);
+  EXPECT_TRUE(plugin.has_prediction(satellite_a));
+  EXPECT_TRUE(plugin.has_prediction(satellite_b));
+
+  Angle const α = 2 * π * Radian / n;
+  auto const check_prediction = [&plugin, &transforms, n, α](
+      GUID const& vessel_guid,
+      Angle const& phase) {
+    RenderedTrajectory<World> const rendered_prediction =
+        plugin.RenderedPrediction(vessel_guid,
+                                  transforms.get(),
+                                  World::origin,
+                                  0 * Metre,
+                                  0);
+    EXPECT_EQ(n, rendered_prediction.size());
+    for (int k = 0; k < n; ++k) {
+      Angle const angle = phase + (k + 1) * α;
+      EXPECT_THAT(
+          RelativeError(rendered_prediction[k].end - World::origin,
+                        Displacement<World>({Cos(angle) * Metre,
+                                             0 * Metre,
+                                             Sin(angle) * Metre})),
+          Lt(0.011)) << vessel_guid << " " << k;
+    }
+  };
+  check_prediction(satellite_a, 0 * Radian);
+  check_prediction(satellite_b, π * Radian);
+
+  plugin.remove_predicted_vessel(satellite_a);
+  EXPECT_FALSE(plugin.has_prediction(satellite_a));
+  EXPECT_TRUE(plugin.has_prediction(satellite_b));
+  EXPECT_TRUE(plugin.RenderedPrediction(satellite_a,
+                                        transforms.get(),
+                                        World::origin,
+                                        0 * Metre,
+                                        0).empty());
+  check_prediction(satellite_b, π * Radian);
+  plugin.clear_predicted_vessel();
+  EXPECT_FALSE(plugin.has_prediction(satellite_b));
+}
+
+// Checks that the histories integrated in the background are used by
+// |AdvanceTime()|, and that they agree with the histories integrated
+// synchronously.
+TEST_F(PluginTest, SpeculativeHistories) {
+  GUID const satellite = "satellite";
+  Index const celestial = 0;
+  TestablePlugin synchronous_plugin(Instant(),
+                                    celestial,
+                                    SIUnit<GravitationalParameter>(),
+                                    0 * Radian);
+  TestablePlugin speculative_plugin(Instant(),
+                                    celestial,
+                                    SIUnit<GravitationalParameter>(),
+                                    0 * Radian);
+  speculative_plugin.set_speculative_histories(true);
+  for (TestablePlugin* const plugin :
+           {&synchronous_plugin, &speculative_plugin}) {
+    plugin->EndInitialization();
+    EXPECT_TRUE(plugin->InsertOrKeepVessel(satellite, celestial));
+    // A circular orbit with a period of about 2.3 days.
+    plugin->SetVesselStateOffset(
+        satellite,
+        {Displacement<AliceSun>({1000 * Metre, 0 * Metre, 0 * Metre}),
+         Velocity<AliceSun>({0 * Metre / Second,
+                             Sqrt(1e-3) * Metre / Second,
+                             0 * Metre / Second})});
+  }
+
+  // Advance time in small increments, letting the speculation complete at
+  // each frame.
+  for (int i = 1; i <= 200; ++i) {
+    Instant const t = Instant() + i * Second;
+    for (TestablePlugin* const plugin :
+             {&synchronous_plugin, &speculative_plugin}) {
+      plugin->InsertOrKeepVessel(satellite, celestial);
+      plugin->AdvanceTime(t, 0 * Radian);
+    }
+    speculative_plugin.WaitForSpeculativeHistories();
+  }
+  EXPECT_EQ(0, synchronous_plugin.committed_speculative_steps());
+  EXPECT_THAT(speculative_plugin.committed_speculative_steps(), Gt(10));
+
+  RelativeDegreesOfFreedom<AliceSun> const synchronous =
+      synchronous_plugin.VesselFromParent(satellite);
+  RelativeDegreesOfFreedom<AliceSun> const speculative =
+      speculative_plugin.VesselFromParent(satellite);
+  EXPECT_THAT(RelativeError(synchronous.displacement(),
+                            speculative.displacement()),
+              Lt(1e-12));
+  EXPECT_THAT(RelativeError(synchronous.velocity(), speculative.velocity()),
+              Lt(1e-12));
+}
+
+// Checks that the prolongations interpolated in the current step of the
+// histories agree with the integrated ones, and that the vessels that are not
+// synchronized are still integrated.
+TEST_F(PluginTest, DenseProlongations) {
+  GUID const satellite = "satellite";
+  GUID const newcomer = "newcomer";
+  Index const celestial = 0;
+  Plugin integrated_plugin(Instant(),
+                           celestial,
+                           SIUnit<GravitationalParameter>(),
+                           0 * Radian);
+  Plugin dense_plugin(Instant(),
+                      celestial,
+                      SIUnit<GravitationalParameter>(),
+                      0 * Radian);
+  dense_plugin.set_dense_prolongations(true);
+  // A circular orbit with a period of about 1.7 hours.
+  RelativeDegreesOfFreedom<AliceSun> const circular_orbit(
+      Displacement<AliceSun>({100 * Metre, 0 * Metre, 0 * Metre}),
+      Velocity<AliceSun>({0 * Metre / Second,
+                          0.1 * Metre / Second,
+                          0 * Metre / Second}));
+  for (Plugin* const plugin : {&integrated_plugin, &dense_plugin}) {
+    plugin->EndInitialization();
+    EXPECT_TRUE(plugin->InsertOrKeepVessel(satellite, celestial));
+    plugin->SetVesselStateOffset(satellite, circular_orbit);
+  }
+
+  Instant t;
+  for (int i = 1; i <= 100; ++i) {
+    t += 0.3 * Second;
+    for (Plugin* const plugin : {&integrated_plugin, &dense_plugin}) {
+      plugin->InsertOrKeepVessel(satellite, celestial);
+      if (i > 50) {
+        plugin->InsertOrKeepVessel(newcomer, celestial);
+      }
+      if (i == 51) {
+        plugin->SetVesselStateOffset(newcomer, circular_orbit);
+      }
+      plugin->AdvanceTime(t, 0 * Radian);
+    }
+    for (GUID const& vessel : {satellite, newcomer}) {
+      if (vessel == newcomer && i <= 50) {
+        continue;
+      }
+      RelativeDegreesOfFreedom<AliceSun> const integrated =
+          integrated_plugin.VesselFromParent(vessel);
+      RelativeDegreesOfFreedom<AliceSun> const dense =
+          dense_plugin.VesselFromParent(vessel);
+      EXPECT_THAT(RelativeError(integrated.displacement(),
+                                dense.displacement()),
+                  Lt(1e-9)) << vessel << " " << i;
+      EXPECT_THAT(RelativeError(integrated.velocity(), dense.velocity()),
+                  Lt(1e-7)) << vessel << " " << i;
+    }
+  }
+}
+
+// Checks that the histories integrated with long steps under time warp agree
+// with those integrated with |Δt_|, and that the steps fall back to |Δt_| near
+// the celestial.
+TEST_F(PluginTest, FastTimeWarp) {
+  GUID const distant = "distant";
+  GUID const close = "close";
+  Index const celestial = 0;
+  Plugin reference_plugin(Instant(),
+                          celestial,
+                          SIUnit<GravitationalParameter>(),
+                          0 * Radian);
+  Plugin warp_plugin(Instant(),
+                     celestial,
+                     SIUnit<GravitationalParameter>(),
+                     0 * Radian);
+  warp_plugin.set_fast_time_warp(true);
+  for (Plugin* const plugin : {&reference_plugin, &warp_plugin}) {
+    plugin->EndInitialization();
+    EXPECT_TRUE(plugin->InsertOrKeepVessel(distant, celestial));
+    // A circular orbit with a period of about 2.3 days, i.e., a dynamical
+    // time of about 8.8 hours.
+    plugin->SetVesselStateOffset(
+        distant,
+        {Displacement<AliceSun>({1000 * Metre, 0 * Metre, 0 * Metre}),
+         Velocity<AliceSun>({0 * Metre / Second,
+                             Sqrt(1e-3) * Metre / Second,
+                             0 * Metre / Second})});
+    // Synchronize the vessel.
+    plugin->AdvanceTime(Instant() + 20 * Second, 0 * Radian);
+    plugin->InsertOrKeepVessel(distant, celestial);
+    plugin->AdvanceTime(Instant() + 1 * Day, 0 * Radian);
+  }
+  EXPECT_EQ(0, reference_plugin.time_warp_steps());
+  EXPECT_THAT(warp_plugin.time_warp_steps(), Gt(100));
+  RelativeDegreesOfFreedom<AliceSun> const reference =
+      reference_plugin.VesselFromParent(distant);
+  RelativeDegreesOfFreedom<AliceSun> const warped =
+      warp_plugin.VesselFromParent(distant);
+  EXPECT_THAT(RelativeError(reference.displacement(), warped.displacement()),
+              Lt(1e-9));
+  EXPECT_THAT(RelativeError(reference.velocity(), warped.velocity()),
+              Lt(1e-9));
+
+  // A vessel with a dynamical time of about 17 minutes prevents the use of
+  // long steps.
+  std::int64_t const time_warp_steps = warp_plugin.time_warp_steps();
+  warp_plugin.InsertOrKeepVessel(distant, celestial);
+  EXPECT_TRUE(warp_plugin.InsertOrKeepVessel(close, celestial));
+  warp_plugin.SetVesselStateOffset(
+      close,
+      {Displacement<AliceSun>({100 * Metre, 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>({0 * Metre / Second,
+                           0.1 * Metre / Second,
+                           0 * Metre / Second})});
+  warp_plugin.AdvanceTime(Instant() + 1 * Day + 20 * Second, 0 * Radian);
+  warp_plugin.InsertOrKeepVessel(distant, celestial);
+  warp_plugin.InsertOrKeepVessel(close, celestial);
+  warp_plugin.AdvanceTime(Instant() + 2 * Day, 0 * Radian);
+  EXPECT_EQ(time_warp_steps, warp_plugin.time_warp_steps());
+
+  // A vessel with a dynamical time of about a year, but which moves fast
+  // enough to reach the celestial in about 17 minutes, prevents the use of
+  // long steps until it has moved away.
+  GUID const fast = "fast";
+  Plugin fast_plugin(Instant(),
+                     celestial,
+                     SIUnit<GravitationalParameter>(),
+                     0 * Radian);
+  fast_plugin.set_fast_time_warp(true);
+  fast_plugin.EndInitialization();
+  EXPECT_TRUE(fast_plugin.InsertOrKeepVessel(fast, celestial));
+  fast_plugin.SetVesselStateOffset(
+      fast,
+      {Displacement<AliceSun>({100 * Kilo(Metre), 0 * Metre, 0 * Metre}),
+       Velocity<AliceSun>({0 * Metre / Second,
+                           100 * Metre / Second,
+                           0 * Metre / Second})});
+  fast_plugin.AdvanceTime(Instant() + 20 * Second, 0 * Radian);
+  fast_plugin.InsertOrKeepVessel(fast, celestial);
+  fast_plugin.AdvanceTime(Instant() + 1000 * Second, 0 * Radian);
+  EXPECT_EQ(0, fast_plugin.time_warp_steps());
+  for (Instant const& t : {Instant() + 5000 * Second, Instant() + 1 * Day}) {
+    fast_plugin.InsertOrKeepVessel(fast, celestial);
+    fast_plugin.AdvanceTime(t, 0 * Radian);
+  }
+  EXPECT_THAT(fast_plugin.time_warp_steps(), Gt(0));
+}
+
 TEST_F(PluginTest, Navball) {
   // Create a plugin with planetarium rotation 0.
   Plugin plugin(initial_time_,
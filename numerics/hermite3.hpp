@@ -0,0 +1,50 @@
+#pragma once
+
+#include <utility>
+
+#include "quantities/named_quantities.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using quantities::Difference;
+using quantities::Quotient;
+
+namespace numerics {
+
+// The cubic Hermite interpolation of a function of |Argument| with values in
+// |Value| on an interval, defined by the values and the derivatives of the
+// function at the ends of the interval.  |Argument| and |Value| may be affine
+// spaces, e.g., |Instant| and |Position|.
+template<typename Argument, typename Value>
+class Hermite3 {
+ public:
+  using Derivative = Quotient<Difference<Value>, Difference<Argument>>;
+
+  // The interval given by |arguments| must not be empty.
+  Hermite3(std::pair<Argument, Argument> const& arguments,
+           std::pair<Value, Value> const& values,
+           std::pair<Derivative, Derivative> const& derivatives);
+
+  // |argument| should be in the interval given at construction.
+  Value Evaluate(Argument const& argument) const;
+  Derivative EvaluateDerivative(Argument const& argument) const;
+
+  std::pair<Argument, Argument> const& arguments() const;
+
+ private:
+  using Derivative2 = Quotient<Derivative, Difference<Argument>>;
+  using Derivative3 = Quotient<Derivative2, Difference<Argument>>;
+
+  std::pair<Argument, Argument> const arguments_;
+  // The coefficients of the polynomial in |argument - arguments_.first|.
+  Value const a0_;
+  Derivative const a1_;
+  Derivative2 a2_;
+  Derivative3 a3_;
+};
+
+}  // namespace numerics
+}  // namespace principia
+
+#include "numerics/hermite3_body.hpp"
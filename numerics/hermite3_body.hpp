@@ -0,0 +1,47 @@
+#pragma once
+
+#include "numerics/hermite3.hpp"
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace numerics {
+
+template<typename Argument, typename Value>
+Hermite3<Argument, Value>::Hermite3(
+    std::pair<Argument, Argument> const& arguments,
+    std::pair<Value, Value> const& values,
+    std::pair<Derivative, Derivative> const& derivatives)
+    : arguments_(arguments),
+      a0_(values.first),
+      a1_(derivatives.first) {
+  CHECK_LT(arguments_.first, arguments_.second)
+      << "Interval must not be empty";
+  Difference<Argument> const h = arguments_.second - arguments_.first;
+  Derivative const slope = (values.second - values.first) / h;
+  a2_ = (3 * slope - 2 * derivatives.first - derivatives.second) / h;
+  a3_ = (derivatives.first + derivatives.second - 2 * slope) / (h * h);
+}
+
+template<typename Argument, typename Value>
+Value Hermite3<Argument, Value>::Evaluate(Argument const& argument) const {
+  Difference<Argument> const s = argument - arguments_.first;
+  return a0_ + s * (a1_ + s * (a2_ + s * a3_));
+}
+
+template<typename Argument, typename Value>
+typename Hermite3<Argument, Value>::Derivative
+Hermite3<Argument, Value>::EvaluateDerivative(
+    Argument const& argument) const {
+  Difference<Argument> const s = argument - arguments_.first;
+  return a1_ + s * (2 * a2_ + s * 3 * a3_);
+}
+
+template<typename Argument, typename Value>
+std::pair<Argument, Argument> const&
+Hermite3<Argument, Value>::arguments() const {
+  return arguments_;
+}
+
+}  // namespace numerics
+}  // namespace principia
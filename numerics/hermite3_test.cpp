@@ -0,0 +1,70 @@
+#include "numerics/hermite3.hpp"
+
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "gtest/gtest.h"
+#include "quantities/named_quantities.hpp"
+#include "quantities/si.hpp"
+#include "testing_utilities/almost_equals.hpp"
+
+namespace principia {
+
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Position;
+using geometry::Vector;
+using geometry::Velocity;
+using quantities::Length;
+using quantities::Speed;
+using si::Metre;
+using si::Second;
+using testing_utilities::AlmostEquals;
+
+namespace numerics {
+
+class Hermite3Test : public ::testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST1, true>;
+
+  Instant const t0_;
+};
+
+// A cubic polynomial is interpolated exactly.
+TEST_F(Hermite3Test, Cubic) {
+  // x(t) = 1 - 2 t + 3 t² - t³, with t in seconds and x in metres.
+  auto const x = [](double const t) {
+    return (1 - 2 * t + 3 * t * t - t * t * t) * Metre;
+  };
+  auto const v = [](double const t) {
+    return (-2 + 6 * t - 3 * t * t) * Metre / Second;
+  };
+  Hermite3<Instant, Length> const h({t0_ + 1 * Second, t0_ + 3 * Second},
+                                    {x(1), x(3)},
+                                    {v(1), v(3)});
+  for (double t = 1; t <= 3; t += 0.25) {
+    EXPECT_THAT(h.Evaluate(t0_ + t * Second), AlmostEquals(x(t), 0, 8)) << t;
+    EXPECT_THAT(h.EvaluateDerivative(t0_ + t * Second),
+                AlmostEquals(v(t), 0, 8)) << t;
+  }
+}
+
+// The interpolation works on affine spaces.
+TEST_F(Hermite3Test, Positions) {
+  Position<World> const origin;
+  Velocity<World> const velocity({1 * Metre / Second,
+                                  2 * Metre / Second,
+                                  3 * Metre / Second});
+  Hermite3<Instant, Position<World>> const h(
+      {t0_, t0_ + 2 * Second},
+      {origin, origin + velocity * 2 * Second},
+      {velocity, velocity});
+  EXPECT_THAT(h.Evaluate(t0_ + 0.5 * Second) - origin,
+              AlmostEquals(velocity * 0.5 * Second, 0));
+  EXPECT_THAT(h.EvaluateDerivative(t0_ + 1.5 * Second),
+              AlmostEquals(velocity, 0));
+}
+
+}  // namespace numerics
+}  // namespace principia
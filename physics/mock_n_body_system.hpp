@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include <cstdint>
+
 #include "physics/n_body_system.hpp"
 
 #include "gmock/gmock.h"
@@ -21,6 +23,21 @@ class MockNBodySystem : public NBodySystem<InertialFrame> {
            bool const tmax_is_exact,
            typename NBodySystem<InertialFrame>::Trajectories const&
                trajectories));
+
+  // Forwards to the mocked overload, so that expectations need not care about
+  // the counting.
+  void Integrate(SRKNIntegrator const& integrator,
+                 Instant const& tmax,
+                 Time const& Δt,
+                 int const sampling_period,
+                 bool const tmax_is_exact,
+                 typename NBodySystem<InertialFrame>::Trajectories const&
+                     trajectories,
+                 not_null<std::int64_t*> const force_evaluations)
+      const override {
+    Integrate(integrator, tmax, Δt, sampling_period, tmax_is_exact,
+              trajectories);
+  }
 };
 
 }  // namespace physics
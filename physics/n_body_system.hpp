@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <cstdint>
 #include <memory>
 #include <set>
 #include <vector>
@@ -44,6 +45,16 @@ class NBodySystem {
                          bool const tmax_is_exact,
                          Trajectories const& trajectories) const;
 
+  // Same as above, but |force_evaluations| is incremented by the number of
+  // evaluations of the accelerations of all the bodies.
+  virtual void Integrate(SRKNIntegrator const& integrator,
+                         Instant const& tmax,
+                         Time const& Δt,
+                         int const sampling_period,
+                         bool const tmax_is_exact,
+                         Trajectories const& trajectories,
+                         not_null<std::int64_t*> const force_evaluations) const;
+
  private:
   using ReadonlyTrajectories = std::vector<not_null<Trajectory<Frame> const*>>;
 
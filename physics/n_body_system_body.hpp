@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <set>
 #include <vector>
@@ -68,6 +69,25 @@ void NBodySystem<Frame>::Integrate(SRKNIntegrator const& integrator,
                                    int const sampling_period,
                                    bool const tmax_is_exact,
                                    Trajectories const& trajectories) const {
+  std::int64_t force_evaluations = 0;
+  Integrate(integrator,
+            tmax,
+            Δt,
+            sampling_period,
+            tmax_is_exact,
+            trajectories,
+            &force_evaluations);
+}
+
+template<typename Frame>
+void NBodySystem<Frame>::Integrate(
+    SRKNIntegrator const& integrator,
+    Instant const& tmax,
+    Time const& Δt,
+    int const sampling_period,
+    bool const tmax_is_exact,
+    Trajectories const& trajectories,
+    not_null<std::int64_t*> const force_evaluations) const {
   SRKNIntegrator::Parameters<Length, Speed> parameters;
   SRKNIntegrator::Solution<Length, Speed> solution;
 
@@ -159,7 +179,7 @@ void NBodySystem<Frame>::Integrate(SRKNIntegrator const& integrator,
     parameters.Δt = Δt;
     parameters.sampling_period = sampling_period;
     parameters.tmax_is_exact = tmax_is_exact;
-    integrator.SolveTrivialKineticEnergyIncrement<Length>(
+    auto const compute_gravitational_accelerations =
         std::bind(&NBodySystem::ComputeGravitationalAccelerations,
                   massive_oblate_trajectories,
                   massive_spherical_trajectories,
@@ -167,7 +187,15 @@ void NBodySystem<Frame>::Integrate(SRKNIntegrator const& integrator,
                   reference_time,
                   std::placeholders::_1,
                   std::placeholders::_2,
-                  std::placeholders::_3),
+                  std::placeholders::_3);
+    integrator.SolveTrivialKineticEnergyIncrement<Length>(
+        [&compute_gravitational_accelerations, force_evaluations](
+            Time const& t,
+            std::vector<Length> const& q,
+            not_null<std::vector<Acceleration>*> const result) {
+          ++*force_evaluations;
+          compute_gravitational_accelerations(t, q, result);
+        },
         parameters, &solution);
 
     // TODO(phl): Ignoring errors for now.
@@ -29,6 +29,7 @@ using constants::GravitationalConstant;
 using geometry::Instant;
 using geometry::Point;
 using geometry::Vector;
+using integrators::BlanesMoan2002SRKN11B;
 using integrators::McLachlanAtela1992Order5Optimal;
 using quantities::Angle;
 using quantities::ArcTan;
@@ -233,6 +234,22 @@ TEST_F(NBodySystemTest, MoonEarth) {
   EXPECT_THAT(Abs(positions[100].coordinates().x), Lt(2 * SIUnit<Length>()));
 }
 
+// Checks that the evaluations of the accelerations are counted, including the
+// ones that a first-same-as-last integrator makes to synchronize its output.
+TEST_F(NBodySystemTest, ForceEvaluations) {
+  std::int64_t force_evaluations = 0;
+  system_->Integrate(BlanesMoan2002SRKN11B(),
+                     trajectory1_->last().time() + period_,
+                     period_ / 100,
+                     1,      // sampling_period
+                     false,  // tmax_is_exact
+                     {trajectory1_.get(), trajectory2_.get()},
+                     &force_evaluations);
+  EXPECT_THAT(trajectory1_->Positions().size(), Eq(101));
+  // 11 stages per step, and a synchronization at each of the 100 samples.
+  EXPECT_EQ(100 * (11 + 1), force_evaluations);
+}
+
 // The Moon alone.  It moves in straight line.
 TEST_F(NBodySystemTest, Moon) {
   Position<EarthMoonOrbitPlane> const reference_position =
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "base/mapped_file.hpp"
+#include "geometry/named_quantities.hpp"
+#include "physics/degrees_of_freedom.hpp"
+
+namespace principia {
+
+using geometry::Instant;
+
+namespace physics {
+
+// An append-only sequence of (time, degrees of freedom) records stored in a
+// memory-mapped scratch file.  This is used to move the old parts of long
+// histories out of the heap: the operating system pages the records in when
+// they are accessed and may page them out when they are not.  The records have
+// a fixed binary layout and are ordered by increasing time.
+template<typename Frame>
+class SpilledTimeline {
+ public:
+  struct Record {
+    Record(Instant const& time,
+           DegreesOfFreedom<Frame> const& degrees_of_freedom);
+
+    Instant const time;
+    DegreesOfFreedom<Frame> const degrees_of_freedom;
+  };
+
+  // Creates the file named |path|, truncating it if it exists.  The file is
+  // deleted when this object is destroyed.
+  explicit SpilledTimeline(std::string const& path);
+
+  // Appends a record at the end of the timeline.  |time| must be after the
+  // time of the last record.  Invalidates all the pointers to records.
+  void Append(Instant const& time,
+              DegreesOfFreedom<Frame> const& degrees_of_freedom);
+
+  // Removes the records for times less than or equal to |time|.  The file
+  // space is not reclaimed.  Complexity is O(Ln(|size|)).
+  void ForgetBefore(Instant const& time);
+
+  // Removes the records for times (strictly) greater than |time|.  Complexity
+  // is O(Ln(|size|)).
+  void ForgetAfter(Instant const& time);
+
+  // Removes the last record, which must exist.
+  void RemoveLast();
+
+  bool empty() const;
+  std::int64_t size() const;
+
+  // The range of the records currently in the timeline.
+  Record const* begin() const;
+  Record const* end() const;
+
+  // Returns the first record on or after |time|, or |end()| if there is no
+  // such record.  Complexity is O(Ln(|size|)).
+  Record const* lower_bound(Instant const& time) const;
+
+ private:
+  Record* records();
+  Record const* records() const;
+
+  base::MappedFile file_;
+  // The records in the range [first_, last_[ are the ones in the timeline.
+  std::int64_t first_ = 0;
+  std::int64_t last_ = 0;
+};
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/spilled_timeline_body.hpp"
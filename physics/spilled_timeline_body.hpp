@@ -0,0 +1,112 @@
+#pragma once
+
+#include "physics/spilled_timeline.hpp"
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+
+#include "glog/logging.h"
+
+namespace principia {
+namespace physics {
+
+template<typename Frame>
+SpilledTimeline<Frame>::Record::Record(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom)
+    : time(time),
+      degrees_of_freedom(degrees_of_freedom) {}
+
+template<typename Frame>
+SpilledTimeline<Frame>::SpilledTimeline(std::string const& path)
+    : file_(path) {
+  // The records are stored as-is in the file, so make sure that they don't
+  // contain anything but the 7 doubles that define them.
+  static_assert(sizeof(Record) == 7 * sizeof(double),
+                "Unexpected padding in Record");
+  static_assert(std::is_trivially_destructible<Record>::value,
+                "Record must be trivially destructible");
+}
+
+template<typename Frame>
+void SpilledTimeline<Frame>::Append(
+    Instant const& time,
+    DegreesOfFreedom<Frame> const& degrees_of_freedom) {
+  CHECK(empty() || records()[last_ - 1].time < time)
+      << "Append out of order at " << time;
+  file_.Reserve((last_ + 1) * sizeof(Record));
+  new (&records()[last_]) Record(time, degrees_of_freedom);
+  ++last_;
+}
+
+template<typename Frame>
+void SpilledTimeline<Frame>::ForgetBefore(Instant const& time) {
+  Record const* const it =
+      std::upper_bound(begin(), end(), time,
+                       [](Instant const& left, Record const& right) {
+                         return left < right.time;
+                       });
+  first_ = it - records();
+}
+
+template<typename Frame>
+void SpilledTimeline<Frame>::ForgetAfter(Instant const& time) {
+  Record const* const it =
+      std::upper_bound(begin(), end(), time,
+                       [](Instant const& left, Record const& right) {
+                         return left < right.time;
+                       });
+  last_ = it - records();
+}
+
+template<typename Frame>
+void SpilledTimeline<Frame>::RemoveLast() {
+  CHECK(!empty()) << "Empty timeline";
+  --last_;
+}
+
+template<typename Frame>
+bool SpilledTimeline<Frame>::empty() const {
+  return first_ == last_;
+}
+
+template<typename Frame>
+std::int64_t SpilledTimeline<Frame>::size() const {
+  return last_ - first_;
+}
+
+template<typename Frame>
+typename SpilledTimeline<Frame>::Record const*
+SpilledTimeline<Frame>::begin() const {
+  return records() + first_;
+}
+
+template<typename Frame>
+typename SpilledTimeline<Frame>::Record const*
+SpilledTimeline<Frame>::end() const {
+  return records() + last_;
+}
+
+template<typename Frame>
+typename SpilledTimeline<Frame>::Record const*
+SpilledTimeline<Frame>::lower_bound(Instant const& time) const {
+  return std::lower_bound(begin(), end(), time,
+                          [](Record const& left, Instant const& right) {
+                            return left.time < right;
+                          });
+}
+
+template<typename Frame>
+typename SpilledTimeline<Frame>::Record* SpilledTimeline<Frame>::records() {
+  return reinterpret_cast<Record*>(file_.data());
+}
+
+template<typename Frame>
+typename SpilledTimeline<Frame>::Record const*
+SpilledTimeline<Frame>::records() const {
+  return reinterpret_cast<Record const*>(file_.data());
+}
+
+}  // namespace physics
+}  // namespace principia
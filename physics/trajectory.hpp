@@ -1,19 +1,26 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <list>
 #include <map>
 #include <memory>
+#include <string>
 
+#include "base/arena.hpp"
 #include "base/not_null.hpp"
 #include "geometry/grassmann.hpp"
 #include "geometry/named_quantities.hpp"
 #include "physics/degrees_of_freedom.hpp"
+#include "physics/spilled_timeline.hpp"
 #include "quantities/named_quantities.hpp"
 #include "serialization/physics.pb.h"
 
 namespace principia {
 
+using base::Arena;
+using base::ArenaAllocator;
+using base::make_not_null_unique;
 using base::not_null;
 using geometry::Instant;
 using geometry::Vector;
@@ -29,16 +36,43 @@ class Body;
 template<typename Frame>
 class Trajectory {
   // There may be several forks starting from the same time, hence the multimap.
-  using Children = std::multimap<Instant, Trajectory>;
-  using Timeline = std::map<Instant, DegreesOfFreedom<Frame>>;
+  // The nodes of the containers of a trajectory are allocated from its own
+  // arena.  The arena of a fork gets its chunks from the arena of the root and
+  // gives them back in bulk when the fork is deleted, so that they are reused
+  // by the next forks without going through the global allocator.  Deleting a
+  // fork still visits its nodes, but doesn't free them one by one.  The arena
+  // of the root returns to the system the chunks emptied by |ForgetBefore|,
+  // |ReclaimDetachedPoints| or |SpillBefore|.
+  using Children =
+      std::multimap<Instant,
+                    Trajectory,
+                    std::less<Instant>,
+                    ArenaAllocator<std::pair<Instant const, Trajectory>>>;
+  // A point of a timeline.  The |index| of the points of a timeline are
+  // consecutive, so that the number of points between two of them is known
+  // without walking the timeline.  The points copied to a fork keep their
+  // |index|.
+  struct TimelinePoint {
+    DegreesOfFreedom<Frame> degrees_of_freedom;
+    std::int64_t index;
+  };
+  using Timeline = std::map<
+      Instant,
+      TimelinePoint,
+      std::less<Instant>,
+      ArenaAllocator<std::pair<Instant const, TimelinePoint>>>;
 
   // The two iterators denote entries in the containers of the parent.
   // |timeline| is past the end if the fork happened at the fork point of the
   // grandparent.  Note that this implies that the containers should not be
   // swapped.
+  // |children_index| is the position of |children| in the parent, counting the
+  // children that were forgotten.  It makes it possible to serialize pointers
+  // without walking the children.
   struct Fork {
     typename Children::const_iterator children;
     typename Timeline::const_iterator timeline;
+    std::int64_t children_index;
   };
 
  public:
@@ -118,6 +152,51 @@ class Trajectory {
   // trajectory must be a root.
   void ForgetBefore(Instant const& time);
 
+  // Same as |ForgetBefore|, except that the points are only detached from the
+  // trajectory: they become invisible immediately, but their memory is only
+  // reclaimed by subsequent calls to |ReclaimDetachedPoints|.  This makes it
+  // possible to spread the cost of forgetting a long history over several
+  // frames.  It is not possible to append or fork at or before |time|.
+  // Complexity is O(Ln(|length|)) plus the cost of deleting the children
+  // forked at or before |time|.  This trajectory must be a root.
+  void DetachBefore(Instant const& time);
+
+  // Frees the memory of at most |max_points| of the points detached by
+  // |DetachBefore|.  Returns the number of points actually freed, which is
+  // less than |max_points| if and only if no detached points remain.  This
+  // trajectory must be a root.
+  std::int64_t ReclaimDetachedPoints(std::int64_t const max_points);
+
+  // Creates the memory-mapped file named |path| to which |SpillBefore| moves
+  // the old points of this trajectory.  The file is deleted when the trajectory
+  // is destroyed.  This trajectory must be a root and this function must be
+  // called at most once.
+  void EnableSpilling(std::string const& path);
+
+  // Returns true if |EnableSpilling| was called for this trajectory.
+  bool is_spilling_enabled() const;
+
+  // The number of points moved to the file by |SpillBefore| and not forgotten
+  // since.  Zero if spilling is not enabled.
+  std::int64_t spilled_points() const;
+
+  // The number of points of this trajectory, not counting those of its
+  // ancestors, that are held in memory, including the points detached by
+  // |DetachBefore| and not yet reclaimed.
+  std::int64_t resident_points() const;
+
+  // Moves the points for times less than or equal to |time| to the file
+  // created by |EnableSpilling|, which must have been called.  The points
+  // remain visible through the iterators and in the serialized form of the
+  // trajectory, but they are no longer held in the heap.  The last point of
+  // the trajectory and the points at or after the earliest fork time are never
+  // spilled.  Since the spilled points must precede the points in memory,
+  // nothing is spilled as long as some points detached by |DetachBefore| have
+  // not been reclaimed.  It is not possible to fork at the time of a spilled
+  // point.  This trajectory must be a root.  Invalidates the iterators over
+  // this trajectory and its descendants.
+  void SpillBefore(Instant const& time);
+
   // Creates a new child trajectory forked at time |time|, and returns it.  The
   // child trajectory shares its data with the current trajectory for times less
   // than or equal to |time|, and is an exact copy of the current trajectory for
@@ -128,16 +207,35 @@ class Trajectory {
   // |time| to be removed deletes the child trajectory.  Deleting the parent
   // trajectory deletes all child trajectories.  |time| must be one of the times
   // of this trajectory, and must be at or after the fork time, if any.  No
-  // transfer of ownership.
+  // transfer of ownership.  The children forked after |time| are renumbered,
+  // which is cheap since forks normally happen near the end of the timeline.
   not_null<Trajectory*> NewFork(Instant const& time);
 
   // Deletes the child trajectory denoted by |*fork|, which must be a pointer
-  // previously returned by NewFork for this object.  Nulls |*fork|.
+  // previously returned by NewFork for this object.  Nulls |*fork|.  The
+  // children that follow it are renumbered.
   void DeleteFork(not_null<Trajectory**> const fork);
 
   // Returns true if this is a root trajectory.
   bool is_root() const;
 
+  // A number that changes whenever points are removed from the end of this
+  // trajectory by |ForgetAfter|, and that is never shared by two trajectories,
+  // even if one is allocated at the address of the other.  As long as it
+  // doesn't change, the points of this trajectory at a given time don't
+  // change, so it may be used to key caches of functions of these points.
+  std::int64_t generation() const;
+
+  // The number of bytes reserved by the arena from which the nodes of this
+  // trajectory are allocated.  For a root, this includes the memory kept for
+  // the next forks.  The memory of the nodes removed by |ForgetBefore| is
+  // returned to the system, except for at most one chunk.
+  std::int64_t reserved_bytes() const;
+
+  // The number of heap allocations made by the arena from which the nodes of
+  // this trajectory are allocated, since the creation of this trajectory.
+  std::int64_t system_allocations() const;
+
   // Returns the root trajectory.
   not_null<Trajectory const*> root() const;
   not_null<Trajectory*> root();
@@ -193,10 +291,13 @@ class Trajectory {
       serialization::Trajectory const& message,
       not_null<Body const*> const body);
 
+  // Complexity is O(|depth| * Ln(|length|)).
   void WritePointerToMessage(
       not_null<serialization::Trajectory::Pointer*> const message) const;
 
-  // |trajectory| must be a root.
+  // |trajectory| must be a root.  Complexity is O(|depth| + |forks|), where
+  // |forks| is the number of forks of each ancestor, but it is O(|depth|) for
+  // forks that are among the first or last ones of their parent.
   static not_null<Trajectory*> ReadPointerFromMessage(
       serialization::Trajectory::Pointer const& message,
       not_null<Trajectory*> const trajectory);
@@ -210,7 +311,7 @@ class Trajectory {
     Instant const& time() const;
 
    protected:
-    using Timeline = std::map<Instant, DegreesOfFreedom<Frame>>;
+    using Timeline = typename Trajectory::Timeline;
 
     Iterator() = default;
     // No transfer of ownership.
@@ -218,7 +319,7 @@ class Trajectory {
     void InitializeOnOrAfter(Instant const& time,
                              not_null<Trajectory const*> const trajectory);
     void InitializeLast(not_null<Trajectory const*> const trajectory);
-    typename Timeline::const_iterator current() const;
+    DegreesOfFreedom<Frame> const& current_degrees_of_freedom() const;
     not_null<Trajectory const*> trajectory() const;
 
    private:
@@ -228,6 +329,9 @@ class Trajectory {
     // |ancestry_| is the root.  There is no element in |forks_| for the root.
     // It is therefore empty for a root trajectory.
     typename Timeline::const_iterator current_;
+    // Non-null if the iterator is on a spilled point of the root, in which case
+    // |current_| is at the |begin()| of the root timeline.
+    typename SpilledTimeline<Frame>::Record const* spilled_ = nullptr;
     std::list<not_null<Trajectory const*>> ancestry_;  // Pointers not owned.
     std::list<Fork> forks_;
   };
@@ -263,6 +367,9 @@ class Trajectory {
   // Returns the fork time of this trajectory, which must not be a root.
   Instant const& ForkTime() const;
 
+  // Returns the first point of |timeline_| which is not detached.
+  typename Timeline::const_iterator timeline_begin() const;
+
   // This trajectory need not be a root.
   void WriteSubTreeToMessage(
       not_null<serialization::Trajectory*> const message) const;
@@ -275,9 +382,25 @@ class Trajectory {
   std::unique_ptr<Fork> fork_;
   Trajectory* const parent_;
 
+  // The arena must be destroyed after the containers.
+  not_null<std::unique_ptr<Arena>> const arena_;
+
   Children children_;
   Timeline timeline_;
 
+  // The number of children removed by |ForgetBefore| or |DetachBefore|.
+  std::int64_t forgotten_children_ = 0;
+
+  std::int64_t generation_;
+
+  // The points of |timeline_| at or before this time are detached.  Null if
+  // there are no detached points.  Only a root may have detached points.
+  std::unique_ptr<Instant> detached_until_;  // std::optional.
+
+  // The points that precede |timeline_|, null if spilling is not enabled.
+  // Only a root may have such points.
+  std::unique_ptr<SpilledTimeline<Frame>> spilled_timeline_;
+
   std::unique_ptr<IntrinsicAcceleration> intrinsic_acceleration_;
 
   // For using the private constructor in maps.
@@ -3,8 +3,11 @@
 #include "trajectory.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <list>
 #include <map>
+#include <string>
 
 #include "geometry/named_quantities.hpp"
 #include "glog/logging.h"
@@ -17,10 +20,24 @@ using geometry::Instant;
 
 namespace physics {
 
+namespace internal {
+
+// Returns a number that was not returned by any previous call.
+inline std::int64_t NewGeneration() {
+  static std::atomic<std::int64_t> next_generation(0);
+  return next_generation++;
+}
+
+}  // namespace internal
+
 template<typename Frame>
 Trajectory<Frame>::Trajectory(not_null<Body const*> const body)
     : body_(body),
-      parent_(nullptr) {
+      parent_(nullptr),
+      arena_(make_not_null_unique<Arena>()),
+      children_(typename Children::allocator_type(arena_.get())),
+      timeline_(typename Timeline::allocator_type(arena_.get())),
+      generation_(internal::NewGeneration()) {
   CHECK(body_->is_compatible_with<Frame>())
       << "Oblate body not in the same frame as the trajectory";
 }
@@ -111,18 +128,23 @@ template<typename Frame>
 void Trajectory<Frame>::Append(
     Instant const& time,
     DegreesOfFreedom<Frame> const& degrees_of_freedom) {
+  CHECK(detached_until_ == nullptr || *detached_until_ < time)
+      << "Append at detached time " << time;
   CHECK(timeline_.empty() || timeline_.crbegin()->first != time)
       << "Append at existing time " << time
       << ", time range = [" << Times().front() << ", "
       << Times().back() << "]";
+  std::int64_t const index =
+      timeline_.empty() ? 0 : timeline_.crbegin()->second.index + 1;
   auto it = timeline_.emplace_hint(timeline_.end(),
                                    time,
-                                   degrees_of_freedom);
+                                   TimelinePoint{degrees_of_freedom, index});
   CHECK(timeline_.end() == ++it) << "Append out of order";
 }
 
 template<typename Frame>
 void Trajectory<Frame>::ForgetAfter(Instant const& time) {
+  generation_ = internal::NewGeneration();
   // Each of these blocks gets an iterator denoting the first entry with
   // time > |time|.  It then removes that entry and all the entries that follow
   // it.  This preserve any entry with time == |time|.
@@ -136,6 +158,17 @@ void Trajectory<Frame>::ForgetAfter(Instant const& time) {
     auto const it = children_.upper_bound(time);
     children_.erase(it, children_.end());
   }
+  if (spilled_timeline_ != nullptr) {
+    spilled_timeline_->ForgetAfter(time);
+    // Maintain the invariant that the spilled points are followed by at least
+    // one point in |timeline_|.
+    if (timeline_.empty() && !spilled_timeline_->empty()) {
+      auto const& record = *(spilled_timeline_->end() - 1);
+      timeline_.emplace(record.time,
+                        TimelinePoint{record.degrees_of_freedom, 0});
+      spilled_timeline_->RemoveLast();
+    }
+  }
 }
 
 template<typename Frame>
@@ -151,8 +184,100 @@ void Trajectory<Frame>::ForgetBefore(Instant const& time) {
   }
   {
     auto it = children_.upper_bound(time);
+    forgotten_children_ += std::distance(children_.begin(), it);
+    children_.erase(children_.begin(), it);
+  }
+  if (spilled_timeline_ != nullptr) {
+    spilled_timeline_->ForgetBefore(time);
+  }
+  if (detached_until_ != nullptr && *detached_until_ <= time) {
+    detached_until_.reset();
+  }
+}
+
+template<typename Frame>
+void Trajectory<Frame>::DetachBefore(Instant const& time) {
+  CHECK(is_root()) << "DetachBefore on a nonroot trajectory";
+  if (detached_until_ == nullptr) {
+    detached_until_ = std::make_unique<Instant>(time);
+  } else {
+    *detached_until_ = std::max(*detached_until_, time);
+  }
+  {
+    auto it = children_.upper_bound(time);
+    forgotten_children_ += std::distance(children_.begin(), it);
     children_.erase(children_.begin(), it);
   }
+  if (spilled_timeline_ != nullptr) {
+    spilled_timeline_->ForgetBefore(time);
+  }
+}
+
+template<typename Frame>
+std::int64_t Trajectory<Frame>::ReclaimDetachedPoints(
+    std::int64_t const max_points) {
+  CHECK(is_root()) << "ReclaimDetachedPoints on a nonroot trajectory";
+  if (detached_until_ == nullptr) {
+    return 0;
+  }
+  auto it = timeline_.cbegin();
+  std::int64_t reclaimed_points = 0;
+  for (;
+       reclaimed_points < max_points &&
+       it != timeline_.cend() &&
+       it->first <= *detached_until_;
+       ++it, ++reclaimed_points) {}
+  timeline_.erase(timeline_.cbegin(), it);
+  if (timeline_.empty() || timeline_.cbegin()->first > *detached_until_) {
+    detached_until_.reset();
+  }
+  return reclaimed_points;
+}
+
+template<typename Frame>
+void Trajectory<Frame>::EnableSpilling(std::string const& path) {
+  CHECK(is_root()) << "EnableSpilling on a nonroot trajectory";
+  CHECK(spilled_timeline_ == nullptr) << "Spilling already enabled";
+  spilled_timeline_ = std::make_unique<SpilledTimeline<Frame>>(path);
+}
+
+template<typename Frame>
+bool Trajectory<Frame>::is_spilling_enabled() const {
+  return spilled_timeline_ != nullptr;
+}
+
+template<typename Frame>
+std::int64_t Trajectory<Frame>::spilled_points() const {
+  return spilled_timeline_ == nullptr ? 0 : spilled_timeline_->size();
+}
+
+template<typename Frame>
+std::int64_t Trajectory<Frame>::resident_points() const {
+  return timeline_.size();
+}
+
+template<typename Frame>
+void Trajectory<Frame>::SpillBefore(Instant const& time) {
+  CHECK(is_root()) << "SpillBefore on a nonroot trajectory";
+  CHECK(spilled_timeline_ != nullptr) << "Spilling not enabled";
+  // The spilled points must precede the points in memory.  Reclaiming all the
+  // detached points here would defeat the purpose of |DetachBefore|, so we
+  // wait for |ReclaimDetachedPoints| to do it.
+  if (detached_until_ != nullptr || timeline_.empty()) {
+    return;
+  }
+  // We keep the points after |time|, the ones on or after the first fork
+  // (they are referenced by the forks), and the last one.
+  auto const last = --timeline_.cend();
+  auto it = timeline_.cbegin();
+  for (;
+       it != last &&
+       it->first <= time &&
+       (children_.empty() || it->first < children_.begin()->first);
+       ++it) {
+    spilled_timeline_->Append(it->first, it->second.degrees_of_freedom);
+  }
+  timeline_.erase(timeline_.cbegin(), it);
 }
 
 template<typename Frame>
@@ -160,13 +285,15 @@ not_null<Trajectory<Frame>*> Trajectory<Frame>::NewFork(Instant const& time) {
   CHECK(timeline_.find(time) != timeline_.end() ||
         (!is_root() && time == ForkTime()))
       << "NewFork at nonexistent time " << time;
+  CHECK(detached_until_ == nullptr || *detached_until_ < time)
+      << "NewFork at detached time " << time;
 
   // May be at |end()|.
   auto fork_it = timeline_.find(time);
 
-  // We cannot know the iterator into children_ until after we have done the
-  // insertion in children_.
-  Fork const fork = {children_.end(), fork_it};
+  // We cannot know the iterator into children_ nor its index until after we
+  // have done the insertion in children_.
+  Fork const fork = {children_.end(), fork_it, 0};
   auto const child_it = children_.emplace(
       std::piecewise_construct,
       std::forward_as_tuple(time),
@@ -175,6 +302,13 @@ not_null<Trajectory<Frame>*> Trajectory<Frame>::NewFork(Instant const& time) {
     child_it->second.timeline_.insert(++fork_it, timeline_.end());
   }
   child_it->second.fork_->children = child_it;
+  child_it->second.fork_->children_index =
+      child_it == children_.begin()
+          ? forgotten_children_
+          : std::prev(child_it)->second.fork_->children_index + 1;
+  for (auto it = std::next(child_it); it != children_.end(); ++it) {
+    ++it->second.fork_->children_index;
+  }
   return &child_it->second;
 }
 
@@ -187,7 +321,9 @@ void Trajectory<Frame>::DeleteFork(not_null<Trajectory**> const fork) {
   auto const range = children_.equal_range(*fork_time);
   for (auto it = range.first; it != range.second; ++it) {
     if (&it->second == *fork) {
-      children_.erase(it);
+      for (auto next = children_.erase(it); next != children_.end(); ++next) {
+        --next->second.fork_->children_index;
+      }
       *fork = nullptr;
       return;
     }
@@ -201,6 +337,21 @@ bool Trajectory<Frame>::is_root() const {
   return parent_ == nullptr;
 }
 
+template<typename Frame>
+std::int64_t Trajectory<Frame>::generation() const {
+  return generation_;
+}
+
+template<typename Frame>
+std::int64_t Trajectory<Frame>::reserved_bytes() const {
+  return arena_->reserved_bytes();
+}
+
+template<typename Frame>
+std::int64_t Trajectory<Frame>::system_allocations() const {
+  return arena_->system_allocations();
+}
+
 template<typename Frame>
 not_null<Trajectory<Frame> const*> Trajectory<Frame>::root() const {
   Trajectory const* ancestor = this;
@@ -299,9 +450,22 @@ void Trajectory<Frame>::WritePointerToMessage(
     Fork const& fork = *ancestor->fork_;
     ancestor = ancestor->parent_;
     int const children_distance =
-        std::distance(ancestor->children_.begin(), fork.children);
-    int const timeline_distance =
-        std::distance(ancestor->timeline_.begin(), fork.timeline);
+        fork.children_index - ancestor->forgotten_children_;
+    int timeline_distance;
+    if (fork.timeline == ancestor->timeline_.end()) {
+      // Only a nonroot may be forked at its fork point, so there are no
+      // spilled or detached points.
+      timeline_distance = ancestor->timeline_.size();
+    } else {
+      // The fork point is not detached, so |timeline_begin()| is not past the
+      // end.  If there are spilled points, there are no detached points and
+      // the spilled points precede |timeline_|.
+      timeline_distance = fork.timeline->second.index -
+                          ancestor->timeline_begin()->second.index;
+      if (ancestor->spilled_timeline_ != nullptr) {
+        timeline_distance += ancestor->spilled_timeline_->size();
+      }
+    }
     auto* const fork_message = message->add_fork();
     fork_message->set_children_distance(children_distance);
     fork_message->set_timeline_distance(timeline_distance);
@@ -317,11 +481,17 @@ not_null<Trajectory<Frame>*> Trajectory<Frame>::ReadPointerFromMessage(
   for (int i = 0; i < message.fork_size(); ++i) {
     auto const& fork_message = message.fork(i);
     int const children_distance = fork_message.children_distance();
-    int const timeline_distance = fork_message.timeline_distance();
-    auto children_it = descendant->children_.begin();
-    auto timeline_it = descendant->timeline_.begin();
-    std::advance(children_it, children_distance);
-    std::advance(timeline_it, timeline_distance);
+    // The |timeline_distance| is redundant with the |children_distance|.
+    // Walk from the closest end, as most pointers denote recent forks.
+    Children& children = descendant->children_;
+    int const children_size = children.size();
+    auto children_it = children.begin();
+    if (children_distance <= children_size / 2) {
+      std::advance(children_it, children_distance);
+    } else {
+      children_it = children.end();
+      std::advance(children_it, children_distance - children_size);
+    }
     descendant = &children_it->second;
   }
   return descendant;
@@ -330,6 +500,14 @@ not_null<Trajectory<Frame>*> Trajectory<Frame>::ReadPointerFromMessage(
 template<typename Frame>
 typename Trajectory<Frame>::Iterator&
 Trajectory<Frame>::Iterator::operator++() {
+  if (spilled_ != nullptr) {
+    // Past the last spilled point we continue with the root timeline, which is
+    // where |current_| is.
+    if (++spilled_ == ancestry_.front()->spilled_timeline_->end()) {
+      spilled_ = nullptr;
+    }
+    return *this;
+  }
   if (!forks_.empty() && current_ == forks_.front().timeline) {
     // Skip over any timeline where the fork is at |end()|.  These are the ones
     // that were forked at the fork point of their parent.  Looking at the
@@ -352,11 +530,16 @@ Trajectory<Frame>::Iterator::operator++() {
 
 template<typename Frame>
 bool Trajectory<Frame>::Iterator::at_end() const {
-  return forks_.empty() && current_ == ancestry_.front()->timeline_.end();
+  return spilled_ == nullptr &&
+         forks_.empty() &&
+         current_ == ancestry_.front()->timeline_.end();
 }
 
 template<typename Frame>
 Instant const& Trajectory<Frame>::Iterator::time() const {
+  if (spilled_ != nullptr) {
+    return spilled_->time;
+  }
   return current_->first;
 }
 
@@ -370,7 +553,11 @@ void Trajectory<Frame>::Iterator::InitializeFirst(
     ancestor = ancestor->parent_;
   }
   ancestry_.push_front(ancestor);
-  current_ = ancestor->timeline_.begin();
+  current_ = ancestor->timeline_begin();
+  if (ancestor->spilled_timeline_ != nullptr &&
+      !ancestor->spilled_timeline_->empty()) {
+    spilled_ = ancestor->spilled_timeline_->begin();
+  }
   CHECK(!current_is_misplaced());
 }
 
@@ -385,7 +572,20 @@ void Trajectory<Frame>::Iterator::InitializeOnOrAfter(
     ancestor = ancestor->parent_;
   }
   ancestry_.push_front(ancestor);
-  current_ = ancestor->timeline_.lower_bound(time);
+  SpilledTimeline<Frame> const* const spilled_timeline =
+      ancestor->spilled_timeline_.get();
+  if (spilled_timeline != nullptr &&
+      !spilled_timeline->empty() &&
+      time <= (spilled_timeline->end() - 1)->time) {
+    current_ = ancestor->timeline_begin();
+    spilled_ = spilled_timeline->lower_bound(time);
+  } else {
+    current_ = ancestor->timeline_.lower_bound(time);
+    if (ancestor->detached_until_ != nullptr &&
+        time <= *ancestor->detached_until_) {
+      current_ = ancestor->timeline_begin();
+    }
+  }
   CHECK(!current_is_misplaced());
 }
 
@@ -393,7 +593,7 @@ template<typename Frame>
 void Trajectory<Frame>::Iterator::InitializeLast(
     not_null<Trajectory const*> const trajectory) {
   not_null<Trajectory const*> ancestor = trajectory;
-  if (ancestor->timeline_.empty()) {
+  if (ancestor->timeline_begin() == ancestor->timeline_.end()) {
     // The last trajectory is empty.  We go up until we find a trajectory which
     // is not forked at the fork point of its parent.  We must keep track of
     // that part of the ancestry so that |operator++| correctly detect the end
@@ -415,9 +615,12 @@ void Trajectory<Frame>::Iterator::InitializeLast(
 }
 
 template<typename Frame>
-typename Trajectory<Frame>::Timeline::const_iterator
-Trajectory<Frame>::Iterator::current() const {
-  return current_;
+DegreesOfFreedom<Frame> const&
+Trajectory<Frame>::Iterator::current_degrees_of_freedom() const {
+  if (spilled_ != nullptr) {
+    return spilled_->degrees_of_freedom;
+  }
+  return current_->second.degrees_of_freedom;
 }
 
 template<typename Frame>
@@ -434,15 +637,16 @@ bool Trajectory<Frame>::Iterator::current_is_misplaced() const {
 template<typename Frame>
 DegreesOfFreedom<Frame> const&
 Trajectory<Frame>::NativeIterator::degrees_of_freedom() const {
-  return this->current()->second;
+  return this->current_degrees_of_freedom();
 }
 
 template<typename Frame>
 template<typename ToFrame>
 DegreesOfFreedom<ToFrame>
 Trajectory<Frame>::TransformingIterator<ToFrame>::degrees_of_freedom() const {
-  auto it = this->current();
-  return transform_(it->first, it->second, this->trajectory());
+  return transform_(this->time(),
+                    this->current_degrees_of_freedom(),
+                    this->trajectory());
 }
 
 template<typename Frame>
@@ -458,7 +662,11 @@ Trajectory<Frame>::Trajectory(not_null<Body const*> const body,
                               Fork const& fork)
     : body_(body),
       fork_(new Fork(fork)),
-      parent_(parent) {}
+      parent_(parent),
+      arena_(make_not_null_unique<Arena>(parent->arena_.get())),
+      children_(typename Children::allocator_type(arena_.get())),
+      timeline_(typename Timeline::allocator_type(arena_.get())),
+      generation_(internal::NewGeneration()) {}
 
 template<typename Frame>
 Instant const& Trajectory<Frame>::ForkTime() const {
@@ -473,6 +681,16 @@ Instant const& Trajectory<Frame>::ForkTime() const {
   return fork.timeline->first;
 }
 
+template<typename Frame>
+typename Trajectory<Frame>::Timeline::const_iterator
+Trajectory<Frame>::timeline_begin() const {
+  if (detached_until_ == nullptr) {
+    return timeline_.begin();
+  } else {
+    return timeline_.upper_bound(*detached_until_);
+  }
+}
+
 template<typename Frame>
 void Trajectory<Frame>::WriteSubTreeToMessage(
     not_null<serialization::Trajectory*> const message) const {
@@ -490,9 +708,19 @@ void Trajectory<Frame>::WriteSubTreeToMessage(
     }
     child.WriteSubTreeToMessage(litter->add_trajectories());
   }
-  for (auto const& pair : timeline_) {
-    Instant const& instant = pair.first;
-    DegreesOfFreedom<Frame> const& degrees_of_freedom = pair.second;
+  if (spilled_timeline_ != nullptr) {
+    for (auto const& record : *spilled_timeline_) {
+      auto const instantaneous_degrees_of_freedom = message->add_timeline();
+      record.time.WriteToMessage(
+          instantaneous_degrees_of_freedom->mutable_instant());
+      record.degrees_of_freedom.WriteToMessage(
+          instantaneous_degrees_of_freedom->mutable_degrees_of_freedom());
+    }
+  }
+  for (auto it = timeline_begin(); it != timeline_.end(); ++it) {
+    Instant const& instant = it->first;
+    DegreesOfFreedom<Frame> const& degrees_of_freedom =
+        it->second.degrees_of_freedom;
     auto const instantaneous_degrees_of_freedom = message->add_timeline();
     instant.WriteToMessage(instantaneous_degrees_of_freedom->mutable_instant());
     degrees_of_freedom.WriteToMessage(
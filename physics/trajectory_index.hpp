@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "base/not_null.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "geometry/r3_element.hpp"
+#include "physics/trajectory.hpp"
+#include "quantities/quantities.hpp"
+
+namespace principia {
+
+using base::not_null;
+using geometry::Instant;
+using geometry::Position;
+using geometry::R3Element;
+using quantities::Length;
+
+namespace physics {
+
+// A spatio-temporal index over the positions of a trajectory.  The trajectory
+// is approximated by the straight segments joining its consecutive points, and
+// the index is a segment tree over these segments: each node holds the time
+// interval and the axis-aligned bounding box of the segments below it.  This
+// makes it possible to find the portions of the trajectory that intersect a
+// box, or that come close to a point, during a time interval without scanning
+// the entire trajectory: the complexity of the queries is O(Ln(|size|)) per
+// segment found, as the positions at the ends of the segments are read from
+// the trajectory.
+// The index is a snapshot: it doesn't track the changes to the trajectory,
+// except that |Extend| may be used to index the points appended after the
+// last indexed point.  The trajectory must outlive the index, and its indexed
+// points must not be removed.
+template<typename Frame>
+class TrajectoryIndex {
+ public:
+  // A maximal portion of the trajectory that matches a query.  The bounds are
+  // clipped to the time interval of the query and to the parts of the segments
+  // that match it.
+  struct Portion {
+    Instant first;
+    Instant last;
+  };
+
+  // Indexes all the points of |trajectory|.
+  explicit TrajectoryIndex(not_null<Trajectory<Frame> const*> const trajectory);
+
+  // Indexes the points of the trajectory that are after the last indexed
+  // point.  The points that were already indexed must not have changed.
+  void Extend();
+
+  // Returns the portions of the trajectory that intersect the box with
+  // opposite corners |min| and |max| during [|t1|, |t2|], in increasing time
+  // order.  The coordinates of |min| must be less than or equal to those of
+  // |max|.
+  std::vector<Portion> PortionsInBox(Position<Frame> const& min,
+                                     Position<Frame> const& max,
+                                     Instant const& t1,
+                                     Instant const& t2) const;
+
+  // Returns the portions of the trajectory that come within |radius| of
+  // |centre| during [|t1|, |t2|], in increasing time order.
+  std::vector<Portion> PortionsWithin(Position<Frame> const& centre,
+                                      Length const& radius,
+                                      Instant const& t1,
+                                      Instant const& t2) const;
+
+  // The number of indexed points.
+  std::int64_t size() const;
+
+ private:
+  // A node of the segment tree.  The leaves are the segments.  The nodes
+  // beyond the last segment are empty.
+  struct Node {
+    bool empty = true;
+    Instant begin;
+    Instant end;
+    R3Element<Length> min;
+    R3Element<Length> max;
+  };
+
+  void Append(Instant const& time, Position<Frame> const& position);
+
+  // Recomputes |nodes_[node]| from its children.
+  void Combine(std::int64_t const node);
+
+  // Calls |matches_segment| for all the segments that overlap [|t1|, |t2|] and
+  // are below nodes for which |matches_node| returns true, and appends the
+  // matching parts of the segments to |portions|.  |matches_segment| is given
+  // the coordinates of the origin of a segment, the vector from its origin to
+  // its end, and the range of its parameter, in [0, 1], that is in
+  // [|t1|, |t2|], which it may narrow.
+  template<typename NodePredicate, typename SegmentPredicate>
+  void Query(std::int64_t const node,
+             Instant const& t1,
+             Instant const& t2,
+             NodePredicate const& matches_node,
+             SegmentPredicate const& matches_segment,
+             not_null<std::vector<Portion>*> const portions) const;
+
+  not_null<Trajectory<Frame> const*> const trajectory_;
+
+  // The number of indexed points, and the time and coordinates with respect to
+  // the origin of |Frame| of the last one.
+  std::int64_t size_ = 0;
+  Instant last_time_;
+  R3Element<Length> last_coordinates_;
+
+  // The number of leaves of the tree, a power of 2.  The root is at index 1,
+  // the children of node i are at indices 2i and 2i + 1, and the segment i,
+  // which joins the points i and i + 1, is at index |capacity_| + i.
+  std::int64_t capacity_ = 1;
+  std::vector<Node> nodes_;
+};
+
+}  // namespace physics
+}  // namespace principia
+
+#include "physics/trajectory_index_body.hpp"
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "physics/trajectory_index.hpp"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "quantities/elementary_functions.hpp"
+#include "quantities/named_quantities.hpp"
+
+namespace principia {
+
+using quantities::Area;
+using quantities::Sqrt;
+using quantities::Time;
+
+namespace physics {
+
+template<typename Frame>
+TrajectoryIndex<Frame>::TrajectoryIndex(
+    not_null<Trajectory<Frame> const*> const trajectory)
+    : trajectory_(trajectory),
+      nodes_(2 * capacity_) {
+  Extend();
+}
+
+template<typename Frame>
+void TrajectoryIndex<Frame>::Extend() {
+  auto it = size_ == 0 ? trajectory_->first()
+                       : trajectory_->on_or_after(last_time_);
+  if (size_ > 0 && !it.at_end() && it.time() == last_time_) {
+    ++it;
+  }
+  for (; !it.at_end(); ++it) {
+    Append(it.time(), it.degrees_of_freedom().position());
+  }
+}
+
+template<typename Frame>
+std::vector<typename TrajectoryIndex<Frame>::Portion>
+TrajectoryIndex<Frame>::PortionsInBox(Position<Frame> const& min,
+                                      Position<Frame> const& max,
+                                      Instant const& t1,
+                                      Instant const& t2) const {
+  R3Element<Length> const box_min = (min - Frame::origin).coordinates();
+  R3Element<Length> const box_max = (max - Frame::origin).coordinates();
+  std::vector<Portion> portions;
+  Query(1, t1, t2,
+        [&box_min, &box_max](Node const& node) {
+          for (int i = 0; i < 3; ++i) {
+            if (node.max[i] < box_min[i] || node.min[i] > box_max[i]) {
+              return false;
+            }
+          }
+          return true;
+        },
+        [&box_min, &box_max](R3Element<Length> const& origin,
+                             R3Element<Length> const& direction,
+                             not_null<double*> const s_min,
+                             not_null<double*> const s_max) {
+          // Clip the parameter range of the segment against the slabs of the
+          // box.
+          for (int i = 0; i < 3; ++i) {
+            if (direction[i] == Length()) {
+              if (origin[i] < box_min[i] || origin[i] > box_max[i]) {
+                return false;
+              }
+            } else {
+              double s1 = (box_min[i] - origin[i]) / direction[i];
+              double s2 = (box_max[i] - origin[i]) / direction[i];
+              if (s1 > s2) {
+                std::swap(s1, s2);
+              }
+              *s_min = std::max(*s_min, s1);
+              *s_max = std::min(*s_max, s2);
+              if (*s_min > *s_max) {
+                return false;
+              }
+            }
+          }
+          return true;
+        },
+        &portions);
+  return portions;
+}
+
+template<typename Frame>
+std::vector<typename TrajectoryIndex<Frame>::Portion>
+TrajectoryIndex<Frame>::PortionsWithin(Position<Frame> const& centre,
+                                       Length const& radius,
+                                       Instant const& t1,
+                                       Instant const& t2) const {
+  R3Element<Length> const c = (centre - Frame::origin).coordinates();
+  Area const radius_squared = radius * radius;
+  std::vector<Portion> portions;
+  Query(1, t1, t2,
+        [&c, &radius_squared](Node const& node) {
+          // The squared distance from |c| to the box of |node|.
+          Area distance_squared;
+          for (int i = 0; i < 3; ++i) {
+            Length const excess = std::max(std::max(node.min[i] - c[i],
+                                                    c[i] - node.max[i]),
+                                           Length());
+            distance_squared += excess * excess;
+          }
+          return distance_squared <= radius_squared;
+        },
+        [&c, &radius_squared](R3Element<Length> const& origin,
+                              R3Element<Length> const& direction,
+                              not_null<double*> const s_min,
+                              not_null<double*> const s_max) {
+          // The point at parameter s is within |radius| of |c| if and only if
+          // a s² - 2 b s + d ≤ 0.
+          R3Element<Length> const from_origin = c - origin;
+          Area const a = Dot(direction, direction);
+          Area const b = Dot(from_origin, direction);
+          Area const d = Dot(from_origin, from_origin) - radius_squared;
+          if (a == Area()) {
+            return d <= Area();
+          }
+          auto const discriminant = b * b - a * d;
+          if (discriminant < decltype(discriminant)()) {
+            return false;
+          }
+          Area const root = Sqrt(discriminant);
+          *s_min = std::max(*s_min, (b - root) / a);
+          *s_max = std::min(*s_max, (b + root) / a);
+          return *s_min <= *s_max;
+        },
+        &portions);
+  return portions;
+}
+
+template<typename Frame>
+std::int64_t TrajectoryIndex<Frame>::size() const {
+  return size_;
+}
+
+template<typename Frame>
+void TrajectoryIndex<Frame>::Append(Instant const& time,
+                                    Position<Frame> const& position) {
+  CHECK(size_ == 0 || last_time_ < time)
+      << "Append out of order at " << time;
+  R3Element<Length> const coordinates =
+      (position - Frame::origin).coordinates();
+  ++size_;
+  Instant const previous_time = last_time_;
+  R3Element<Length> const previous_coordinates = last_coordinates_;
+  last_time_ = time;
+  last_coordinates_ = coordinates;
+  if (size_ < 2) {
+    return;
+  }
+  std::int64_t const segment = size_ - 2;
+  if (segment == capacity_) {
+    // Double the capacity and rebuild the tree from its leaves.  The cost is
+    // amortized over the appends.
+    std::vector<Node> nodes(2 * 2 * capacity_);
+    std::copy(nodes_.begin() + capacity_, nodes_.end(),
+              nodes.begin() + 2 * capacity_);
+    capacity_ *= 2;
+    nodes_.swap(nodes);
+    for (std::int64_t node = capacity_ - 1; node >= 1; --node) {
+      Combine(node);
+    }
+  }
+  Node& leaf = nodes_[capacity_ + segment];
+  leaf.empty = false;
+  leaf.begin = previous_time;
+  leaf.end = time;
+  for (int i = 0; i < 3; ++i) {
+    leaf.min[i] = std::min(previous_coordinates[i], coordinates[i]);
+    leaf.max[i] = std::max(previous_coordinates[i], coordinates[i]);
+  }
+  for (std::int64_t node = (capacity_ + segment) / 2; node >= 1; node /= 2) {
+    Combine(node);
+  }
+}
+
+template<typename Frame>
+void TrajectoryIndex<Frame>::Combine(std::int64_t const node) {
+  Node const& left = nodes_[2 * node];
+  Node const& right = nodes_[2 * node + 1];
+  Node& parent = nodes_[node];
+  if (left.empty) {
+    // The segments are filled from the left, so |right| is empty too.
+    parent = Node();
+  } else if (right.empty) {
+    parent = left;
+  } else {
+    parent.empty = false;
+    parent.begin = left.begin;
+    parent.end = right.end;
+    for (int i = 0; i < 3; ++i) {
+      parent.min[i] = std::min(left.min[i], right.min[i]);
+      parent.max[i] = std::max(left.max[i], right.max[i]);
+    }
+  }
+}
+
+template<typename Frame>
+template<typename NodePredicate, typename SegmentPredicate>
+void TrajectoryIndex<Frame>::Query(
+    std::int64_t const node,
+    Instant const& t1,
+    Instant const& t2,
+    NodePredicate const& matches_node,
+    SegmentPredicate const& matches_segment,
+    not_null<std::vector<Portion>*> const portions) const {
+  Node const& n = nodes_[node];
+  if (n.empty || n.end < t1 || n.begin > t2 || !matches_node(n)) {
+    return;
+  }
+  if (node < capacity_) {
+    Query(2 * node, t1, t2, matches_node, matches_segment, portions);
+    Query(2 * node + 1, t1, t2, matches_node, matches_segment, portions);
+    return;
+  }
+  Time const duration = n.end - n.begin;
+  double s_min = (std::max(n.begin, t1) - n.begin) / duration;
+  double s_max = (std::min(n.end, t2) - n.begin) / duration;
+  auto it = trajectory_->on_or_after(n.begin);
+  R3Element<Length> const origin =
+      (it.degrees_of_freedom().position() - Frame::origin).coordinates();
+  ++it;
+  R3Element<Length> const direction =
+      (it.degrees_of_freedom().position() - Frame::origin).coordinates() -
+      origin;
+  if (!matches_segment(origin, direction, &s_min, &s_max)) {
+    return;
+  }
+  // Don't round the bounds of the segment.
+  Instant const first = s_min == 0 ? n.begin : n.begin + s_min * duration;
+  Instant const last = s_max == 1 ? n.end : n.begin + s_max * duration;
+  if (!portions->empty() && portions->back().last == first) {
+    portions->back().last = last;
+  } else {
+    portions->push_back({first, last});
+  }
+}
+
+}  // namespace physics
+}  // namespace principia
@@ -0,0 +1,145 @@
+#include "physics/trajectory_index.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "geometry/frame.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "physics/massless_body.hpp"
+#include "physics/trajectory.hpp"
+#include "quantities/quantities.hpp"
+#include "quantities/si.hpp"
+
+namespace principia {
+
+using geometry::Frame;
+using geometry::Instant;
+using geometry::Vector;
+using quantities::Length;
+using si::Metre;
+using si::Second;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+namespace physics {
+
+class TrajectoryIndexTest : public testing::Test {
+ protected:
+  using World = Frame<serialization::Frame::TestTag,
+                      serialization::Frame::TEST1, true>;
+  using Portion = TrajectoryIndex<World>::Portion;
+
+  TrajectoryIndexTest() : trajectory_(&body_) {}
+
+  // Appends the points at times |first| to |last| seconds, where the x
+  // coordinate of the point at time t seconds is |x(t)| metres.
+  template<typename X>
+  void AppendPoints(int const first, int const last, X const& x) {
+    for (int t = first; t <= last; ++t) {
+      trajectory_.Append(
+          t0_ + t * Second,
+          {MakePosition(x(t) * Metre, 0 * Metre, 0 * Metre),
+           Velocity<World>()});
+    }
+  }
+
+  static Position<World> MakePosition(Length const& x,
+                                      Length const& y,
+                                      Length const& z) {
+    return Position<World>() + Vector<Length, World>({x, y, z});
+  }
+
+  Instant Time(double const t) const {
+    return t0_ + t * Second;
+  }
+
+  MasslessBody body_;
+  Trajectory<World> trajectory_;
+  Instant const t0_;
+};
+
+MATCHER_P2(IsPortion, first, last, "") {
+  return arg.first == first && arg.last == last;
+}
+
+TEST_F(TrajectoryIndexTest, Empty) {
+  TrajectoryIndex<World> index(&trajectory_);
+  EXPECT_EQ(0, index.size());
+  EXPECT_THAT(
+      index.PortionsWithin(MakePosition(0 * Metre, 0 * Metre, 0 * Metre),
+                           1 * Metre,
+                           Time(0),
+                           Time(100)),
+      IsEmpty());
+}
+
+TEST_F(TrajectoryIndexTest, Box) {
+  AppendPoints(0, 99, [](int const t) { return t; });
+  TrajectoryIndex<World> index(&trajectory_);
+  EXPECT_EQ(100, index.size());
+
+  Position<World> const min =
+      MakePosition(10.5 * Metre, -1 * Metre, -1 * Metre);
+  Position<World> const max =
+      MakePosition(20.5 * Metre, 1 * Metre, 1 * Metre);
+  EXPECT_THAT(index.PortionsInBox(min, max, Time(0), Time(99)),
+              ElementsAre(IsPortion(Time(10.5), Time(20.5))));
+  EXPECT_THAT(index.PortionsInBox(min, max, Time(15), Time(17.5)),
+              ElementsAre(IsPortion(Time(15), Time(17.5))));
+  EXPECT_THAT(index.PortionsInBox(min, max, Time(30), Time(99)), IsEmpty());
+  EXPECT_THAT(index.PortionsInBox(
+                  MakePosition(10.5 * Metre, 0.5 * Metre, -1 * Metre),
+                  MakePosition(20.5 * Metre, 1 * Metre, 1 * Metre),
+                  Time(0),
+                  Time(99)),
+              IsEmpty());
+}
+
+TEST_F(TrajectoryIndexTest, Within) {
+  AppendPoints(0, 99, [](int const t) { return t; });
+  TrajectoryIndex<World> index(&trajectory_);
+
+  // The trajectory is within 5 m of the centre for x in [46.5 m, 54.5 m].
+  Position<World> const centre =
+      MakePosition(50.5 * Metre, 3 * Metre, 0 * Metre);
+  EXPECT_THAT(index.PortionsWithin(centre, 5 * Metre, Time(0), Time(99)),
+              ElementsAre(IsPortion(Time(46.5), Time(54.5))));
+  EXPECT_THAT(index.PortionsWithin(centre, 5 * Metre, Time(52), Time(99)),
+              ElementsAre(IsPortion(Time(52), Time(54.5))));
+  EXPECT_THAT(index.PortionsWithin(centre, 2.5 * Metre, Time(0), Time(99)),
+              IsEmpty());
+}
+
+TEST_F(TrajectoryIndexTest, SeveralPortions) {
+  // Go out to x = 50 m and come back.
+  AppendPoints(0, 100, [](int const t) { return t <= 50 ? t : 100 - t; });
+  TrajectoryIndex<World> index(&trajectory_);
+  EXPECT_THAT(index.PortionsInBox(
+                  MakePosition(10.5 * Metre, -1 * Metre, -1 * Metre),
+                  MakePosition(11.5 * Metre, 1 * Metre, 1 * Metre),
+                  Time(0),
+                  Time(100)),
+              ElementsAre(IsPortion(Time(10.5), Time(11.5)),
+                          IsPortion(Time(88.5), Time(89.5))));
+}
+
+TEST_F(TrajectoryIndexTest, Extend) {
+  AppendPoints(0, 10, [](int const t) { return t; });
+  TrajectoryIndex<World> index(&trajectory_);
+  Position<World> const centre =
+      MakePosition(30 * Metre, 0 * Metre, 0 * Metre);
+  EXPECT_THAT(index.PortionsWithin(centre, 1 * Metre, Time(0), Time(100)),
+              IsEmpty());
+
+  AppendPoints(11, 40, [](int const t) { return t; });
+  index.Extend();
+  EXPECT_EQ(41, index.size());
+  EXPECT_THAT(index.PortionsWithin(centre, 1 * Metre, Time(0), Time(100)),
+              ElementsAre(IsPortion(Time(29), Time(31))));
+}
+
+}  // namespace physics
+}  // namespace principia
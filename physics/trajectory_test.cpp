@@ -391,6 +391,56 @@ TEST_F(TrajectoryTest, PointerSerializationSuccess) {
   EXPECT_EQ(massive_trajectory.get(),
             Trajectory<World>::ReadPointerFromMessage(
                 root_it, massive_trajectory.get()));
+
+  // The distances don't count the forgotten points.
+  massive_trajectory_->ForgetBefore(t1_);
+  serialization::Trajectory::Pointer fork3_it;
+  fork3->WritePointerToMessage(&fork3_it);
+  EXPECT_EQ(2, fork3_it.fork(0).children_distance());
+  EXPECT_EQ(1, fork3_it.fork(0).timeline_distance());
+  EXPECT_EQ(fork3,
+            Trajectory<World>::ReadPointerFromMessage(
+                fork3_it,
+                massive_trajectory_.get()));
+}
+
+// Checks that the distances stay correct when forks are inserted before or
+// deleted from among other forks, and when points are detached.
+TEST_F(TrajectoryTest, PointerSerializationRenumbering) {
+  massive_trajectory_->Append(t1_, d1_);
+  massive_trajectory_->Append(t2_, d2_);
+  massive_trajectory_->Append(t3_, d3_);
+  massive_trajectory_->Append(t4_, d4_);
+  not_null<Trajectory<World>*> const fork3 = massive_trajectory_->NewFork(t3_);
+  Trajectory<World>* fork1 = massive_trajectory_->NewFork(t1_);
+  not_null<Trajectory<World>*> const fork2 = massive_trajectory_->NewFork(t2_);
+  auto const expect_pointer = [this](not_null<Trajectory<World>*> const fork,
+                                     int const children_distance,
+                                     int const timeline_distance) {
+    serialization::Trajectory::Pointer message;
+    fork->WritePointerToMessage(&message);
+    ASSERT_EQ(1, message.fork_size());
+    EXPECT_EQ(children_distance, message.fork(0).children_distance());
+    EXPECT_EQ(timeline_distance, message.fork(0).timeline_distance());
+    EXPECT_EQ(fork,
+              Trajectory<World>::ReadPointerFromMessage(
+                  message,
+                  massive_trajectory_.get()));
+  };
+  expect_pointer(fork1, 0, 0);
+  expect_pointer(fork2, 1, 1);
+  expect_pointer(fork3, 2, 2);
+
+  massive_trajectory_->DeleteFork(&fork1);
+  expect_pointer(fork2, 0, 1);
+  expect_pointer(fork3, 1, 2);
+
+  // The detached points and children are not counted, before and after the
+  // points are reclaimed.
+  massive_trajectory_->DetachBefore(t2_);
+  expect_pointer(fork3, 0, 0);
+  EXPECT_EQ(2, massive_trajectory_->ReclaimDetachedPoints(1000));
+  expect_pointer(fork3, 0, 0);
 }
 
 TEST_F(TrajectoryDeathTest, TrajectorySerializationError) {
@@ -662,6 +712,192 @@ TEST_F(TrajectoryTest, ForgetBeforeSuccess) {
   // Don't use fork, it is dangling.
 }
 
+TEST_F(TrajectoryTest, ForgetBeforeReleasesMemory) {
+  Instant t = t1_;
+  for (int i = 0; i < 100000; ++i) {
+    massive_trajectory_->Append(t, d1_);
+    t += 1 * Second;
+  }
+  std::int64_t const peak_reserved_bytes =
+      massive_trajectory_->reserved_bytes();
+  EXPECT_LT(100000 * sizeof(DegreesOfFreedom<World>), peak_reserved_bytes);
+
+  // The memory of the forgotten points goes back to the system, not just to
+  // the free lists of the arena.
+  massive_trajectory_->ForgetBefore(t - 1001 * Second);
+  EXPECT_EQ(1000, massive_trajectory_->Times().size());
+  EXPECT_GT(peak_reserved_bytes / 20, massive_trajectory_->reserved_bytes());
+
+  // Appending reuses the memory that is left before reserving more.
+  std::int64_t const reserved_bytes = massive_trajectory_->reserved_bytes();
+  for (int i = 0; i < 1000; ++i) {
+    massive_trajectory_->Append(t, d1_);
+    t += 1 * Second;
+  }
+  EXPECT_GT(2 * reserved_bytes + (1 << 16),
+            massive_trajectory_->reserved_bytes());
+}
+
+TEST_F(TrajectoryDeathTest, SpillError) {
+  EXPECT_DEATH({
+    massive_trajectory_->Append(t1_, d1_);
+    massive_trajectory_->SpillBefore(t1_);
+  }, "not enabled");
+  EXPECT_DEATH({
+    massive_trajectory_->Append(t1_, d1_);
+    not_null<Trajectory<World>*> const fork = massive_trajectory_->NewFork(t1_);
+    fork->EnableSpilling("trajectory_test.spill");
+  }, "nonroot");
+  EXPECT_DEATH({
+    massive_trajectory_->Append(t1_, d1_);
+    massive_trajectory_->Append(t2_, d2_);
+    massive_trajectory_->EnableSpilling("trajectory_test.spill");
+    massive_trajectory_->SpillBefore(t1_);
+    massive_trajectory_->NewFork(t1_);
+  }, "nonexistent time");
+}
+
+TEST_F(TrajectoryTest, SpillSuccess) {
+  massive_trajectory_->EnableSpilling("trajectory_test.spill");
+  massive_trajectory_->Append(t1_, d1_);
+  massive_trajectory_->Append(t2_, d2_);
+  massive_trajectory_->Append(t3_, d3_);
+  Trajectory<World>* fork = massive_trajectory_->NewFork(t3_);
+  fork->Append(t4_, d4_);
+
+  // The fork point and the points that follow are not spilled.
+  massive_trajectory_->SpillBefore(t4_);
+  EXPECT_EQ(2, massive_trajectory_->spilled_points());
+  EXPECT_EQ(1, massive_trajectory_->resident_points());
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t1_, t2_, t3_));
+  EXPECT_THAT(fork->Positions(), ElementsAre(testing::Pair(t1_, q1_),
+                                             testing::Pair(t2_, q2_),
+                                             testing::Pair(t3_, q3_),
+                                             testing::Pair(t4_, q4_)));
+  EXPECT_THAT(fork->Velocities(), ElementsAre(testing::Pair(t1_, p1_),
+                                              testing::Pair(t2_, p2_),
+                                              testing::Pair(t3_, p3_),
+                                              testing::Pair(t4_, p4_)));
+
+  Trajectory<World>::NativeIterator it = fork->on_or_after(t0_);
+  EXPECT_EQ(t1_, it.time());
+  EXPECT_EQ(d1_, it.degrees_of_freedom());
+  it = fork->on_or_after(t2_);
+  EXPECT_EQ(t2_, it.time());
+  EXPECT_EQ(d2_, it.degrees_of_freedom());
+  it = fork->on_or_after(t2_ + 1 * Second);
+  EXPECT_EQ(t3_, it.time());
+  EXPECT_EQ(d3_, it.degrees_of_freedom());
+  it = massive_trajectory_->last();
+  EXPECT_EQ(t3_, it.time());
+
+  // Spilled points are serialized.
+  serialization::Trajectory message;
+  massive_trajectory_->WriteToMessage(&message);
+  EXPECT_EQ(3, message.timeline_size());
+  serialization::Trajectory::Pointer pointer_message;
+  fork->WritePointerToMessage(&pointer_message);
+  EXPECT_EQ(2, pointer_message.fork(0).timeline_distance());
+
+  // Without forks, everything but the last point is spilled.
+  massive_trajectory_->DeleteFork(&fork);
+  massive_trajectory_->SpillBefore(t4_);
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t1_, t2_, t3_));
+  massive_trajectory_->Append(t4_, d4_);
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t1_, t2_, t3_, t4_));
+
+  massive_trajectory_->ForgetBefore(t1_);
+  EXPECT_EQ(1, massive_trajectory_->spilled_points());
+  EXPECT_EQ(2, massive_trajectory_->resident_points());
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t2_, t3_, t4_));
+  // Forgetting all the points in memory brings back the last spilled point.
+  massive_trajectory_->ForgetAfter(t2_);
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t2_));
+  EXPECT_EQ(d2_, massive_trajectory_->last().degrees_of_freedom());
+  massive_trajectory_->Append(t3_, d3_);
+  EXPECT_THAT(massive_trajectory_->Positions(),
+              ElementsAre(testing::Pair(t2_, q2_), testing::Pair(t3_, q3_)));
+}
+
+TEST_F(TrajectoryTest, SpillAfterDetach) {
+  massive_trajectory_->EnableSpilling("trajectory_test.spill");
+  massive_trajectory_->Append(t1_, d1_);
+  massive_trajectory_->Append(t2_, d2_);
+  massive_trajectory_->Append(t3_, d3_);
+  massive_trajectory_->Append(t4_, d4_);
+  massive_trajectory_->DetachBefore(t2_);
+
+  // The detached points are not reclaimed by spilling, so nothing is spilled.
+  massive_trajectory_->SpillBefore(t3_);
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t3_, t4_));
+  EXPECT_EQ(2, massive_trajectory_->ReclaimDetachedPoints(10));
+
+  massive_trajectory_->SpillBefore(t3_);
+  EXPECT_THAT(massive_trajectory_->Positions(),
+              ElementsAre(testing::Pair(t3_, q3_), testing::Pair(t4_, q4_)));
+  serialization::Trajectory message;
+  massive_trajectory_->WriteToMessage(&message);
+  EXPECT_EQ(2, message.timeline_size());
+}
+
+TEST_F(TrajectoryDeathTest, DetachBeforeError) {
+  EXPECT_DEATH({
+    massive_trajectory_->Append(t1_, d1_);
+    not_null<Trajectory<World>*> const fork = massive_trajectory_->NewFork(t1_);
+    fork->DetachBefore(t1_);
+  }, "nonroot");
+  EXPECT_DEATH({
+    massive_trajectory_->Append(t1_, d1_);
+    massive_trajectory_->Append(t2_, d2_);
+    massive_trajectory_->DetachBefore(t1_);
+    massive_trajectory_->NewFork(t1_);
+  }, "detached time");
+}
+
+TEST_F(TrajectoryTest, DetachBeforeSuccess) {
+  massive_trajectory_->Append(t1_, d1_);
+  massive_trajectory_->Append(t2_, d2_);
+  massive_trajectory_->Append(t3_, d3_);
+  not_null<Trajectory<World>*> const fork1 = massive_trajectory_->NewFork(t1_);
+  not_null<Trajectory<World>*> const fork3 = massive_trajectory_->NewFork(t3_);
+  fork3->Append(t4_, d4_);
+
+  massive_trajectory_->DetachBefore(t1_);
+  massive_trajectory_->DetachBefore(t2_);
+  massive_trajectory_->DetachBefore(t1_);
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t3_));
+  EXPECT_THAT(fork3->Positions(), ElementsAre(testing::Pair(t3_, q3_),
+                                              testing::Pair(t4_, q4_)));
+  EXPECT_EQ(t3_, massive_trajectory_->on_or_after(t0_).time());
+  EXPECT_EQ(t3_, massive_trajectory_->last().time());
+  // Don't use fork1, it is dangling.
+
+  serialization::Trajectory message;
+  massive_trajectory_->WriteToMessage(&message);
+  EXPECT_EQ(1, message.timeline_size());
+  serialization::Trajectory::Pointer pointer_message;
+  fork3->WritePointerToMessage(&pointer_message);
+  EXPECT_EQ(0, pointer_message.fork(0).children_distance());
+  EXPECT_EQ(0, pointer_message.fork(0).timeline_distance());
+
+  EXPECT_EQ(1, massive_trajectory_->ReclaimDetachedPoints(1));
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t3_));
+  pointer_message.Clear();
+  fork3->WritePointerToMessage(&pointer_message);
+  EXPECT_EQ(0, pointer_message.fork(0).timeline_distance());
+  EXPECT_EQ(1, massive_trajectory_->ReclaimDetachedPoints(2));
+  EXPECT_EQ(0, massive_trajectory_->ReclaimDetachedPoints(1));
+  EXPECT_THAT(massive_trajectory_->Times(), ElementsAre(t3_));
+  pointer_message.Clear();
+  fork3->WritePointerToMessage(&pointer_message);
+  EXPECT_EQ(0, pointer_message.fork(0).timeline_distance());
+
+  massive_trajectory_->Append(t4_, d4_);
+  massive_trajectory_->DetachBefore(t4_);
+  EXPECT_TRUE(massive_trajectory_->Times().empty());
+  EXPECT_TRUE(massive_trajectory_->first().at_end());
+}
+
 TEST_F(TrajectoryDeathTest, IntrinsicAccelerationError) {
   EXPECT_DEATH({
     massive_trajectory_->set_intrinsic_acceleration(
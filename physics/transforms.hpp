@@ -1,18 +1,34 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "base/macros.hpp"
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
+#include "geometry/grassmann.hpp"
+#include "geometry/named_quantities.hpp"
+#include "geometry/rotation.hpp"
 #include "physics/frame_field.hpp"
 #include "physics/trajectory.hpp"
+#include "quantities/named_quantities.hpp"
 
 namespace principia {
 
 using base::not_null;
+using base::ThreadPool;
+using geometry::Bivector;
+using geometry::Position;
+using geometry::Rotation;
+using geometry::Velocity;
+using quantities::AngularFrequency;
 
 namespace physics {
 
@@ -28,6 +44,13 @@ class Transforms {
                 "Both FromFrame and ToFrame must be inertial");
 
  public:
+  // Counters describing the effectiveness of a cache.
+  struct CacheStatistics {
+    std::int64_t hits = 0;
+    std::int64_t misses = 0;
+    std::int64_t evictions = 0;
+  };
+
   // The trajectories are evaluated lazily because they may be extended or
   // deallocated/reallocated between the time when the transforms are created
   // and the time when they are applied.  Thus, the lambdas couldn't capture the
@@ -76,16 +99,82 @@ class Transforms {
   typename Trajectory<ThroughFrame>:: template TransformingIterator<ToFrame>
   second(Trajectory<ThroughFrame> const& through_trajectory);
 
+  // Receives the time, position and velocity of each point transformed by
+  // |TransformRange|.
+  using PointSink = std::function<void(Instant const& time,
+                                       Position<ToFrame> const& position,
+                                       Velocity<ToFrame> const& velocity)>;
+
+  // Decides whether the point at |time| is transformed by |TransformRange|.
+  using PointFilter = std::function<bool(Instant const& time)>;
+
+  // Applies the composition of the |first| and |second| transforms to the
+  // points of the trajectory of |mobile| denoted by |from_trajectory| whose
+  // times are in [|t1|, |t2|], and passes the results to |sink| in increasing
+  // time order.  No intermediate trajectory is built.  Contrary to |second|,
+  // which looks at the last points of the |to_trajectory| for each point that
+  // it transforms, the transform to |ToFrame| is computed once, at the
+  // beginning of the call, and is applied as a matrix product.
+  // If |pool| is null, the points are streamed one at a time and the memory
+  // used is independent of the length of the trajectory.  Otherwise, the
+  // points are transformed in parallel on the threads of |pool|, by windows
+  // of bounded size.  The results are the same as those of the serial
+  // computation, in the same order.
+  // For the cacheable trajectories, the results of the |first| transform for
+  // the last points of the range are kept from one call to the next, so only
+  // the points appended since the previous call, and those that precede the
+  // kept points, go through it.  The results are only kept for a bounded
+  // number of points and of recently transformed trajectories.  The cost of
+  // the |second| transform, which changes with time, remains proportional to
+  // the number of points.
+  // If |filter| is not null, it is called once for each point of the range, in
+  // increasing time order, and the points that it rejects are not passed to
+  // |sink|.  They don't go through the |second| transform, nor through the
+  // |first| one unless they are appended to the cached results.
+  void TransformRange(Mobile const& mobile,
+                      LazyTrajectory<FromFrame> const& from_trajectory,
+                      Instant const& t1,
+                      Instant const& t2,
+                      PointSink const& sink,
+                      ThreadPool* const pool = nullptr,
+                      PointFilter const& filter = nullptr);
+
+  // Same as above, but appends the results to |times|, |positions| and
+  // |velocities|, which must have the same size.
+  void TransformRange(Mobile const& mobile,
+                      LazyTrajectory<FromFrame> const& from_trajectory,
+                      Instant const& t1,
+                      Instant const& t2,
+                      not_null<std::vector<Instant>*> const times,
+                      not_null<std::vector<Position<ToFrame>>*> const positions,
+                      not_null<std::vector<Velocity<ToFrame>>*> const
+                          velocities,
+                      ThreadPool* const pool = nullptr);
+
   // The coordinate frame of |ThroughFrame|, expressed in the coordinates of
   // |ToFrame| at the current time.
   FrameField<ToFrame> coordinate_frame() const;
 
+  // The statistics of the cache for the result of the |first| transform.
+  CacheStatistics first_cache_statistics() const;
+
+  // The statistics of the table of the definitions of |ThroughFrame| at the
+  // times of the points transformed by |first|.  Only used by
+  // |BarycentricRotating|.  A miss is a frame that was computed, an eviction
+  // a frame that was dropped from the table.
+  CacheStatistics frame_table_statistics() const;
+
  private:
+  class Cursor;
+  struct Cursors;
+
   // Just like a |Trajectory::Transform|, except that the first parameter is
-  // only bound when we know which trajectory to extract from the |Mobile|.
+  // only bound when we know which trajectory to extract from the |Mobile|, and
+  // the second one is the state of the walk along that trajectory.
   template<typename Frame1, typename Frame2>
   using LazyTransform = std::function<DegreesOfFreedom<Frame2>(
                             LazyTrajectory<Frame1> const&,
+                            not_null<Cursors*> const,
                             Instant const&,
                             DegreesOfFreedom<Frame1> const&,
                             not_null<Trajectory<Frame1> const*> const)>;
@@ -93,24 +182,138 @@ class Transforms {
   LazyTransform<FromFrame, ThroughFrame> first_;
   typename Trajectory<ThroughFrame>::template Transform<ToFrame> second_;
 
-  // A simple cache with no eviction, which monitors the hit rate.
-  template<typename Frame1, typename Frame2>
+  // Receives the time and the result of |first_| for each point transformed
+  // by |TransformFirstRange|.
+  using ThroughSink = std::function<void(
+      Instant const& time,
+      DegreesOfFreedom<ThroughFrame> const& degrees_of_freedom)>;
+
+  // Applies |first_| to the points of |trajectory|, which is the trajectory of
+  // a mobile denoted by |from_trajectory|, from |it| to the last point at or
+  // before |t2|, and passes the results to |sink| in increasing time order.
+  // If |pool| is not null the points are transformed in parallel, as described
+  // for |TransformRange|.  If |filter| is not null, the points that it rejects
+  // are skipped before being transformed.
+  void TransformFirstRange(
+      Trajectory<FromFrame> const& trajectory,
+      LazyTrajectory<FromFrame> const& from_trajectory,
+      typename Trajectory<FromFrame>::NativeIterator it,
+      Instant const& t2,
+      ThroughSink const& sink,
+      ThreadPool* const pool,
+      PointFilter const& filter);
+
+  // Computes the parameters of |second_| at the current time: |*rotation| is
+  // the linear part of the map from |ThroughFrame| to |ToFrame|, and |*origin|
+  // is the image of the origin of |ThroughFrame|.
+  std::function<void(not_null<Rotation<ThroughFrame, ToFrame>*> const rotation,
+                     not_null<Position<ToFrame>*> const origin)>
+      second_parameters_;
+
+  // A position in the trajectory of one of the bodies that define
+  // |ThroughFrame|.  The iterators returned by |first| visit increasing times,
+  // so the degrees of freedom of these bodies are found by walking their
+  // trajectories in lockstep with the iterator instead of searching them for
+  // each point.
+  class Cursor {
+   public:
+    // Returns the degrees of freedom of |trajectory| at |time|, which must be
+    // the time of a point of |trajectory|.  The complexity is amortized O(1)
+    // when the successive calls are for the same trajectory at increasing
+    // times that are close to each other, and O(|depth| + Ln(|length|))
+    // otherwise.
+    DegreesOfFreedom<FromFrame> const& DegreesOfFreedomAt(
+        Trajectory<FromFrame> const& trajectory,
+        Instant const& time);
+
+    // Forgets the current position.  Must be called before the trajectory is
+    // modified.
+    void Reset();
+
+   private:
+    Trajectory<FromFrame> const* trajectory_ = nullptr;
+    std::unique_ptr<typename Trajectory<FromFrame>::NativeIterator>
+        iterator_;  // std::optional.
+  };
+
+  // A hashed cache holding at most |capacity| entries, with CLOCK eviction.
+  // The storage is allocated as the entries are inserted, so an unused cache
+  // is cheap.
+  // The entries are keyed by the generation of the trajectory, not by its
+  // address, so they remain valid as long as the trajectory is only appended
+  // to, and they are never found once it has been truncated or destroyed.
+  // This class is thread-safe, but the calls that are given |Updates| don't
+  // lock, so that concurrent walks don't contend for the cache: they may only
+  // run concurrently with each other.
+  template<typename Value>
   class Cache {
    public:
-    bool Lookup(not_null<Trajectory<Frame1> const*> const trajectory,
+    // The effects of calls to |Lookup| and |Insert| that are deferred until
+    // |Apply| is called.
+    struct Updates {
+      struct Insertion {
+        std::int64_t generation;
+        Instant time;
+        Value value;
+      };
+
+      std::int64_t misses = 0;
+      // The indices in |entries_| of the entries that were found.
+      std::vector<std::int64_t> hits;
+      std::vector<Insertion> insertions;
+    };
+
+    explicit Cache(std::int64_t const capacity);
+
+    // If found, the value cached for the trajectory with the given
+    // |generation| at |time| is copied to |*value|.  If |updates| is not null,
+    // the hit or miss is recorded there instead of in the cache.
+    bool Lookup(std::int64_t const generation,
                 Instant const& time,
-                not_null<DegreesOfFreedom<Frame2>**> degrees_of_freedom);
+                not_null<Value*> const value,
+                Updates* const updates = nullptr);
 
-    void Insert(not_null<Trajectory<Frame1> const*> const trajectory,
+    // Replaces the value cached for the given |generation| and |time|, if any.
+    // If |updates| is not null, the insertion is only recorded there.
+    void Insert(std::int64_t const generation,
                 Instant const& time,
-                DegreesOfFreedom<Frame2> const& degrees_of_freedom);
+                Value const& value,
+                Updates* const updates = nullptr);
+
+    // Applies the |updates| recorded by the calls above, in order.  No call
+    // with |updates| may happen concurrently.
+    void Apply(std::vector<Updates> const& updates);
+
+    CacheStatistics statistics() const;
 
    private:
-    std::map<std::pair<not_null<Trajectory<Frame1> const*>, Instant const>,
-             DegreesOfFreedom<Frame2>> map_;
-    std::map<not_null<Trajectory<Frame1> const*>, std::int64_t>
-        number_of_lookups_;
-    std::map<not_null<Trajectory<Frame1> const*>, std::int64_t> number_of_hits_;
+    // The generation of the trajectory and the time.
+    using Key = std::pair<std::int64_t, Instant>;
+
+    struct KeyHash {
+      std::size_t operator()(Key const& key) const;
+    };
+
+    struct Entry {
+      Entry(Key const& key, Value const& value);
+
+      Key key;
+      Value value;
+      // Set when the entry is used, cleared when the clock hand passes over
+      // it.  An entry is evicted when the hand finds it cleared.
+      bool referenced;
+    };
+
+    // |lock_| must be held.
+    void InsertLocked(Key const& key, Value const& value);
+
+    std::int64_t const capacity_;
+    mutable std::mutex lock_;
+    std::vector<Entry> entries_ GUARDED_BY(lock_);
+    // The index of the entry for each key in |entries_|.
+    std::unordered_map<Key, std::int64_t, KeyHash> indices_ GUARDED_BY(lock_);
+    std::int64_t hand_ GUARDED_BY(lock_) = 0;
+    CacheStatistics statistics_ GUARDED_BY(lock_);
   };
 
   // Using a vector, not a set, because (1) this is small and (2) writing a
@@ -119,8 +322,121 @@ class Transforms {
 
   // A cache for the result of the |first_| transform.  This cache assumes that
   // the iterator is never called with the same time but different degrees of
-  // freedom.
-  Cache<FromFrame, ThroughFrame> first_cache_;
+  // freedom for a given generation of a trajectory.
+  Cache<DegreesOfFreedom<ThroughFrame>> first_cache_{1 << 16};
+
+  // The definition of a barycentric rotating frame at some time, as computed
+  // from the trajectories of its bodies.
+  struct BarycentricFrame {
+    DegreesOfFreedom<FromFrame> barycentre_degrees_of_freedom;
+    Rotation<FromFrame, ThroughFrame> rotation;
+    Bivector<AngularFrequency, FromFrame> angular_frequency;
+  };
+
+  // The frames used by the |first_| transform of |BarycentricRotating|,
+  // ordered by time.  The mobiles rendered in a frame generally have points at
+  // the same times, which are those of the bodies, and they are transformed
+  // one after the other in increasing time order.  Thus the frames are
+  // appended by the first mobile and found by walking a cursor for the others,
+  // which is much cheaper than hashing.
+  // The table holds the frames for a single pair of generations of the
+  // trajectories of the bodies; it is cleared when either of them changes.
+  // The calls that are given |Updates| may run concurrently with each other,
+  // but not with the other calls.
+  class FrameTable {
+   public:
+    // The effects of calls to |Find| and |Append| that are deferred until
+    // |Apply| is called.
+    struct Updates {
+      std::int64_t hits = 0;
+      std::int64_t misses = 0;
+      // The generations for which the frames below were computed.
+      std::int64_t primary_generation = 0;
+      std::int64_t secondary_generation = 0;
+      std::vector<Instant> times;
+      std::vector<BarycentricFrame> frames;
+    };
+
+    // If the table has a frame for the given generations at |time|, it is
+    // copied to |*frame|.  |*cursor| is an index in the table, which is
+    // updated so that finding the frames at increasing times is cheap.
+    bool Find(std::int64_t const primary_generation,
+              std::int64_t const secondary_generation,
+              Instant const& time,
+              not_null<std::int64_t*> const cursor,
+              not_null<BarycentricFrame*> const frame,
+              Updates* const updates = nullptr) const;
+
+    // Appends the |frame| at |time|, unless the table has a frame at a later
+    // time.  If |updates| is not null, the frame is only recorded there.
+    void Append(std::int64_t const primary_generation,
+                std::int64_t const secondary_generation,
+                Instant const& time,
+                BarycentricFrame const& frame,
+                Updates* const updates = nullptr);
+
+    // Applies the |updates| recorded by the calls above, in order.
+    void Apply(std::vector<Updates> const& updates);
+
+    CacheStatistics statistics() const;
+
+   private:
+    // Clears the table if it was filled for other generations.
+    void Reset(std::int64_t const primary_generation,
+               std::int64_t const secondary_generation);
+
+    std::int64_t primary_generation_ = 0;
+    std::int64_t secondary_generation_ = 0;
+    // The index, as seen by the cursors, of the first element of the vectors
+    // below.  It grows when the oldest frames are dropped, so that the cursors
+    // remain meaningful.
+    std::int64_t first_index_ = 0;
+    std::vector<Instant> times_;
+    std::vector<BarycentricFrame> frames_;
+    mutable CacheStatistics statistics_;
+  };
+
+  FrameTable frame_table_;
+
+  // The state of one walk along a trajectory.  |primary| is also used for the
+  // centre of |BodyCentredNonRotating|.  Walks that may happen concurrently
+  // must use distinct cursors, and must defer the updates to the caches.
+  struct Cursors {
+    Cursor primary;
+    Cursor secondary;
+    // If not null, the updates to the corresponding caches are recorded there
+    // and applied after the walk.
+    typename Cache<DegreesOfFreedom<ThroughFrame>>::Updates*
+        first_cache_updates = nullptr;
+    typename FrameTable::Updates* frame_table_updates = nullptr;
+    // The index of the next frame in |frame_table_|.
+    std::int64_t frame_table_cursor = 0;
+  };
+
+  // The cursors of the iterators returned by |first| and |first_on_or_after|.
+  // They are reset each time such an iterator is created.
+  Cursors cursors_;
+
+  // The results of |first_| for consecutive points of a cacheable trajectory,
+  // starting at the first point of the range of the last call to
+  // |TransformRange|, or at a later point if the tail was trimmed to bound its
+  // size.  The next call only needs to transform the points that were trimmed
+  // or appended since.
+  struct Tail {
+    std::deque<Instant> times;
+    std::deque<DegreesOfFreedom<ThroughFrame>> degrees_of_freedom;
+    // The time of the point that precedes |times.front()| if points were
+    // trimmed from the front of the tail, null otherwise.
+    std::unique_ptr<Instant> trimmed_until;  // std::optional.
+    // The value of |tail_uses_| when this tail was last used.
+    std::int64_t last_use = 0;
+  };
+
+  // The tails, keyed by the generation of their trajectory.  The tails which
+  // have not been used recently are evicted, and so is the least recently used
+  // tail when there are too many of them.
+  std::map<std::int64_t, Tail> tails_;
+  std::int64_t tail_uses_ = 0;
 
   FrameField<ToFrame> coordinate_frame_;
 };
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
+#include <future>
+#include <vector>
 
 #include "physics/transforms.hpp"
 
@@ -28,9 +31,12 @@ using geometry::Permutation;
 using geometry::Position;
 using geometry::R3x3Matrix;
 using geometry::Rotation;
+using geometry::Vector;
 using geometry::Wedge;
 using quantities::AngularFrequency;
 using quantities::Pow;
+using quantities::SIUnit;
+using quantities::Time;
 using si::Radian;
 using ::std::placeholders::_1;
 using ::std::placeholders::_2;
@@ -40,6 +46,40 @@ namespace physics {
 
 namespace {
 
+// The maximum number of points that a |Cursor| walks before falling back to a
+// search.
+int const kMaxCursorSteps = 16;
+
+// The minimum number of points transformed by a task of |TransformRange|.
+// Below twice that number the points are transformed serially, as the cost of
+// dispatching the tasks would exceed the gain.
+std::int64_t const kMinPointsPerChunk = 1 << 10;
+
+// The maximum number of tasks created by |TransformRange| per thread of the
+// pool, to balance the load if some threads are slower than others.
+int const kMaxChunksPerThread = 4;
+
+// The number of entries for which a |Cache| reserves storage when it receives
+// its first entry.  The storage then grows geometrically up to the capacity.
+std::int64_t const kMinCacheReservation = 1 << 6;
+
+// The maximum number of frames kept by a |FrameTable|.  When it is exceeded,
+// the oldest half of the frames are dropped.
+std::int64_t const kMaxFrameTableSize = 1 << 16;
+
+// The maximum number of trajectories for which |TransformRange| keeps the
+// results of the first transform.
+std::size_t const kMaxTails = 16;
+
+// The maximum number of points of a trajectory for which |TransformRange|
+// keeps the results of the first transform.
+std::size_t const kMaxTailPoints = 1 << 14;
+
+// The results of the first transform for a trajectory are dropped if they are
+// not used by this number of calls to |TransformRange|, e.g., because the
+// mobile is no longer rendered or because the trajectory was truncated.
+std::int64_t const kMaxTailIdleUses = 4 * kMaxTails;
+
 // Fills |*rotation| with the rotation that maps the basis of the barycentric
 // frame to the standard basis.  Fills |*angular_frequency| with the
 // corresponding angular velocity.  These pointers must be nonnull, and there is
@@ -101,6 +141,17 @@ void FromStandardBasisToBasisOfLastBarycentricFrame(
   *rotation = from_basis_of_last_barycentric_frame_to_standard_basis.Inverse();
 }
 
+// Returns the matrix of |rotation|, so that it may be applied to many vectors
+// without going through the quaternion each time.
+template<typename FromFrame, typename ToFrame>
+R3x3Matrix ToMatrix(Rotation<FromFrame, ToFrame> const& rotation) {
+  R3x3Matrix const columns(
+      rotation(Vector<double, FromFrame>({1, 0, 0})).coordinates(),
+      rotation(Vector<double, FromFrame>({0, 1, 0})).coordinates(),
+      rotation(Vector<double, FromFrame>({0, 0, 1})).coordinates());
+  return columns.Transpose();
+}
+
 }  // namespace
 
 template<typename Mobile,
@@ -120,6 +171,7 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BodyCentredNonRotating(
   transforms->first_ =
       [&centre, that](
           LazyTrajectory<FromFrame> const& from_trajectory,
+          not_null<Cursors*> const cursors,
           Instant const& t,
           DegreesOfFreedom<FromFrame> const& from_degrees_of_freedom,
           not_null<Trajectory<FromFrame> const*> const trajectory) ->
@@ -129,21 +181,17 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BodyCentredNonRotating(
         std::find(that->cacheable_.begin(),
                   that->cacheable_.end(),
                   from_trajectory) !=  that->cacheable_.end();
-    DegreesOfFreedom<ThroughFrame>* cached_through_degrees_of_freedom = nullptr;
+    DegreesOfFreedom<ThroughFrame> cached_through_degrees_of_freedom = {
+        ThroughFrame::origin, Velocity<ThroughFrame>()};
     if (cacheable &&
-        that->first_cache_.Lookup(trajectory, t,
-                                  &cached_through_degrees_of_freedom)) {
-      return *cached_through_degrees_of_freedom;
+        that->first_cache_.Lookup(trajectory->generation(), t,
+                                  &cached_through_degrees_of_freedom,
+                                  cursors->first_cache_updates)) {
+      return cached_through_degrees_of_freedom;
     }
 
-    // on_or_after() is Ln(N), but it doesn't matter unless the map gets very
-    // big, in which case we'll have cache misses anyway.
-    TYPENAME Trajectory<FromFrame>::NativeIterator const centre_it =
-        (centre.*from_trajectory)().on_or_after(t);
-    CHECK_EQ(centre_it.time(), t)
-        << "Time " << t << " not in centre trajectory";
     DegreesOfFreedom<FromFrame> const& centre_degrees_of_freedom =
-        centre_it.degrees_of_freedom();
+        cursors->primary.DegreesOfFreedomAt((centre.*from_trajectory)(), t);
 
     AffineMap<FromFrame, ThroughFrame, Length, Identity> const position_map(
         centre_degrees_of_freedom.position(),
@@ -158,7 +206,9 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BodyCentredNonRotating(
 
     // Cache the result before returning it.
     if (cacheable) {
-      that->first_cache_.Insert(trajectory, t, through_degrees_of_freedom);
+      that->first_cache_.Insert(trajectory->generation(), t,
+                                through_degrees_of_freedom,
+                                cursors->first_cache_updates);
     }
     return through_degrees_of_freedom;
   };
@@ -181,6 +231,14 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BodyCentredNonRotating(
             velocity_map(through_degrees_of_freedom.velocity())};
   };
 
+  transforms->second_parameters_ =
+      [&centre, to_trajectory](
+          not_null<Rotation<ThroughFrame, ToFrame>*> const rotation,
+          not_null<Position<ToFrame>*> const origin) {
+    *rotation = Rotation<ThroughFrame, ToFrame>::Identity();
+    *origin = (centre.*to_trajectory)().last().degrees_of_freedom().position();
+  };
+
   return transforms;
 }
 
@@ -217,6 +275,7 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BarycentricRotating(
   transforms->first_ =
       [&primary, &secondary, that](
           LazyTrajectory<FromFrame> const& from_trajectory,
+          not_null<Cursors*> const cursors,
           Instant const& t,
           DegreesOfFreedom<FromFrame> const& from_degrees_of_freedom,
           not_null<Trajectory<FromFrame> const*> const trajectory) ->
@@ -226,45 +285,59 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BarycentricRotating(
         std::find(that->cacheable_.begin(),
                   that->cacheable_.end(),
                   from_trajectory) !=  that->cacheable_.end();
-    DegreesOfFreedom<ThroughFrame>* cached_through_degrees_of_freedom = nullptr;
+    DegreesOfFreedom<ThroughFrame> cached_through_degrees_of_freedom = {
+        ThroughFrame::origin, Velocity<ThroughFrame>()};
     if (cacheable &&
-        that->first_cache_.Lookup(trajectory, t,
-                                  &cached_through_degrees_of_freedom)) {
-      return *cached_through_degrees_of_freedom;
+        that->first_cache_.Lookup(trajectory->generation(), t,
+                                  &cached_through_degrees_of_freedom,
+                                  cursors->first_cache_updates)) {
+      return cached_through_degrees_of_freedom;
     }
 
-    // |on_or_after()| is Ln(N).
-    TYPENAME Trajectory<FromFrame>::NativeIterator const primary_it =
-        (primary.*from_trajectory)().on_or_after(t);
-    CHECK_EQ(primary_it.time(), t)
-        << "Time " << t << " not in primary trajectory";
-    TYPENAME Trajectory<FromFrame>::NativeIterator secondary_it =
-        (secondary.*from_trajectory)().on_or_after(t);
-    CHECK_EQ(secondary_it.time(), t)
-        << "Time " << t << " not in secondary trajectory";
-
-    DegreesOfFreedom<FromFrame> const& primary_degrees_of_freedom =
-        primary_it.degrees_of_freedom();
-    DegreesOfFreedom<FromFrame> const& secondary_degrees_of_freedom =
-        secondary_it.degrees_of_freedom();
-    DegreesOfFreedom<FromFrame> const barycentre_degrees_of_freedom =
-        Barycentre<FromFrame, GravitationalParameter>(
-            {primary_degrees_of_freedom,
-             secondary_degrees_of_freedom},
-            {(primary.*from_trajectory)().template body<MassiveBody>()->
-                 gravitational_parameter(),
-             (secondary.*from_trajectory)().template body<MassiveBody>()->
-                 gravitational_parameter()});
-    Rotation<FromFrame, ThroughFrame>
-        from_basis_of_barycentric_frame_to_standard_basis =
-            Rotation<FromFrame, ThroughFrame>::Identity();
-    Bivector<AngularFrequency, FromFrame> angular_frequency;
-    FromBasisOfBarycentricFrameToStandardBasis<FromFrame, ThroughFrame>(
-        barycentre_degrees_of_freedom,
-        primary_degrees_of_freedom,
-        secondary_degrees_of_freedom,
-        &from_basis_of_barycentric_frame_to_standard_basis,
-        &angular_frequency);
+    // Then check if the frame at |t| was computed for another mobile.
+    Trajectory<FromFrame> const& primary_trajectory =
+        (primary.*from_trajectory)();
+    Trajectory<FromFrame> const& secondary_trajectory =
+        (secondary.*from_trajectory)();
+    BarycentricFrame frame = {{FromFrame::origin, Velocity<FromFrame>()},
+                              Rotation<FromFrame, ThroughFrame>::Identity(),
+                              Bivector<AngularFrequency, FromFrame>()};
+    if (!that->frame_table_.Find(primary_trajectory.generation(),
+                                 secondary_trajectory.generation(),
+                                 t,
+                                 &cursors->frame_table_cursor,
+                                 &frame,
+                                 cursors->frame_table_updates)) {
+      DegreesOfFreedom<FromFrame> const& primary_degrees_of_freedom =
+          cursors->primary.DegreesOfFreedomAt(primary_trajectory, t);
+      DegreesOfFreedom<FromFrame> const& secondary_degrees_of_freedom =
+          cursors->secondary.DegreesOfFreedomAt(secondary_trajectory, t);
+      frame.barycentre_degrees_of_freedom =
+          Barycentre<FromFrame, GravitationalParameter>(
+              {primary_degrees_of_freedom,
+               secondary_degrees_of_freedom},
+              {primary_trajectory.template body<MassiveBody>()->
+                   gravitational_parameter(),
+               secondary_trajectory.template body<MassiveBody>()->
+                   gravitational_parameter()});
+      FromBasisOfBarycentricFrameToStandardBasis<FromFrame, ThroughFrame>(
+          frame.barycentre_degrees_of_freedom,
+          primary_degrees_of_freedom,
+          secondary_degrees_of_freedom,
+          &frame.rotation,
+          &frame.angular_frequency);
+      that->frame_table_.Append(primary_trajectory.generation(),
+                                secondary_trajectory.generation(),
+                                t,
+                                frame,
+                                cursors->frame_table_updates);
+    }
+    DegreesOfFreedom<FromFrame> const& barycentre_degrees_of_freedom =
+        frame.barycentre_degrees_of_freedom;
+    Rotation<FromFrame, ThroughFrame> const&
+        from_basis_of_barycentric_frame_to_standard_basis = frame.rotation;
+    Bivector<AngularFrequency, FromFrame> const& angular_frequency =
+        frame.angular_frequency;
 
     AffineMap<FromFrame, ThroughFrame, Length, Rotation> const position_map(
         barycentre_degrees_of_freedom.position(),
@@ -284,7 +357,9 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BarycentricRotating(
 
     // Cache the result before returning it.
     if (cacheable) {
-      that->first_cache_.Insert(trajectory, t, through_degrees_of_freedom);
+      that->first_cache_.Insert(trajectory->generation(), t,
+                                through_degrees_of_freedom,
+                                cursors->first_cache_updates);
     }
     return through_degrees_of_freedom;
   };
@@ -316,6 +391,20 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::BarycentricRotating(
             velocity_map(through_degrees_of_freedom.velocity())};
   };
 
+  transforms->second_parameters_ =
+      [&primary, &secondary, to_trajectory](
+          not_null<Rotation<ThroughFrame, ToFrame>*> const rotation,
+          not_null<Position<ToFrame>*> const origin) {
+    DegreesOfFreedom<ToFrame> last_barycentre_degrees_of_freedom =
+        {ToFrame::origin, Velocity<ToFrame>()};
+    FromStandardBasisToBasisOfLastBarycentricFrame<ThroughFrame, ToFrame>(
+        (primary.*to_trajectory)(),
+        (secondary.*to_trajectory)(),
+        rotation,
+        &last_barycentre_degrees_of_freedom);
+    *origin = last_barycentre_degrees_of_freedom.position();
+  };
+
   return transforms;
 }
 
@@ -339,8 +428,10 @@ typename Trajectory<FromFrame>::template TransformingIterator<ThroughFrame>
 Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::first(
     Mobile const& mobile,
     LazyTrajectory<FromFrame> const& from_trajectory) {
+  cursors_.primary.Reset();
+  cursors_.secondary.Reset();
   typename Trajectory<FromFrame>::template Transform<ThroughFrame> const first =
-      std::bind(first_, from_trajectory, _1, _2, _3);
+      std::bind(first_, from_trajectory, &cursors_, _1, _2, _3);
   return (mobile.*from_trajectory)().first_with_transform(first);
 }
 
@@ -351,8 +442,10 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::first_on_or_after(
     Mobile const& mobile,
     LazyTrajectory<FromFrame> const& from_trajectory,
     Instant const& time) {
+  cursors_.primary.Reset();
+  cursors_.secondary.Reset();
   typename Trajectory<FromFrame>::template Transform<ThroughFrame> const first =
-      std::bind(first_, from_trajectory, _1, _2, _3);
+      std::bind(first_, from_trajectory, &cursors_, _1, _2, _3);
   return (mobile.*from_trajectory)().on_or_after_with_transform(time, first);
 }
 
@@ -364,6 +457,168 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::second(
   return through_trajectory.first_with_transform(second_);
 }
 
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+void Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::TransformRange(
+    Mobile const& mobile,
+    LazyTrajectory<FromFrame> const& from_trajectory,
+    Instant const& t1,
+    Instant const& t2,
+    not_null<std::vector<Instant>*> const times,
+    not_null<std::vector<Position<ToFrame>>*> const positions,
+    not_null<std::vector<Velocity<ToFrame>>*> const velocities,
+    ThreadPool* const pool) {
+  CHECK_EQ(times->size(), positions->size());
+  CHECK_EQ(times->size(), velocities->size());
+  TransformRange(mobile,
+                 from_trajectory,
+                 t1,
+                 t2,
+                 [times, positions, velocities](
+                     Instant const& time,
+                     Position<ToFrame> const& position,
+                     Velocity<ToFrame> const& velocity) {
+                   times->push_back(time);
+                   positions->push_back(position);
+                   velocities->push_back(velocity);
+                 },
+                 pool);
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+void Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::TransformRange(
+    Mobile const& mobile,
+    LazyTrajectory<FromFrame> const& from_trajectory,
+    Instant const& t1,
+    Instant const& t2,
+    PointSink const& sink,
+    ThreadPool* const pool,
+    PointFilter const& filter) {
+  Rotation<ThroughFrame, ToFrame> rotation =
+      Rotation<ThroughFrame, ToFrame>::Identity();
+  Position<ToFrame> origin = ToFrame::origin;
+  second_parameters_(&rotation, &origin);
+  R3x3Matrix const matrix = ToMatrix(rotation);
+  auto const second = [&matrix, &origin, &sink](
+      Instant const& time,
+      DegreesOfFreedom<ThroughFrame> const& through_degrees_of_freedom) {
+    sink(time,
+         origin +
+             Displacement<ToFrame>(
+                 matrix * (through_degrees_of_freedom.position() -
+                           ThroughFrame::origin).coordinates()),
+         Velocity<ToFrame>(
+             matrix * through_degrees_of_freedom.velocity().coordinates()));
+  };
+
+  Trajectory<FromFrame> const& trajectory = (mobile.*from_trajectory)();
+  bool const cacheable =
+      std::find(cacheable_.begin(), cacheable_.end(), from_trajectory) !=
+          cacheable_.end();
+  if (!cacheable) {
+    TransformFirstRange(trajectory,
+                        from_trajectory,
+                        trajectory.on_or_after(t1),
+                        t2,
+                        second,
+                        pool,
+                        filter);
+    return;
+  }
+
+  // The result of |first_| doesn't change as long as the generation of the
+  // trajectory doesn't, so only transform the points that are not in the
+  // tail.
+  ++tail_uses_;
+  for (auto it = tails_.begin(); it != tails_.end();) {
+    if (tail_uses_ - it->second.last_use > kMaxTailIdleUses) {
+      it = tails_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  auto const inserted = tails_.emplace(trajectory.generation(), Tail());
+  Tail& tail = inserted.first->second;
+  tail.last_use = tail_uses_;
+  if (inserted.second && tails_.size() > kMaxTails) {
+    auto least_recently_used = tails_.begin();
+    for (auto it = tails_.begin(); it != tails_.end(); ++it) {
+      if (it->second.last_use < least_recently_used->second.last_use) {
+        least_recently_used = it;
+      }
+    }
+    tails_.erase(least_recently_used);
+  }
+  // Drop the points that are before |t1|, e.g., because they were forgotten.
+  while (!tail.times.empty() && tail.times.front() < t1) {
+    tail.times.pop_front();
+    tail.degrees_of_freedom.pop_front();
+  }
+  if (tail.times.empty()) {
+    tail.trimmed_until.reset();
+  }
+  // The tail is only usable if it starts at the first point of the range, or
+  // if the points of the range that precede it were trimmed from it.
+  bool const trimmed_in_range =
+      tail.trimmed_until != nullptr && *tail.trimmed_until >= t1;
+  auto it = trajectory.on_or_after(t1);
+  if (!tail.times.empty() && !trimmed_in_range &&
+      (it.at_end() || it.time() != tail.times.front())) {
+    tail.times.clear();
+    tail.degrees_of_freedom.clear();
+    tail.trimmed_until.reset();
+  }
+  if (trimmed_in_range) {
+    TransformFirstRange(trajectory,
+                        from_trajectory,
+                        it,
+                        std::min(*tail.trimmed_until, t2),
+                        second,
+                        pool,
+                        filter);
+  }
+  if (!tail.times.empty()) {
+    it = trajectory.on_or_after(tail.times.back());
+    ++it;
+  }
+  // The points appended to the tail are not filtered before |first_|, since the
+  // tail must hold consecutive points.  They are filtered before |second|.
+  TransformFirstRange(
+      trajectory,
+      from_trajectory,
+      it,
+      t2,
+      [&filter, &second, &tail](
+          Instant const& time,
+          DegreesOfFreedom<ThroughFrame> const& degrees_of_freedom) {
+        tail.times.push_back(time);
+        tail.degrees_of_freedom.push_back(degrees_of_freedom);
+        if (tail.times.size() > kMaxTailPoints) {
+          // The points are in increasing time order, so the first point of
+          // the tail may be passed to |second| now, and dropped.
+          if (filter == nullptr || filter(tail.times.front())) {
+            second(tail.times.front(), tail.degrees_of_freedom.front());
+          }
+          if (tail.trimmed_until == nullptr) {
+            tail.trimmed_until =
+                std::make_unique<Instant>(tail.times.front());
+          } else {
+            *tail.trimmed_until = tail.times.front();
+          }
+          tail.times.pop_front();
+          tail.degrees_of_freedom.pop_front();
+        }
+      },
+      pool,
+      nullptr);
+  for (std::size_t i = 0; i < tail.times.size() && tail.times[i] <= t2; ++i) {
+    if (filter == nullptr || filter(tail.times[i])) {
+      second(tail.times[i], tail.degrees_of_freedom[i]);
+    }
+  }
+}
+
 template<typename Mobile,
          typename FromFrame, typename ThroughFrame, typename ToFrame>
 FrameField<ToFrame>
@@ -373,36 +628,437 @@ Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::coordinate_frame() const {
 
 template<typename Mobile,
          typename FromFrame, typename ThroughFrame, typename ToFrame>
-template<typename Frame1, typename Frame2>
+typename Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::CacheStatistics
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::
+first_cache_statistics() const {
+  return first_cache_.statistics();
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+typename Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::CacheStatistics
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::
+frame_table_statistics() const {
+  return frame_table_.statistics();
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+void Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::TransformFirstRange(
+    Trajectory<FromFrame> const& trajectory,
+    LazyTrajectory<FromFrame> const& from_trajectory,
+    typename Trajectory<FromFrame>::NativeIterator it,
+    Instant const& t2,
+    ThroughSink const& sink,
+    ThreadPool* const pool,
+    PointFilter const& filter) {
+  if (pool == nullptr) {
+    // Stream the points through the transform, one at a time.
+    Cursors cursors;
+    for (; !it.at_end() && it.time() <= t2; ++it) {
+      if (filter != nullptr && !filter(it.time())) {
+        continue;
+      }
+      sink(it.time(),
+           first_(from_trajectory,
+                  &cursors,
+                  it.time(),
+                  it.degrees_of_freedom(),
+                  &trajectory));
+    }
+    return;
+  }
+
+  // Process the points by windows of bounded size, so that the memory used
+  // doesn't depend on the length of the trajectory.  The points of a window
+  // are collected serially, because this is a walk along a linked structure,
+  // then transformed by contiguous chunks on the threads of |pool|.  Each
+  // chunk stores its results at the indices of its points and walks the
+  // trajectories of the bodies with its own cursors, so the results don't
+  // depend on the scheduling of the tasks.  The chunks only read the caches,
+  // without locking them; their updates are applied in order after the join.
+  std::int64_t const max_chunks = kMaxChunksPerThread * pool->size();
+  std::int64_t const window = max_chunks * kMinPointsPerChunk;
+  std::vector<Instant> times;
+  std::vector<DegreesOfFreedom<FromFrame>> from_degrees_of_freedom;
+  std::vector<DegreesOfFreedom<ThroughFrame>> through_degrees_of_freedom;
+  times.reserve(window);
+  from_degrees_of_freedom.reserve(window);
+  through_degrees_of_freedom.reserve(window);
+  using FirstCacheUpdates =
+      typename Cache<DegreesOfFreedom<ThroughFrame>>::Updates;
+  using FrameTableUpdates = typename FrameTable::Updates;
+  std::vector<FirstCacheUpdates> first_cache_updates;
+  std::vector<FrameTableUpdates> frame_table_updates;
+  auto const transform_chunk =
+      [this, &trajectory, &from_trajectory, &times, &from_degrees_of_freedom,
+       &through_degrees_of_freedom](
+          std::int64_t const begin,
+          std::int64_t const end,
+          FirstCacheUpdates* const first_cache_updates,
+          FrameTableUpdates* const frame_table_updates) {
+    Cursors cursors;
+    cursors.first_cache_updates = first_cache_updates;
+    cursors.frame_table_updates = frame_table_updates;
+    for (std::int64_t i = begin; i < end; ++i) {
+      through_degrees_of_freedom[i] = first_(from_trajectory,
+                                             &cursors,
+                                             times[i],
+                                             from_degrees_of_freedom[i],
+                                             &trajectory);
+    }
+  };
+  std::vector<std::future<void>> futures;
+  futures.reserve(max_chunks);
+  do {
+    times.clear();
+    from_degrees_of_freedom.clear();
+    for (;
+         !it.at_end() && it.time() <= t2 &&
+             static_cast<std::int64_t>(times.size()) < window;
+         ++it) {
+      if (filter != nullptr && !filter(it.time())) {
+        continue;
+      }
+      times.push_back(it.time());
+      from_degrees_of_freedom.push_back(it.degrees_of_freedom());
+    }
+    std::int64_t const size = times.size();
+    through_degrees_of_freedom.assign(
+        size, {ThroughFrame::origin, Velocity<ThroughFrame>()});
+    if (size < 2 * kMinPointsPerChunk) {
+      // Not worth dispatching.
+      transform_chunk(0, size, nullptr, nullptr);
+    } else {
+      std::int64_t const chunks =
+          std::min(size / kMinPointsPerChunk, max_chunks);
+      futures.clear();
+      first_cache_updates.assign(chunks, FirstCacheUpdates());
+      frame_table_updates.assign(chunks, FrameTableUpdates());
+      for (std::int64_t chunk = 0; chunk < chunks; ++chunk) {
+        std::int64_t const begin = size * chunk / chunks;
+        std::int64_t const end = size * (chunk + 1) / chunks;
+        FirstCacheUpdates* const first_updates = &first_cache_updates[chunk];
+        FrameTableUpdates* const frame_updates = &frame_table_updates[chunk];
+        futures.push_back(pool->Add(
+            [&transform_chunk, begin, end, first_updates, frame_updates]() {
+              transform_chunk(begin, end, first_updates, frame_updates);
+            }));
+      }
+      for (auto& future : futures) {
+        future.get();
+      }
+      first_cache_.Apply(first_cache_updates);
+      frame_table_.Apply(frame_table_updates);
+    }
+    for (std::int64_t i = 0; i < size; ++i) {
+      sink(times[i], through_degrees_of_freedom[i]);
+    }
+  } while (static_cast<std::int64_t>(times.size()) == window);
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+DegreesOfFreedom<FromFrame> const&
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cursor::
+DegreesOfFreedomAt(Trajectory<FromFrame> const& trajectory,
+                   Instant const& time) {
+  bool found = false;
+  if (trajectory_ == &trajectory &&
+      iterator_ != nullptr &&
+      !iterator_->at_end() &&
+      iterator_->time() <= time) {
+    for (int steps = 0;
+         steps < kMaxCursorSteps &&
+         !iterator_->at_end() &&
+         iterator_->time() < time;
+         ++steps, ++*iterator_) {}
+    found = !iterator_->at_end() && iterator_->time() == time;
+  }
+  if (!found) {
+    // |on_or_after()| is Ln(N).
+    trajectory_ = &trajectory;
+    iterator_ =
+        std::make_unique<typename Trajectory<FromFrame>::NativeIterator>(
+            trajectory.on_or_after(time));
+  }
+  CHECK(!iterator_->at_end() && iterator_->time() == time)
+      << "Time " << time << " not in trajectory";
+  return iterator_->degrees_of_freedom();
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+void Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cursor::Reset() {
+  trajectory_ = nullptr;
+  iterator_.reset();
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+bool Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::FrameTable::Find(
+    std::int64_t const primary_generation,
+    std::int64_t const secondary_generation,
+    Instant const& time,
+    not_null<std::int64_t*> const cursor,
+    not_null<BarycentricFrame*> const frame,
+    Updates* const updates) const {
+  std::int64_t& misses =
+      updates == nullptr ? statistics_.misses : updates->misses;
+  std::int64_t& hits = updates == nullptr ? statistics_.hits : updates->hits;
+  if (primary_generation != primary_generation_ ||
+      secondary_generation != secondary_generation_) {
+    ++misses;
+    return false;
+  }
+
+  // |index| is the index of the first frame at or after |time|.  Walk the
+  // cursor if it is at or before that frame, otherwise search.
+  std::int64_t const size = times_.size();
+  std::int64_t index = *cursor - first_index_;
+  bool located = false;
+  if (index >= 0 && index <= size && (index == 0 || times_[index - 1] < time)) {
+    for (int steps = 0;
+         steps < kMaxCursorSteps && index < size && times_[index] < time;
+         ++steps, ++index) {}
+    located = index == size || times_[index] >= time;
+  }
+  if (!located) {
+    index = std::lower_bound(times_.begin(), times_.end(), time) -
+            times_.begin();
+  }
+  *cursor = first_index_ + index;
+
+  if (index == size || times_[index] != time) {
+    ++misses;
+    return false;
+  }
+  ++hits;
+  *frame = frames_[index];
+  return true;
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+void Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::FrameTable::Append(
+    std::int64_t const primary_generation,
+    std::int64_t const secondary_generation,
+    Instant const& time,
+    BarycentricFrame const& frame,
+    Updates* const updates) {
+  if (updates != nullptr) {
+    updates->primary_generation = primary_generation;
+    updates->secondary_generation = secondary_generation;
+    updates->times.push_back(time);
+    updates->frames.push_back(frame);
+    return;
+  }
+  Reset(primary_generation, secondary_generation);
+  if (!times_.empty() && times_.back() >= time) {
+    return;
+  }
+  times_.push_back(time);
+  frames_.push_back(frame);
+  std::int64_t const size = times_.size();
+  if (size > kMaxFrameTableSize) {
+    std::int64_t const dropped = size / 2;
+    times_.erase(times_.begin(), times_.begin() + dropped);
+    frames_.erase(frames_.begin(), frames_.begin() + dropped);
+    first_index_ += dropped;
+    statistics_.evictions += dropped;
+  }
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+void Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::FrameTable::Apply(
+    std::vector<Updates> const& updates) {
+  for (Updates const& u : updates) {
+    statistics_.hits += u.hits;
+    statistics_.misses += u.misses;
+    for (std::size_t i = 0; i < u.times.size(); ++i) {
+      Append(u.primary_generation,
+             u.secondary_generation,
+             u.times[i],
+             u.frames[i]);
+    }
+  }
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+typename Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::CacheStatistics
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::FrameTable::
+statistics() const {
+  return statistics_;
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+void Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::FrameTable::Reset(
+    std::int64_t const primary_generation,
+    std::int64_t const secondary_generation) {
+  if (primary_generation != primary_generation_ ||
+      secondary_generation != secondary_generation_) {
+    statistics_.evictions += times_.size();
+    // Skip the indices of the dropped frames so that the cursors don't walk
+    // the new ones from a stale position.
+    first_index_ += times_.size();
+    times_.clear();
+    frames_.clear();
+    primary_generation_ = primary_generation;
+    secondary_generation_ = secondary_generation;
+  }
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+template<typename Value>
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+Cache(std::int64_t const capacity)
+    : capacity_(capacity) {
+  CHECK_LT(0, capacity_);
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+template<typename Value>
 bool
-Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Frame1, Frame2>::
-Lookup(not_null<Trajectory<Frame1> const*> const trajectory,
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+Lookup(std::int64_t const generation,
        Instant const& time,
-       not_null<DegreesOfFreedom<Frame2>**> degrees_of_freedom) {
-  bool found = false;
-  ++number_of_lookups_[trajectory];
-  auto const it = map_.find(std::make_pair(trajectory, time));
-  if (it != map_.end()) {
-    ++number_of_hits_[trajectory];
-    *degrees_of_freedom = &it->second;
-    found = true;
+       not_null<Value*> const value,
+       Updates* const updates) {
+  if (updates != nullptr) {
+    auto const it = indices_.find(Key(generation, time));
+    if (it == indices_.end()) {
+      ++updates->misses;
+      return false;
+    }
+    updates->hits.push_back(it->second);
+    *value = entries_[it->second].value;
+    return true;
+  }
+  std::unique_lock<std::mutex> l(lock_);
+  auto const it = indices_.find(Key(generation, time));
+  if (it == indices_.end()) {
+    ++statistics_.misses;
+    return false;
   }
-  VLOG_EVERY_N(1, 1000) << "Hit ratio for trajectory " << trajectory << " is "
-                        << static_cast<double>(number_of_hits_[trajectory]) /
-                           number_of_lookups_[trajectory];
-  return found;
+  ++statistics_.hits;
+  Entry& entry = entries_[it->second];
+  entry.referenced = true;
+  *value = entry.value;
+  return true;
 }
 
 template<typename Mobile,
          typename FromFrame, typename ThroughFrame, typename ToFrame>
-template<typename Frame1, typename Frame2>
+template<typename Value>
 void
-Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Frame1, Frame2>::
-Insert(not_null<Trajectory<Frame1> const*> const trajectory,
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+Insert(std::int64_t const generation,
        Instant const& time,
-       DegreesOfFreedom<Frame2> const& degrees_of_freedom) {
-  map_.emplace(std::make_pair(trajectory, time), degrees_of_freedom);
+       Value const& value,
+       Updates* const updates) {
+  if (updates != nullptr) {
+    updates->insertions.push_back({generation, time, value});
+    return;
+  }
+  std::unique_lock<std::mutex> l(lock_);
+  InsertLocked(Key(generation, time), value);
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+template<typename Value>
+void
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+Apply(std::vector<Updates> const& updates) {
+  std::unique_lock<std::mutex> l(lock_);
+  // Mark all the hits before inserting anything, as the insertions may evict
+  // the entries at the recorded indices.
+  for (Updates const& u : updates) {
+    statistics_.hits += u.hits.size();
+    statistics_.misses += u.misses;
+    for (std::int64_t const index : u.hits) {
+      entries_[index].referenced = true;
+    }
+  }
+  for (Updates const& u : updates) {
+    for (auto const& insertion : u.insertions) {
+      InsertLocked(Key(insertion.generation, insertion.time), insertion.value);
+    }
+  }
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+template<typename Value>
+typename Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::CacheStatistics
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+statistics() const {
+  std::unique_lock<std::mutex> l(lock_);
+  return statistics_;
 }
 
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+template<typename Value>
+void
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+InsertLocked(Key const& key, Value const& value) {
+  auto const it = indices_.find(key);
+  if (it != indices_.end()) {
+    entries_[it->second].value = value;
+    return;
+  }
+  std::int64_t const size = entries_.size();
+  if (size < capacity_) {
+    // Grow the storage lazily, but never beyond the capacity.
+    if (size == static_cast<std::int64_t>(entries_.capacity())) {
+      entries_.reserve(std::min(std::max(2 * size, kMinCacheReservation),
+                                capacity_));
+    }
+    indices_.emplace(key, size);
+    entries_.emplace_back(key, value);
+    return;
+  }
+  // Advance the hand, giving a second chance to the referenced entries, until
+  // it finds an entry to evict.
+  while (entries_[hand_].referenced) {
+    entries_[hand_].referenced = false;
+    hand_ = (hand_ + 1) % capacity_;
+  }
+  Entry& entry = entries_[hand_];
+  indices_.erase(entry.key);
+  ++statistics_.evictions;
+  indices_.emplace(key, hand_);
+  entry = Entry(key, value);
+  hand_ = (hand_ + 1) % capacity_;
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+template<typename Value>
+std::size_t
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+KeyHash::operator()(Key const& key) const {
+  std::size_t const generation_hash = std::hash<std::int64_t>()(key.first);
+  std::size_t const time_hash =
+      std::hash<double>()((key.second - Instant()) / SIUnit<Time>());
+  return generation_hash ^ (time_hash + 0x9e3779b9 +
+                            (generation_hash << 6) + (generation_hash >> 2));
+}
+
+template<typename Mobile,
+         typename FromFrame, typename ThroughFrame, typename ToFrame>
+template<typename Value>
+Transforms<Mobile, FromFrame, ThroughFrame, ToFrame>::Cache<Value>::
+Entry::Entry(Key const& key, Value const& value)
+    : key(key),
+      value(value),
+      referenced(false) {}
+
 }  // namespace physics
 }  // namespace principia
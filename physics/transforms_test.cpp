@@ -1,9 +1,11 @@
 #include "physics/transforms.hpp"
 
 #include <limits>
+#include <vector>
 
 #include "geometry/frame.hpp"
 #include "base/not_null.hpp"
+#include "base/thread_pool.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "physics/degrees_of_freedom.hpp"
@@ -18,6 +20,7 @@
 
 namespace principia {
 
+using base::ThreadPool;
 using base::make_not_null_unique;
 using geometry::Frame;
 using geometry::InnerProduct;
@@ -351,5 +354,573 @@ TEST_F(TransformsTest, BodiesBarycentricRotating) {
       VanishesBefore(1, 8));
 }
 
+// Check that |TransformRange| gives the same results as the composition of
+// |first| and |second|.
+TEST_F(TransformsTest, TransformRange) {
+  auto const transforms =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+  body1_to_->Append(
+      Instant(kNumberOfPoints * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({1 * SIUnit<Length>(),
+                                         -1 * SIUnit<Length>(),
+                                         2 * SIUnit<Length>()})),
+          Velocity<To>({-3 * SIUnit<Speed>(),
+                        5 * SIUnit<Speed>(),
+                        -8 * SIUnit<Speed>()})));
+  body2_to_->Append(
+      Instant(kNumberOfPoints * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({13 * SIUnit<Length>(),
+                                         -21 * SIUnit<Length>(),
+                                         34 * SIUnit<Length>()})),
+          Velocity<To>({-55 * SIUnit<Speed>(),
+                        89 * SIUnit<Speed>(),
+                        -144 * SIUnit<Speed>()})));
+
+  Trajectory<Through> satellite_through(&satellite_);
+  for (auto it = transforms->first(satellite_fn_, &Functors::from_trajectory);
+       !it.at_end();
+       ++it) {
+    satellite_through.Append(it.time(), it.degrees_of_freedom());
+  }
+  std::vector<DegreesOfFreedom<To>> expected;
+  for (auto it = transforms->second(satellite_through); !it.at_end(); ++it) {
+    expected.push_back(it.degrees_of_freedom());
+  }
+
+  std::vector<Instant> times;
+  std::vector<Position<To>> positions;
+  std::vector<Velocity<To>> velocities;
+  transforms->TransformRange(satellite_fn_,
+                             &Functors::from_trajectory,
+                             Instant(3 * SIUnit<Time>()),
+                             Instant(15.5 * SIUnit<Time>()),
+                             &times,
+                             &positions,
+                             &velocities);
+  ASSERT_EQ(13, times.size());
+  ASSERT_EQ(13, positions.size());
+  ASSERT_EQ(13, velocities.size());
+  for (int i = 0; i < times.size(); ++i) {
+    EXPECT_EQ(Instant((i + 3) * SIUnit<Time>()), times[i]);
+    EXPECT_THAT(positions[i] - To::origin,
+                AlmostEquals(expected[i + 2].position() - To::origin, 0, 32))
+        << i;
+    EXPECT_THAT(velocities[i],
+                AlmostEquals(expected[i + 2].velocity(), 0, 32)) << i;
+  }
+}
+
+// Check that the parallel |TransformRange| gives exactly the same results as
+// the streaming one, in the same order.
+TEST_F(TransformsTest, ParallelTransformRange) {
+  int const number_of_points = 10000;
+  for (int i = kNumberOfPoints + 1; i <= number_of_points; ++i) {
+    body1_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(Displacement<From>({1 * i * SIUnit<Length>(),
+                                               2 * i * SIUnit<Length>(),
+                                               3 * i * SIUnit<Length>()})),
+            Velocity<From>({4 * i * SIUnit<Speed>(),
+                            8 * i * SIUnit<Speed>(),
+                            16 * i * SIUnit<Speed>()})));
+    body2_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(Displacement<From>({-1 * i * SIUnit<Length>(),
+                                               -2 * i * SIUnit<Length>(),
+                                               3 * i * SIUnit<Length>()})),
+            Velocity<From>({-4 * i * SIUnit<Speed>(),
+                            8 * i * SIUnit<Speed>(),
+                            -16 * i * SIUnit<Speed>()})));
+    satellite_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(Displacement<From>({10 * i * SIUnit<Length>(),
+                                               -20 * i * SIUnit<Length>(),
+                                               30 * i * SIUnit<Length>()})),
+            Velocity<From>({40 * i * SIUnit<Speed>(),
+                            -80 * i * SIUnit<Speed>(),
+                            160 * i * SIUnit<Speed>()})));
+  }
+  body1_to_->Append(
+      Instant(number_of_points * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({1 * SIUnit<Length>(),
+                                         -1 * SIUnit<Length>(),
+                                         2 * SIUnit<Length>()})),
+          Velocity<To>({-3 * SIUnit<Speed>(),
+                        5 * SIUnit<Speed>(),
+                        -8 * SIUnit<Speed>()})));
+  body2_to_->Append(
+      Instant(number_of_points * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({13 * SIUnit<Length>(),
+                                         -21 * SIUnit<Length>(),
+                                         34 * SIUnit<Length>()})),
+          Velocity<To>({-55 * SIUnit<Speed>(),
+                        89 * SIUnit<Speed>(),
+                        -144 * SIUnit<Speed>()})));
+
+  auto const transforms =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+
+  std::vector<Instant> serial_times;
+  std::vector<Position<To>> serial_positions;
+  std::vector<Velocity<To>> serial_velocities;
+  transforms->TransformRange(satellite_fn_,
+                             &Functors::from_trajectory,
+                             Instant(3 * SIUnit<Time>()),
+                             Instant(9000 * SIUnit<Time>()),
+                             &serial_times,
+                             &serial_positions,
+                             &serial_velocities);
+
+  ThreadPool pool(3);
+  std::vector<Instant> parallel_times;
+  std::vector<Position<To>> parallel_positions;
+  std::vector<Velocity<To>> parallel_velocities;
+  transforms->TransformRange(satellite_fn_,
+                             &Functors::from_trajectory,
+                             Instant(3 * SIUnit<Time>()),
+                             Instant(9000 * SIUnit<Time>()),
+                             &parallel_times,
+                             &parallel_positions,
+                             &parallel_velocities,
+                             &pool);
+  ASSERT_EQ(8998, parallel_times.size());
+  EXPECT_EQ(serial_times, parallel_times);
+  EXPECT_EQ(serial_positions, parallel_positions);
+  EXPECT_EQ(serial_velocities, parallel_velocities);
+  // The parallel computation used the frames cached by the serial one.
+  EXPECT_EQ(8998, transforms->frame_table_statistics().hits);
+  EXPECT_EQ(8998, transforms->frame_table_statistics().misses);
+
+  // With a single thread the points are processed in several windows.
+  ThreadPool small_pool(1);
+  std::vector<Instant> windowed_times;
+  std::vector<Position<To>> windowed_positions;
+  std::vector<Velocity<To>> windowed_velocities;
+  transforms->TransformRange(satellite_fn_,
+                             &Functors::from_trajectory,
+                             Instant(3 * SIUnit<Time>()),
+                             Instant(9000 * SIUnit<Time>()),
+                             &windowed_times,
+                             &windowed_positions,
+                             &windowed_velocities,
+                             &small_pool);
+  EXPECT_EQ(serial_times, windowed_times);
+  EXPECT_EQ(serial_positions, windowed_positions);
+  EXPECT_EQ(serial_velocities, windowed_velocities);
+
+  // The frames computed by a parallel computation are cached once the tasks
+  // have completed.
+  auto const parallel_transforms =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+  parallel_times.clear();
+  parallel_positions.clear();
+  parallel_velocities.clear();
+  parallel_transforms->TransformRange(satellite_fn_,
+                                      &Functors::from_trajectory,
+                                      Instant(3 * SIUnit<Time>()),
+                                      Instant(9000 * SIUnit<Time>()),
+                                      &parallel_times,
+                                      &parallel_positions,
+                                      &parallel_velocities,
+                                      &pool);
+  EXPECT_EQ(serial_positions, parallel_positions);
+  EXPECT_EQ(0, parallel_transforms->frame_table_statistics().hits);
+  EXPECT_EQ(8998, parallel_transforms->frame_table_statistics().misses);
+  serial_times.clear();
+  serial_positions.clear();
+  serial_velocities.clear();
+  parallel_transforms->TransformRange(satellite_fn_,
+                                      &Functors::from_trajectory,
+                                      Instant(3 * SIUnit<Time>()),
+                                      Instant(9000 * SIUnit<Time>()),
+                                      &serial_times,
+                                      &serial_positions,
+                                      &serial_velocities);
+  EXPECT_EQ(parallel_positions, serial_positions);
+  EXPECT_EQ(8998, parallel_transforms->frame_table_statistics().hits);
+  EXPECT_EQ(8998, parallel_transforms->frame_table_statistics().misses);
+}
+
+// Check that |TransformRange| only applies the first transform to the points
+// that were appended to a cacheable trajectory since the previous call.
+TEST_F(TransformsTest, IncrementalTransformRange) {
+  auto const transforms =
+      Transforms<Functors, From, Through, To>::BodyCentredNonRotating(
+          body1_fn_, &Functors::to_trajectory);
+  transforms->set_cacheable(&Functors::from_trajectory);
+  body1_to_->Append(
+      Instant(kNumberOfPoints * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({1 * SIUnit<Length>(),
+                                         -1 * SIUnit<Length>(),
+                                         2 * SIUnit<Length>()})),
+          Velocity<To>({-3 * SIUnit<Speed>(),
+                        5 * SIUnit<Speed>(),
+                        -8 * SIUnit<Speed>()})));
+
+  auto const append_to_body1 = [this](int const i) {
+    body1_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(Displacement<From>({1 * i * SIUnit<Length>(),
+                                               2 * i * SIUnit<Length>(),
+                                               3 * i * SIUnit<Length>()})),
+            Velocity<From>({4 * i * SIUnit<Speed>(),
+                            8 * i * SIUnit<Speed>(),
+                            16 * i * SIUnit<Speed>()})));
+  };
+  auto const append_to_satellite = [this](int const i) {
+    satellite_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(Displacement<From>({10 * i * SIUnit<Length>(),
+                                               -20 * i * SIUnit<Length>(),
+                                               30 * i * SIUnit<Length>()})),
+            Velocity<From>({40 * i * SIUnit<Speed>(),
+                            -80 * i * SIUnit<Speed>(),
+                            160 * i * SIUnit<Speed>()})));
+  };
+  auto const transform_range = [this](
+      Transforms<Functors, From, Through, To>& transforms,
+      Instant const& t1) {
+    std::vector<Instant> times;
+    std::vector<Position<To>> positions;
+    std::vector<Velocity<To>> velocities;
+    transforms.TransformRange(satellite_fn_,
+                              &Functors::from_trajectory,
+                              t1,
+                              satellite_from_->last().time(),
+                              &times,
+                              &positions,
+                              &velocities);
+    return positions;
+  };
+  // The result of a |Transforms| object that has no cached points.
+  auto const uncached_transform_range = [this, &transform_range](
+      Instant const& t1) {
+    auto const uncached_transforms =
+        Transforms<Functors, From, Through, To>::BodyCentredNonRotating(
+            body1_fn_, &Functors::to_trajectory);
+    return transform_range(*uncached_transforms, t1);
+  };
+
+  Instant const t1 = satellite_from_->first().time();
+  EXPECT_EQ(uncached_transform_range(t1), transform_range(*transforms, t1));
+  EXPECT_EQ(kNumberOfPoints, transforms->first_cache_statistics().misses);
+
+  // Only the new points are transformed.
+  for (int i = kNumberOfPoints + 1; i <= kNumberOfPoints + 3; ++i) {
+    append_to_body1(i);
+    append_to_satellite(i);
+  }
+  EXPECT_EQ(uncached_transform_range(t1), transform_range(*transforms, t1));
+  EXPECT_EQ(kNumberOfPoints + 3, transforms->first_cache_statistics().misses);
+  EXPECT_EQ(0, transforms->first_cache_statistics().hits);
+
+  // Starting later doesn't require transforming anything.
+  Instant const t2 = Instant(5 * SIUnit<Time>());
+  EXPECT_EQ(uncached_transform_range(t2), transform_range(*transforms, t2));
+  EXPECT_EQ(kNumberOfPoints + 3, transforms->first_cache_statistics().misses);
+  EXPECT_EQ(0, transforms->first_cache_statistics().hits);
+
+  // Truncating the trajectory changes its generation, so all the points of the
+  // range are transformed again.
+  satellite_from_->ForgetAfter(Instant(10 * SIUnit<Time>()));
+  append_to_satellite(11);
+  EXPECT_EQ(uncached_transform_range(t2), transform_range(*transforms, t2));
+  EXPECT_EQ(kNumberOfPoints + 3 + 7,
+            transforms->first_cache_statistics().misses);
+  EXPECT_EQ(0, transforms->first_cache_statistics().hits);
+}
+
+// Check that |TransformRange| only applies the transforms to the points
+// accepted by its filter, and calls the filter in increasing time order.
+TEST_F(TransformsTest, FilteredTransformRange) {
+  auto const transforms =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+  body1_to_->Append(
+      Instant(kNumberOfPoints * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({1 * SIUnit<Length>(),
+                                         -1 * SIUnit<Length>(),
+                                         2 * SIUnit<Length>()})),
+          Velocity<To>({-3 * SIUnit<Speed>(),
+                        5 * SIUnit<Speed>(),
+                        -8 * SIUnit<Speed>()})));
+  body2_to_->Append(
+      Instant(kNumberOfPoints * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({13 * SIUnit<Length>(),
+                                         -21 * SIUnit<Length>(),
+                                         34 * SIUnit<Length>()})),
+          Velocity<To>({-55 * SIUnit<Speed>(),
+                        89 * SIUnit<Speed>(),
+                        -144 * SIUnit<Speed>()})));
+
+  std::vector<Instant> times;
+  std::vector<Position<To>> positions;
+  std::vector<Velocity<To>> velocities;
+  transforms->TransformRange(satellite_fn_,
+                             &Functors::from_trajectory,
+                             satellite_from_->first().time(),
+                             satellite_from_->last().time(),
+                             &times,
+                             &positions,
+                             &velocities);
+  EXPECT_EQ(kNumberOfPoints, transforms->frame_table_statistics().misses);
+
+  // The barycentric frames are only computed for the points that go through
+  // the first transform.
+  auto const filtered_transforms =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+  std::vector<Instant> filtered_times;
+  std::vector<Position<To>> filtered_positions;
+  std::vector<Instant> filter_calls;
+  filtered_transforms->TransformRange(
+      satellite_fn_,
+      &Functors::from_trajectory,
+      satellite_from_->first().time(),
+      satellite_from_->last().time(),
+      [&filtered_times, &filtered_positions](
+          Instant const& time,
+          Position<To> const& position,
+          Velocity<To> const& velocity) {
+        filtered_times.push_back(time);
+        filtered_positions.push_back(position);
+      },
+      nullptr,
+      [&filter_calls](Instant const& time) {
+        filter_calls.push_back(time);
+        return filter_calls.size() % 3 == 1;
+      });
+  EXPECT_EQ(times, filter_calls);
+  ASSERT_EQ((kNumberOfPoints + 2) / 3, filtered_times.size());
+  EXPECT_EQ((kNumberOfPoints + 2) / 3,
+            filtered_transforms->frame_table_statistics().misses);
+  for (int i = 0; i < filtered_times.size(); ++i) {
+    EXPECT_EQ(times[3 * i], filtered_times[i]);
+    EXPECT_EQ(positions[3 * i], filtered_positions[i]);
+  }
+}
+
+// Check that |TransformRange| bounds the number of points for which it keeps
+// the results of the first transform, and forgets the trajectories that it
+// doesn't transform anymore.
+TEST_F(TransformsTest, TransformRangeTails) {
+  int const max_tail_points = 1 << 14;
+  int const number_of_points = max_tail_points + 1000;
+  for (int i = kNumberOfPoints + 1; i <= number_of_points; ++i) {
+    body1_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(Displacement<From>({1 * i * SIUnit<Length>(),
+                                               2 * i * SIUnit<Length>(),
+                                               3 * i * SIUnit<Length>()})),
+            Velocity<From>({4 * i * SIUnit<Speed>(),
+                            8 * i * SIUnit<Speed>(),
+                            16 * i * SIUnit<Speed>()})));
+    satellite_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(Displacement<From>({10 * i * SIUnit<Length>(),
+                                               -20 * i * SIUnit<Length>(),
+                                               30 * i * SIUnit<Length>()})),
+            Velocity<From>({40 * i * SIUnit<Speed>(),
+                            -80 * i * SIUnit<Speed>(),
+                            160 * i * SIUnit<Speed>()})));
+  }
+  body1_to_->Append(
+      Instant(number_of_points * SIUnit<Time>()),
+      DegreesOfFreedom<To>(
+          Position<To>(Displacement<To>({1 * SIUnit<Length>(),
+                                         -1 * SIUnit<Length>(),
+                                         2 * SIUnit<Length>()})),
+          Velocity<To>({-3 * SIUnit<Speed>(),
+                        5 * SIUnit<Speed>(),
+                        -8 * SIUnit<Speed>()})));
+
+  auto const transforms =
+      Transforms<Functors, From, Through, To>::BodyCentredNonRotating(
+          body1_fn_, &Functors::to_trajectory);
+  transforms->set_cacheable(&Functors::from_trajectory);
+  auto const transform_range = [](
+      Transforms<Functors, From, Through, To>& transforms,
+      Functors const& fn) {
+    std::vector<Instant> times;
+    std::vector<Position<To>> positions;
+    std::vector<Velocity<To>> velocities;
+    transforms.TransformRange(fn,
+                              &Functors::from_trajectory,
+                              Instant(1 * SIUnit<Time>()),
+                              fn.from->last().time(),
+                              &times,
+                              &positions,
+                              &velocities);
+    return positions;
+  };
+  auto const uncached_transforms =
+      Transforms<Functors, From, Through, To>::BodyCentredNonRotating(
+          body1_fn_, &Functors::to_trajectory);
+  auto const expected = transform_range(*uncached_transforms, satellite_fn_);
+  ASSERT_EQ(number_of_points, expected.size());
+
+  EXPECT_EQ(expected, transform_range(*transforms, satellite_fn_));
+  EXPECT_EQ(number_of_points, transforms->first_cache_statistics().misses);
+  EXPECT_EQ(0, transforms->first_cache_statistics().hits);
+
+  // The points that were trimmed from the tail go through the first transform
+  // again, and are found in the cache.
+  EXPECT_EQ(expected, transform_range(*transforms, satellite_fn_));
+  EXPECT_EQ(number_of_points, transforms->first_cache_statistics().misses);
+  EXPECT_EQ(number_of_points - max_tail_points,
+            transforms->first_cache_statistics().hits);
+
+  // After transforming another trajectory many times, the tail of the
+  // satellite is forgotten.
+  for (int i = 0; i < 100; ++i) {
+    transform_range(*transforms, body2_fn_);
+  }
+  std::int64_t const hits = transforms->first_cache_statistics().hits;
+  EXPECT_EQ(expected, transform_range(*transforms, satellite_fn_));
+  EXPECT_EQ(hits + number_of_points,
+            transforms->first_cache_statistics().hits);
+}
+
+// Check that the cache of the first transform is used for the cacheable
+// trajectories, and that it is invalidated when a trajectory is truncated.
+TEST_F(TransformsTest, Cache) {
+  auto const transforms =
+      Transforms<Functors, From, Through, To>::BodyCentredNonRotating(
+          body1_fn_, &Functors::to_trajectory);
+  transforms->set_cacheable(&Functors::from_trajectory);
+
+  auto const transform_satellite = [this, &transforms]() {
+    std::vector<DegreesOfFreedom<Through>> result;
+    for (auto it = transforms->first(satellite_fn_,
+                                     &Functors::from_trajectory);
+         !it.at_end();
+         ++it) {
+      result.push_back(it.degrees_of_freedom());
+    }
+    return result;
+  };
+
+  auto const first = transform_satellite();
+  EXPECT_EQ(0, transforms->first_cache_statistics().hits);
+  EXPECT_EQ(kNumberOfPoints, transforms->first_cache_statistics().misses);
+  auto const second = transform_satellite();
+  EXPECT_EQ(kNumberOfPoints, transforms->first_cache_statistics().hits);
+  EXPECT_EQ(kNumberOfPoints, transforms->first_cache_statistics().misses);
+  EXPECT_EQ(0, transforms->first_cache_statistics().evictions);
+  EXPECT_EQ(first, second);
+
+  // Truncate the trajectory and regrow it with different points: the cached
+  // values must not be used.
+  Instant const last_time = satellite_from_->last().time();
+  satellite_from_->ForgetAfter(Instant(1 * SIUnit<Time>()));
+  satellite_from_->Append(last_time,
+                          DegreesOfFreedom<From>(
+                              Position<From>(Displacement<From>(
+                                  {1 * SIUnit<Length>(),
+                                   2 * SIUnit<Length>(),
+                                   3 * SIUnit<Length>()})),
+                              Velocity<From>()));
+  auto const third = transform_satellite();
+  EXPECT_EQ(kNumberOfPoints, transforms->first_cache_statistics().hits);
+  EXPECT_EQ(kNumberOfPoints + 2, transforms->first_cache_statistics().misses);
+  EXPECT_EQ(2, third.size());
+  EXPECT_EQ(first.front(), third.front());
+  EXPECT_NE(first.back(), third.back());
+}
+
+// Check that the barycentric frame computed for one mobile is reused for
+// another mobile at the same times, and that the result doesn't depend on
+// whether the frame was computed or reused.
+TEST_F(TransformsTest, FrameTable) {
+  MasslessBody other_satellite;
+  Trajectory<From> other_satellite_from(&other_satellite);
+  Functors other_satellite_fn({&other_satellite_from, nullptr});
+  for (int i = 1; i <= kNumberOfPoints; ++i) {
+    other_satellite_from.Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(
+                Displacement<From>({-7 * i * SIUnit<Length>(),
+                                    11 * i * SIUnit<Length>(),
+                                    5 * i * SIUnit<Length>()})),
+            Velocity<From>({9 * i * SIUnit<Speed>(),
+                            -3 * i * SIUnit<Speed>(),
+                            2 * i * SIUnit<Speed>()})));
+  }
+
+  auto const transform = [](
+      not_null<Transforms<Functors, From, Through, To>*> const transforms,
+      Functors const& fn) {
+    std::vector<DegreesOfFreedom<Through>> result;
+    for (auto it = transforms->first(fn, &Functors::from_trajectory);
+         !it.at_end();
+         ++it) {
+      result.push_back(it.degrees_of_freedom());
+    }
+    return result;
+  };
+
+  auto const shared =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+  transform(shared.get(), satellite_fn_);
+  EXPECT_EQ(0, shared->frame_table_statistics().hits);
+  EXPECT_EQ(kNumberOfPoints, shared->frame_table_statistics().misses);
+  auto const other_shared = transform(shared.get(), other_satellite_fn);
+  EXPECT_EQ(kNumberOfPoints, shared->frame_table_statistics().hits);
+  EXPECT_EQ(kNumberOfPoints, shared->frame_table_statistics().misses);
+
+  auto const alone =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+  auto const other_alone = transform(alone.get(), other_satellite_fn);
+  EXPECT_EQ(0, alone->frame_table_statistics().hits);
+  EXPECT_EQ(kNumberOfPoints, alone->frame_table_statistics().misses);
+  EXPECT_EQ(other_alone, other_shared);
+
+  // Regrowing the secondary with different points invalidates the frames at
+  // the affected times, even though the primary didn't change.
+  body2_from_->ForgetAfter(Instant(kNumberOfPoints / 2 * SIUnit<Time>()));
+  for (int i = kNumberOfPoints / 2 + 1; i <= kNumberOfPoints; ++i) {
+    body2_from_->Append(
+        Instant(i * SIUnit<Time>()),
+        DegreesOfFreedom<From>(
+            Position<From>(
+                Displacement<From>({-2 * i * SIUnit<Length>(),
+                                    -1 * i * SIUnit<Length>(),
+                                    3 * i * SIUnit<Length>()})),
+            Velocity<From>({-8 * i * SIUnit<Speed>(),
+                            4 * i * SIUnit<Speed>(),
+                            -16 * i * SIUnit<Speed>()})));
+  }
+  // The stale frames are dropped from the table and recomputed.
+  auto const regrown_shared = transform(shared.get(), satellite_fn_);
+  EXPECT_EQ(kNumberOfPoints, shared->frame_table_statistics().hits);
+  EXPECT_EQ(2 * kNumberOfPoints, shared->frame_table_statistics().misses);
+  EXPECT_EQ(kNumberOfPoints, shared->frame_table_statistics().evictions);
+  auto const regrown =
+      Transforms<Functors, From, Through, To>::BarycentricRotating(
+          body1_fn_, body2_fn_, &Functors::to_trajectory);
+  auto const regrown_alone = transform(regrown.get(), satellite_fn_);
+  EXPECT_EQ(regrown_alone, regrown_shared);
+}
+
 }  // namespace physics
 }  // namespace principia